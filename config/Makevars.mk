@@ -12,7 +12,7 @@ SHELL:=/bin/bash
 ifndef DEBUG
   OPTFLAGS += -O99
 else
-  OPTFLAGS += -g2
+  OPTFLAGS += -g2 -DMFM_DEBUG
   # Default to commands if debugging
   ifndef COMMANDS
     COMMANDS := 1
@@ -41,6 +41,26 @@ ifdef FIND_DEAD_CODE
   OPTFLAGS += -Wunreachable-code
 endif
 
+# Failures during an event unwind to a single frame per event, which
+# rolls back the event window, instead of a frame per atom write
+ifdef EVENT_ROLLBACK
+  COMMON_CFLAGS += -DMFM_EVENT_ROLLBACK
+  COMMON_CPPFLAGS += -DMFM_EVENT_ROLLBACK
+endif
+
+# Profile lock contention, ACK waits and event times per Tile, and
+# report them at the end of a run
+ifdef INSTRUMENT
+  COMMON_CFLAGS += -DMFM_INSTRUMENT
+  COMMON_CPPFLAGS += -DMFM_INSTRUMENT
+endif
+
+# Compile out log messages less severe than LOG_LEVEL (1=ERR ... 8=ALL)
+ifdef LOG_LEVEL
+  COMMON_CFLAGS += -DMFM_LOG_COMPILED_LEVEL=$(LOG_LEVEL)
+  COMMON_CPPFLAGS += -DMFM_LOG_COMPILED_LEVEL=$(LOG_LEVEL)
+endif
+
 ifdef MAKE_GUI
   COMMON_CFLAGS += -DMFM_GUI_DRIVER
   COMMON_CPPFLAGS += -DMFM_GUI_DRIVER
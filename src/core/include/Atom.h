@@ -265,16 +265,15 @@ namespace MFM
      * flipping.
      *
      * @param bitOdds The odds (one in these odds) that a particular
-     * bit will be flipped.
+     * bit will be flipped.  Rather than drawing once per bit, this
+     * skips ahead from flip to flip using Random::CreateGeometric.
      */
     void XRay(Random& rand, u32 bitOdds)
     {
-      for(u32 i = 0; i < BPA; i++)
+      for(u32 i = rand.CreateGeometric(bitOdds); i < BPA;
+          i += rand.CreateGeometric(bitOdds) + 1)
       {
-        if(rand.OneIn(bitOdds))
-        {
-          m_bits.ToggleBit(i);
-        }
+        m_bits.ToggleBit(i);
       }
     }
 
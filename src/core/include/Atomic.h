@@ -0,0 +1,142 @@
+/*                                              -*- mode:C++ -*-
+  Atomic.h Lock-free integral values shared between threads
+  Copyright (C) 2014 The Regents of the University of New Mexico.  All rights reserved.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301
+  USA
+*/
+
+/**
+  \file Atomic.h Lock-free integral values shared between threads
+  \author David H. Ackley.
+  \date (C) 2014 All rights reserved.
+  \lgpl
+ */
+#ifndef ATOMIC_H
+#define ATOMIC_H
+
+#include "itype.h"
+
+namespace MFM
+{
+  /**
+   * Memory orderings available to Atomic operations.  These map
+   * directly onto the GCC __atomic builtin orderings, which we use
+   * because std::atomic is not available in the C++ dialect we build
+   * with.
+   */
+  enum MemoryOrder
+  {
+    MEMORY_ORDER_RELAXED = __ATOMIC_RELAXED,
+    MEMORY_ORDER_ACQUIRE = __ATOMIC_ACQUIRE,
+    MEMORY_ORDER_RELEASE = __ATOMIC_RELEASE,
+    MEMORY_ORDER_ACQ_REL = __ATOMIC_ACQ_REL,
+    MEMORY_ORDER_SEQ_CST = __ATOMIC_SEQ_CST
+  };
+
+  /**
+   * Issues a full memory fence of the given ordering.
+   */
+  inline void AtomicThreadFence(MemoryOrder order = MEMORY_ORDER_SEQ_CST)
+  {
+    __atomic_thread_fence(order);
+  }
+
+  /**
+   * An integral value which may be read and written concurrently by
+   * multiple threads without a lock.  T must be an integral type no
+   * wider than the platform supports lock-free (in practice, up to 64
+   * bits).
+   */
+  template <class T>
+  class Atomic
+  {
+  private:
+    T m_value;
+
+    // Declare away copy ctor and assignment; copying would not be atomic
+    Atomic(const Atomic &);
+    Atomic & operator=(const Atomic &);
+
+  public:
+
+    Atomic(T initial = 0) : m_value(initial)
+    { }
+
+    /**
+     * Atomically reads this value.
+     */
+    T Load(MemoryOrder order = MEMORY_ORDER_SEQ_CST) const
+    {
+      return __atomic_load_n(&m_value, order);
+    }
+
+    /**
+     * Atomically replaces this value with \a value .
+     */
+    void Store(T value, MemoryOrder order = MEMORY_ORDER_SEQ_CST)
+    {
+      __atomic_store_n(&m_value, value, order);
+    }
+
+    /**
+     * Atomically replaces this value with \a value .
+     *
+     * @returns the value held immediately before the exchange.
+     */
+    T Exchange(T value, MemoryOrder order = MEMORY_ORDER_SEQ_CST)
+    {
+      return __atomic_exchange_n(&m_value, value, order);
+    }
+
+    /**
+     * If this value equals \a expected, atomically replaces it with
+     * \a desired and returns true.  Otherwise, stores the value
+     * actually found into \a expected and returns false.
+     */
+    bool CompareExchange(T & expected, T desired,
+                         MemoryOrder order = MEMORY_ORDER_SEQ_CST)
+    {
+      MemoryOrder failOrder =
+        (order == MEMORY_ORDER_ACQ_REL) ? MEMORY_ORDER_ACQUIRE :
+        (order == MEMORY_ORDER_RELEASE) ? MEMORY_ORDER_RELAXED :
+        order;
+      return __atomic_compare_exchange_n(&m_value, &expected, desired,
+                                         false, order, failOrder);
+    }
+
+    /**
+     * Atomically adds \a delta to this value.
+     *
+     * @returns the value held immediately before the addition.
+     */
+    T FetchAdd(T delta, MemoryOrder order = MEMORY_ORDER_SEQ_CST)
+    {
+      return __atomic_fetch_add(&m_value, delta, order);
+    }
+
+    /**
+     * Atomically subtracts \a delta from this value.
+     *
+     * @returns the value held immediately before the subtraction.
+     */
+    T FetchSub(T delta, MemoryOrder order = MEMORY_ORDER_SEQ_CST)
+    {
+      return __atomic_fetch_sub(&m_value, delta, order);
+    }
+  };
+}
+
+#endif /* ATOMIC_H */
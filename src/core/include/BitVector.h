@@ -30,7 +30,7 @@
 #include "itype.h"
 #include "ByteSink.h"
 #include "ByteSource.h"
-#include "Util.h"   /* for MakeMaskClip */
+#include "Util.h"   /* for MakeMaskClip64 */
 #include <climits>  /* for CHAR_BIT */
 #include <stdlib.h> /* for abort */
 
@@ -96,6 +96,19 @@ namespace MFM {
     return (0x6996 >> v) & 1;
   }
 
+  // The compiler recognizes this idiom, and emits a popcount
+  // instruction where the target has one
+  inline u32 _getPopCount64(u64 v) {
+    const u64 m1 = (((u64) 0x55555555) << 32) | 0x55555555;
+    const u64 m2 = (((u64) 0x33333333) << 32) | 0x33333333;
+    const u64 m4 = (((u64) 0x0f0f0f0f) << 32) | 0x0f0f0f0f;
+    const u64 h01 = (((u64) 0x01010101) << 32) | 0x01010101;
+    v = v - ((v >> 1) & m1);
+    v = (v & m2) + ((v >> 2) & m2);
+    v = (v + (v >> 4)) & m4;
+    return (u32) ((v * h01) >> 56);
+  }
+
   // v must be <= 0x7fffffff
   inline u32 _getNextPowerOf2(u32 v) {
     v |= v >> 16;
@@ -109,9 +122,12 @@ namespace MFM {
   /**
    * A bit vector with reasonably fast operations
    *
-   * BITS should be a multiple of BITS_PER_UNIT (currently
-   * 32). Otherwise there will, at least, be some wasted space -- and
-   * may be other issues.
+   * Bits are numbered from 0, the MSB of the first unit.  Storage is
+   * in u64 units, so any field of up to 64 bits spans at most two of
+   * them, and a field of up to 32 bits in a BitVector of up to 64
+   * bits never spans two.  BITS need not be a multiple of
+   * BITS_PER_UNIT (currently 64), but the rest of the last unit is
+   * wasted.
    */
   template <u32 B>
   class BitVector
@@ -123,7 +139,7 @@ namespace MFM {
       return BITS;
     }
 
-    typedef u32 BitUnitType;
+    typedef u64 BitUnitType;
     static const u32 BITS_PER_UNIT = sizeof(BitUnitType) * CHAR_BIT;
 
     static const u32 ARRAY_LENGTH = (BITS + BITS_PER_UNIT - 1) / BITS_PER_UNIT;
@@ -135,12 +151,12 @@ namespace MFM {
      * Low-level raw bitvector writing to a single array element.
      * startIdx==0 means the leftmost bit (MSB).  No checking is done:
      * Caller guarantees (1) idx is valid and (2) startIdx + length <=
-     * 32
+     * 64
      */
-    inline void WriteToUnit(const u32 idx, const u32 startIdx, const u32 length, const u32 value) {
+    inline void WriteToUnit(const u32 idx, const u32 startIdx, const u32 length, const u64 value) {
       if (length == 0) return;
       const u32 shift = BITS_PER_UNIT - (startIdx + length);
-      u32 mask = MakeMaskClip(length) << shift;
+      u64 mask = MakeMaskClip64(length) << shift;
       m_bits[idx] = (m_bits[idx] & ~mask) | ((value << shift) & mask);
     }
 
@@ -148,13 +164,13 @@ namespace MFM {
      * Low-level raw bitvector reading from a single array element.
      * startIdx==0 means the leftmost bit (MSB).  No checking is done:
      * Caller guarantees (1) idx is valid and (2) startIdx + length <=
-     * 32
+     * 64
      */
-    inline u32 ReadFromUnit(const u32 idx, const u32 startIdx, const u32 length) const {
+    inline u64 ReadFromUnit(const u32 idx, const u32 startIdx, const u32 length) const {
       if (length==0) { return 0; }
       if(idx >= ARRAY_LENGTH) abort();
       const u32 shift = BITS_PER_UNIT - (startIdx + length);
-      return (m_bits[idx] >> shift) & MakeMaskClip(length);
+      return (m_bits[idx] >> shift) & MakeMaskClip64(length);
     }
 
   public:
@@ -215,6 +231,35 @@ namespace MFM {
      */
     inline u32 Read(const u32 startIdx, const u32 length) const;
 
+    /**
+     * Reads up to 64 bits of a particular section of this BitVector.
+     *
+     * @param startIdx The index of the first bit to read inside this
+     *                 BitVector, where the MSB is indexed at \c 0 .
+     *
+     * @param length The number of bits to read from this
+     *               BitVector. This should be in the range \c [1,64] .
+     *
+     * @returns The bits read from the particular section of this
+     *          BitVector, right-justified.
+     */
+    inline u64 ReadLong(const u32 startIdx, const u32 length) const;
+
+    /**
+     * Writes up to 64 bits of a specified u64 to a section of this
+     * BitVector.
+     *
+     * @param startIdx The index of the first bit to write inside this
+     *                 BitVector, where the MSB is indexed at \c 0 .
+     *
+     * @param length The number of bits to write to this
+     *               BitVector. This should be in the range \c [1,64] .
+     *
+     * @param value The bits to write to the specified section of this
+     *              BitVector, right-justified.
+     */
+    void WriteLong(const u32 startIdx, const u32 length, const u64 value);
+
     /**
      * Writes up to 32 bits of a specified u32 to a section of this BitVector.
      *
@@ -306,8 +351,8 @@ namespace MFM {
      * @param bits The bits to store.  The supplied bits are tiled
      *                 onto the contiguous range of bits as many times
      *                 as needed to cover the given length, with the
-     *                 u32 bits aligned to the underlying u32 storage
-     *                 units. To avoid confusion, pass only 0x0 or
+     *                 u32 bits aligned to 32 bit boundaries of the
+     *                 BitVector. To avoid confusion, pass only 0x0 or
      *                 0xffffffff as bits.
      *
      * @param startIdx The index of the first bit to store inside this
@@ -373,6 +418,44 @@ namespace MFM {
 
     bool operator==(const BitVector & rhs) const;
 
+    bool operator!=(const BitVector & rhs) const
+    {
+      return !(*this == rhs);
+    }
+
+    /**
+     * Counts the bits of this BitVector that are set.
+     *
+     * @returns The number of bits that are \c 1 .
+     */
+    u32 PopCount() const;
+
+    /*
+     * Whole-vector bitwise operations.  These are simple loops over
+     * the storage units, which the compiler is free to vectorize.
+     */
+
+    BitVector & operator&=(const BitVector & rhs)
+    {
+      for (u32 i = 0; i < ARRAY_LENGTH; ++i)
+        m_bits[i] &= rhs.m_bits[i];
+      return *this;
+    }
+
+    BitVector & operator|=(const BitVector & rhs)
+    {
+      for (u32 i = 0; i < ARRAY_LENGTH; ++i)
+        m_bits[i] |= rhs.m_bits[i];
+      return *this;
+    }
+
+    BitVector & operator^=(const BitVector & rhs)
+    {
+      for (u32 i = 0; i < ARRAY_LENGTH; ++i)
+        m_bits[i] ^= rhs.m_bits[i];
+      return *this;
+    }
+
   };
 } /* namespace MFM */
 
@@ -13,7 +13,13 @@ namespace MFM {
   template <u32 BITS>
   BitVector<BITS>::BitVector(const u32 * const values)
   {
-    memcpy(m_bits,values,sizeof(m_bits));
+    // Each unit takes two of the big-endian u32s, high half first
+    Clear();
+    const u32 words = (BITS + 31) / 32;
+    for (u32 i = 0; i < words; ++i)
+    {
+      m_bits[i / 2] |= ((u64) values[i]) << ((i & 1) ? 0 : 32);
+    }
   }
 
   template <u32 BITS>
@@ -42,7 +48,7 @@ namespace MFM {
   {
     u32 arrIdx = idx / BITS_PER_UNIT;
     u32 inIdx = idx % BITS_PER_UNIT;
-    u32 newWord = 0x80000000 >> inIdx;
+    u64 newWord = ((u64) 1) << (BITS_PER_UNIT - 1 - inIdx);
 
     if(!bit)
       m_bits[arrIdx] &= ~newWord;
@@ -55,10 +61,10 @@ namespace MFM {
   {
     u32 arrIdx = idx / BITS_PER_UNIT;
     u32 inIdx = idx % BITS_PER_UNIT;
-    u32 newWord = 0x80000000 >> inIdx;
+    u64 newWord = ((u64) 1) << (BITS_PER_UNIT - 1 - inIdx);
 
     m_bits[arrIdx] ^= newWord;
-    return m_bits[arrIdx] & newWord;
+    return (m_bits[arrIdx] & newWord) != 0;
   }
 
   template <u32 BITS>
@@ -67,13 +73,13 @@ namespace MFM {
     u32 arrIdx = idx / BITS_PER_UNIT;
     u32 intIdx = idx % BITS_PER_UNIT;
 
-    return m_bits[arrIdx] & (0x80000000 >> intIdx);
+    return (m_bits[arrIdx] >> (BITS_PER_UNIT - 1 - intIdx)) & 1;
   }
 
   template <u32 BITS>
-  void BitVector<BITS>::Write(u32 startIdx,
-                              u32 length,
-                              u32 value)
+  void BitVector<BITS>::WriteLong(const u32 startIdx,
+                                  const u32 length,
+                                  const u64 value)
   {
     if (length == 0)
       return;
@@ -81,10 +87,10 @@ namespace MFM {
     if (startIdx+length > BITS)
       FAIL(ILLEGAL_ARGUMENT);
 
-    if (length > sizeof(BitUnitType) * CHAR_BIT)
+    if (length > BITS_PER_UNIT)
       FAIL(ILLEGAL_ARGUMENT);
 
-    /* Since we're writing no more than 32 bits into an array of 32 bit
+    /* Since we're writing no more than 64 bits into an array of 64 bit
        words, we can't need to touch more than two of them.  So unroll
        the loop.
     */
@@ -101,7 +107,7 @@ namespace MFM {
   }
 
   template <u32 BITS>
-  u32 BitVector<BITS>::Read(const u32 startIdx, const u32 length) const
+  u64 BitVector<BITS>::ReadLong(const u32 startIdx, const u32 length) const
   {
     if (length == 0)
       return 0;
@@ -109,17 +115,17 @@ namespace MFM {
     if (startIdx+length > BITS)
       FAIL(ILLEGAL_ARGUMENT);
 
-    if (length > sizeof(BitUnitType) * CHAR_BIT)
+    if (length > BITS_PER_UNIT)
       FAIL(ILLEGAL_ARGUMENT);
 
-    /* See Write(u32,u32,u32) for theory, such as it is */
+    /* See WriteLong(u32,u32,u64) for theory, such as it is */
 
     const u32 firstUnitIdx = startIdx / BITS_PER_UNIT;
     const u32 firstUnitFirstBit = startIdx % BITS_PER_UNIT;
     const bool hasSecondUnit = (firstUnitFirstBit + length) > BITS_PER_UNIT;
     const u32 firstUnitLength = hasSecondUnit ? BITS_PER_UNIT-firstUnitFirstBit : length;
 
-    u32 ret = ReadFromUnit(firstUnitIdx, firstUnitFirstBit, firstUnitLength);
+    u64 ret = ReadFromUnit(firstUnitIdx, firstUnitFirstBit, firstUnitLength);
 
     if (hasSecondUnit) {
       const u32 secondUnitLength = length - firstUnitLength;
@@ -130,9 +136,32 @@ namespace MFM {
   }
 
   template <u32 BITS>
-  void BitVector<BITS>::StoreBits(const u32 bits, const u32 startIdx, const u32 length)
+  void BitVector<BITS>::Write(u32 startIdx,
+                              u32 length,
+                              u32 value)
+  {
+    if (length > 32)
+      FAIL(ILLEGAL_ARGUMENT);
+
+    WriteLong(startIdx, length, value);
+  }
+
+  template <u32 BITS>
+  u32 BitVector<BITS>::Read(const u32 startIdx, const u32 length) const
+  {
+    if (length > 32)
+      FAIL(ILLEGAL_ARGUMENT);
+
+    return (u32) ReadLong(startIdx, length);
+  }
+
+  template <u32 BITS>
+  void BitVector<BITS>::StoreBits(const u32 bits32, const u32 startIdx, const u32 length)
   {
-    if (!length) return;
+    if (!length || startIdx >= BITS) return;
+
+    // Tile the pattern across each unit, keeping its 32 bit alignment
+    const u64 bits = (((u64) bits32) << 32) | bits32;
 
     const u32 stopIdx = MIN((u32) BITS, startIdx + length) - 1;
 
@@ -147,8 +176,9 @@ namespace MFM {
     const bool hasMultipleUnits = lastUnitIdx > firstUnitIdx;
 
     if (!hasMultipleUnits) {
-      WriteToUnit(firstUnitIdx, firstUnitFirstBit, length,
-                  bits >> (BITS_PER_UNIT - (firstUnitFirstBit + length)));
+      const u32 unitLength = stopIdx - startIdx + 1;
+      WriteToUnit(firstUnitIdx, firstUnitFirstBit, unitLength,
+                  bits >> (BITS_PER_UNIT - (firstUnitFirstBit + unitLength)));
       return;
     }
 
@@ -236,4 +266,13 @@ namespace MFM {
 
   }
 
+  template <u32 BITS>
+  u32 BitVector<BITS>::PopCount() const
+  {
+    u32 count = 0;
+    for (u32 i = 0; i < ARRAY_LENGTH; ++i)
+      count += _getPopCount64(m_bits[i]);
+    return count;
+  }
+
 } /* namespace MFM */
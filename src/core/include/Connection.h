@@ -28,7 +28,8 @@
 #define CONNECTION_H
 
 #include "ThreadQueue.h"
-#include "Mutex.h"
+#include "Atomic.h"
+#include "Fail.h"
 #include "itype.h"
 #include "Logger.h"
 #include <assert.h>
@@ -36,9 +37,9 @@
 namespace MFM
 {
   /**
-   * A construct meant to be used by two threads as a communication
+   * A construct meant to be used by two Tiles as a communication
    * channel, supporting reading and writing on both ends. Only one
-   * thread is able to access the IO of this construct at a time,
+   * Tile is able to hold the lock of this construct at a time,
    * allowing for thread safe operation.
    */
   class Connection
@@ -46,9 +47,12 @@ namespace MFM
   private:
 
     /**
-     * A Mutex controlling access to this Connection .
+     * Nonzero while one of the two Tiles holds the lock on this
+     * Connection .  This is deliberately not a Mutex: the lock
+     * belongs to a Tile rather than to a thread, and a Tile may be
+     * run by different threads while it holds the lock.
      */
-    Mutex m_lock;
+    Atomic<u32> m_locked;
 
     /**
      * The two ThreadQueue constructs used for two way IO .
@@ -104,46 +108,41 @@ namespace MFM
       return m_connected;
     }
 
-    /** Test if the connection is currently locked by a thread other
-     * than the current thread.
+    /** Test if the connection is currently locked.  The caller must
+     * track for itself whether it is the holder.
      *
-     * FAILs with LOCK_FAILURE if the connection is locked by the
-     * current thread.
-     *
-     * @returns true if the lock is currently held by a thread other
-     * than the current thread, and false if the lock is currently
-     * unlocked
+     * @returns true if the lock is currently held, and false if the
+     * lock is currently unlocked
      *
      */
-    bool IsLockedByAnother()
+    bool IsLocked() const
     {
-      return m_lock.IsLockedByAnother();
+      return m_locked.Load(MEMORY_ORDER_RELAXED) != 0;
     }
 
-    /** Locks the underlying mutex, allowing for thread-safe execution
-     * along this connection.
+    /** Attempts to take the lock without blocking, allowing for
+     * thread-safe execution along this connection.
      *
      * @returns true if the lock was successfully taken, else false.
      */
     bool Lock()
     {
-      /*
-      if (m_lock.IHoldThisLock()) {
-        LOG.Debug("Connection %p already owns lock",(void*) this);
-        return false;
-      }
-      */
-      return m_lock.TryLock();
+      u32 expected = 0;
+      return m_locked.CompareExchange(expected, 1, MEMORY_ORDER_ACQUIRE);
     }
 
     /**
-     * Unlocks the underlying mutex, allowing for another thread to lock
-     * this Connection. DO NOT call this method from a thread which does
-     * not already hold the lock!
+     * Unlocks this Connection, allowing for the other Tile to lock
+     * it. DO NOT call this method from a Tile which does not already
+     * hold the lock!  FAILs with LOCK_FAILURE if the Connection is
+     * not locked.
      */
     void Unlock()
     {
-      m_lock.Unlock();
+      if (m_locked.Exchange(0, MEMORY_ORDER_RELEASE) == 0)
+      {
+        FAIL(LOCK_FAILURE);
+      }
     }
 
     /**
@@ -241,6 +240,16 @@ namespace MFM
       return m_outbuffer.BytesAvailable();
     }
 
+    /**
+     * Number of bytes waiting for Read with the same \c child .
+     */
+    u32 ReadableByteCount(bool child)
+    {
+      ThreadQueue& queue = child ? m_outbuffer : m_inbuffer;
+
+      return queue.BytesAvailable();
+    }
+
     void LogAllPackets()
     {
 
@@ -40,6 +40,23 @@ namespace MFM
 {
   typedef u32 ElementType;
 
+  /**
+   * Capabilities an Element may declare about itself, as bits in a
+   * mask, so that other elements can ask what kind of thing an atom
+   * is by its type alone -- see ElementTable::GetTraits -- rather
+   * than by dynamic_cast on its Element.
+   *
+   * @sa Element::AddTraits
+   */
+  enum ElementTrait
+  {
+    /** The Element is an AbstractElement_Xtal */
+    ELEMENT_TRAIT_XTAL =      0x00000001,
+
+    /** The Element is an AbstractElement_ForkBomb */
+    ELEMENT_TRAIT_FORKBOMB =  0x00000002
+  };
+
   template <class CC> class Atom; // Forward declaration
 
   /**
@@ -105,6 +122,11 @@ namespace MFM
      */
     const char* m_name;
 
+    /**
+     * The ElementTrait bits this Element has declared.
+     */
+    u32 m_traits;
+
    protected:
 
     /**
@@ -203,6 +225,18 @@ namespace MFM
       m_name = name;
     }
 
+    /**
+     * Declares that this Element has some ElementTraits.  Must be
+     * called before this Element is registered in any ElementTable,
+     * which is to say, from a constructor.
+     *
+     * @param traits The ElementTrait bits to add to this Element .
+     */
+    void AddTraits(u32 traits)
+    {
+      m_traits |= traits;
+    }
+
     /**
      * The four Von Neumann neighbors, represented as four unit
      * vectors in the four cardinal directions.
@@ -288,7 +322,8 @@ namespace MFM
                                  m_hasType(false),
                                  m_renderLowlight(false),
                                  m_atomicSymbol("!!"),
-                                 m_name("UNNAMED")
+                                 m_name("UNNAMED"),
+                                 m_traits(0)
     {
       LOG.Debug("Constructed %@",&m_UUID);
     }
@@ -359,6 +394,17 @@ namespace MFM
       return m_name;
     }
 
+    /**
+     * Gets the ElementTrait bits of this Element .
+     *
+     * @returns The bitwise OR of every ElementTrait this Element has
+     *          declared, or 0 if none.
+     */
+    u32 GetTraits() const
+    {
+      return m_traits;
+    }
+
     /**
      * Appends a short description of the data held by an Atom of this
      * Element.
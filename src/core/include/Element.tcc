@@ -85,11 +85,11 @@ namespace MFM
     Tile<CC>& tile = window.GetTile();
     SPoint pick = SPoint(0,0);
     u32 pickWeight = 0;
-    const MDist<R> md = MDist<R>::get();
+    const MDist<R> & md = MDist<R>::get();
 
     for (u32 idx = md.GetFirstIndex(0); idx <= md.GetLastIndex(1); ++idx) {
       const SPoint sp = md.GetPoint(idx);
-      T other = window.GetRelativeAtom(sp);
+      T other = window.GetRelativeAtom(idx);
       const Element * elt = tile.GetElement(other.GetType());
 
       if (!other.IsSane() || !(elt = tile.GetElement(other.GetType()))) {
@@ -113,7 +113,7 @@ namespace MFM
   {
     Random & random = window.GetRandom();
     Tile<CC>& tile = window.GetTile();
-    const MDist<R> md = MDist<R>::get();
+    const MDist<R> & md = MDist<R>::get();
 
     SPoint sp;
     md.FillRandomSingleDir(sp, random);
@@ -33,6 +33,7 @@
 #include "Dirs.h"
 #include "itype.h"
 #include "Element.h"
+#include "StaticLoader.h"
 #include "Element_Empty.h"
 
 namespace MFM
@@ -50,10 +51,19 @@ namespace MFM
     enum { R = P::EVENT_WINDOW_RADIUS};
     enum { ELEMENT_DATA_SLOTS = P::ELEMENT_DATA_SLOTS};
 
+    typedef StaticLoader<CC,16> TypeLoader;
+
   public:
     // -3 to avoid 2**k and 2**k-1 sizes; they seem to beat against type assignments
     static const u32 SIZE = (1u<<B) - 3;
 
+    /**
+     * How many type ordinals (see StaticLoader::OrdinalOfType) this
+     * ElementTable can map directly.  Elements whose ordinals are
+     * this large or larger still work, via the slower hash probe.
+     */
+    static const u32 DENSE_SIZE = 1u<<B;
+
     /**
      * Reinitialize this ElementTable to empty.
      */
@@ -116,7 +126,62 @@ namespace MFM
      *          this table. If an Element with this type is not found
      *          in this ElementTable, will return NULL .
      */
-    const Element<CC> * Lookup(u32 elementType) const;
+    const Element<CC> * Lookup(u32 elementType) const
+    {
+      s32 slot = GetIndex(elementType);
+      if (slot < 0)
+      {
+        return 0;
+      }
+      return m_hash[slot].m_element;
+    }
+
+    /**
+     * Gets the Element at \c index of this ElementTable, as returned
+     * by GetIndex.
+     *
+     * @returns The Element registered at \c index , or NULL if there
+     *          is none.
+     */
+    const Element<CC> * GetElementAtIndex(u32 index) const
+    {
+      if (index >= SIZE)
+      {
+        FAIL(ARRAY_INDEX_OUT_OF_BOUNDS);
+      }
+      return m_hash[index].m_element;
+    }
+
+    /**
+     * Gets the ElementTraits of the Element of a given type without
+     * touching the Element itself.
+     *
+     * @param elementType The type of the Element to look up.
+     *
+     * @returns The ElementTrait bits of the Element of type \c
+     *          elementType , or 0 if no such Element is registered.
+     */
+    u32 GetTraits(u32 elementType) const
+    {
+      s32 slot = GetIndex(elementType);
+      if (slot < 0)
+      {
+        return 0;
+      }
+      return m_hash[slot].m_traits;
+    }
+
+    /**
+     * Checks whether the Element of a given type has all of some
+     * ElementTraits.
+     *
+     * @returns \c true if \c elementType is registered and its
+     *          Element has every bit of \c traits .
+     */
+    bool HasTraits(u32 elementType, u32 traits) const
+    {
+      return (GetTraits(elementType) & traits) == traits;
+    }
 
     /**
      * Executes the behavior method of the Element in the center of a
@@ -148,6 +213,33 @@ namespace MFM
       }
     }
 
+    /**
+     * Executes the behavior method of the Element in the center of a
+     * specified EventWindow, skipping the type lookup if the center
+     * atom belongs to a given, expected Element.  Callers executing
+     * many events of the same type through here keep this call's
+     * indirect branch predictable.
+     *
+     * @param window The EventWindow to execute an event upon.
+     *
+     * @param expected The Element the center atom probably belongs
+     *                 to, or NULL to look it up as Execute(window)
+     *                 does.
+     */
+    void Execute(EventWindow<CC>& window, const Element<CC> * expected)
+    {
+      if (expected)
+      {
+        const T & atom = window.GetCenterAtom();
+        if (atom.IsSane() && atom.GetType() == expected->GetType())
+        {
+          expected->Behavior(window);
+          return;
+        }
+      }
+      Execute(window);
+    }
+
     /**
      * Inserts an Element into this ElementTable.
      *
@@ -233,12 +325,31 @@ namespace MFM
     }
 
     u64 * GetElementDataSlotsFromType(const u32 elementType, const u32 slots) {
+      s32 start = GetElementDataStartFromType(elementType, slots);
+      if (start < 0) return 0;
+      return & m_elementData[start];
+    }
+
+    /**
+     * Gets the index, within GetAllElementData, of the first of the
+     * \c slots of data registered to \c elementType, or -1 under the
+     * same conditions that GetElementDataSlots returns NULL.
+     */
+    s32 GetElementDataStartFromType(const u32 elementType, const u32 slots) const {
       s32 index = GetIndex(elementType);
-      if (index < 0) return 0;
+      if (index < 0) return -1;
 
-      if (m_hash[index].m_elementDataLength == 0) return 0;
-      if (m_hash[index].m_elementDataLength != slots) return 0;
-      return & m_elementData[m_hash[index].m_elementDataStart];
+      if (m_hash[index].m_elementDataLength == 0) return -1;
+      if (m_hash[index].m_elementDataLength != slots) return -1;
+      return m_hash[index].m_elementDataStart;
+    }
+
+    /**
+     * Gets all ELEMENT_DATA_SLOTS of element-specific data, whether
+     * registered or not.
+     */
+    const u64 * GetAllElementData() const {
+      return m_elementData;
     }
 
     u64 * GetDataAndRegister(const u32 elementType, u32 slots)
@@ -287,18 +398,34 @@ namespace MFM
      */
     u32 SlotFor(u32 elementType) const ;
 
+    /**
+     * Gets the index of the Element of type \c elementType by
+     * probing the hash.  The cold path of GetIndex, used only for
+     * types whose ordinals do not fit in m_denseSlot.
+     */
+    s32 ProbeIndex(u32 elementType) const ;
+
     struct ElementEntry {
       void Clear() {
         m_element = 0;
+        m_traits = 0;
         m_elementDataStart = 0;
         m_elementDataLength = 0;
       }
       const Element<CC>* m_element;
+      u32 m_traits;   // Copied from m_element, to spare a dereference
       u16 m_elementDataStart;
       u16 m_elementDataLength;
     } m_hash[SIZE];
     u32 m_hashSlotsInUse;
 
+    /**
+     * One more than the m_hash slot holding each registered type, or
+     * 0 if none, indexed by the type's StaticLoader ordinal.  Filled
+     * by Insert so that GetIndex needs no probing.
+     */
+    u16 m_denseSlot[DENSE_SIZE];
+
     u64 m_elementData[ELEMENT_DATA_SLOTS];
     u32 m_nextFreeElementDataIndex;
 
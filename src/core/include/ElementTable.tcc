@@ -6,6 +6,17 @@ namespace MFM {
 
   template <class C>
   s32 ElementTable<C>::GetIndex(u32 elementType) const
+  {
+    u32 ordinal = TypeLoader::OrdinalOfType(elementType);
+    if (ordinal < DENSE_SIZE)
+    {
+      return ((s32) m_denseSlot[ordinal]) - 1;
+    }
+    return ProbeIndex(elementType);
+  }
+
+  template <class C>
+  s32 ElementTable<C>::ProbeIndex(u32 elementType) const
   {
     u32 slot = SlotFor(elementType);
     if (m_hash[slot].m_element == 0) return -1;
@@ -44,16 +55,16 @@ namespace MFM {
       if (++m_hashSlotsInUse > SIZE/2)
         FAIL(OUT_OF_ROOM);
       m_hash[slotFor].m_element = &theElement;
+      m_hash[slotFor].m_traits = theElement.GetTraits();
 
+      u32 ordinal = TypeLoader::OrdinalOfType(type);
+      if (ordinal < DENSE_SIZE)
+      {
+        m_denseSlot[ordinal] = (u16) (slotFor + 1);
+      }
     }
   }
 
-  template <class C>
-  const Element<C> * ElementTable<C>::Lookup(u32 elementType) const
-  {
-    return m_hash[SlotFor(elementType)].m_element;
-  }
-
   template <class C>
   ElementTable<C>::ElementTable()
   {
@@ -66,6 +77,8 @@ namespace MFM {
     m_hashSlotsInUse = 0;
     for (u32 i = 0; i < SIZE; ++i)
       m_hash[i].Clear();
+    for (u32 i = 0; i < DENSE_SIZE; ++i)
+      m_denseSlot[i] = 0;
     m_nextFreeElementDataIndex = 0;
   }
 
@@ -54,6 +54,7 @@ namespace MFM {
     enum { R = P::EVENT_WINDOW_RADIUS };
     enum { W = P::TILE_WIDTH };
     enum { B = P::ELEMENT_TABLE_BITS };
+    enum { SITES = EVENT_WINDOW_SITES(R) };
 
     Tile<CC> & m_tile;
 
@@ -61,6 +62,114 @@ namespace MFM {
 
     PointSymmetry m_sym;
 
+    /**
+     * The row of MDistTables::symmetricIndex for m_sym, mapping MDist
+     * indices as the Element sees them to MDist indices in
+     * untransformed Tile orientation.
+     */
+    const u8 * m_symIndex;
+
+    /**
+     * The Tile's atom at m_center.  SetCenterInTile insists that the
+     * whole window lies inside the Tile, so every window site can be
+     * reached from here by offset, without further bounds checks.
+     */
+    T * m_centerAtom;
+
+    /**
+     * The window sites, as MDist indices in untransformed Tile
+     * orientation, whose contents have changed since the center was
+     * last set.  Only the first m_dirtySiteCount entries are valid.
+     */
+    u8 m_dirtySites[SITES];
+
+    /**
+     * The number of valid entries in m_dirtySites.
+     */
+    u32 m_dirtySiteCount;
+
+    /**
+     * m_isDirty[i] is true iff MDist index i appears in m_dirtySites.
+     */
+    bool m_isDirty[SITES];
+
+#ifdef MFM_EVENT_ROLLBACK
+    /**
+     * m_undo[i] is the atom that was at MDist index i when it first
+     * became dirty.  Only meaningful where m_isDirty[i] is true.
+     */
+    T m_undo[SITES];
+#endif
+
+    /**
+     * Records that the site at \c tileLoc, in untransformed Tile
+     * coordinates, has been modified during this event.
+     */
+    void MarkDirty(u32 tileIndex)
+    {
+      if (!m_isDirty[tileIndex])
+      {
+        m_isDirty[tileIndex] = true;
+        m_dirtySites[m_dirtySiteCount++] = (u8) tileIndex;
+      }
+    }
+
+    /**
+     * Gets the Tile location of the window site with MDist index \c
+     * tileIndex, in untransformed Tile orientation.
+     */
+    SPoint TileIndexToTile(u32 tileIndex) const
+    {
+      return m_center + SPoint(MDistTables::indexToPoint[tileIndex][0],
+                               MDistTables::indexToPoint[tileIndex][1]);
+    }
+
+    /**
+     * Gets the Tile's atom at the window site with MDist index \c
+     * tileIndex, in untransformed Tile orientation.
+     */
+    T & TileIndexToAtom(u32 tileIndex) const
+    {
+      return m_centerAtom[MDistTables::indexToPoint[tileIndex][0] * W +
+                          MDistTables::indexToPoint[tileIndex][1]];
+    }
+
+    /**
+     * Maps the MDist index \c siteIndex, as the Element sees it, to
+     * the MDist index in untransformed Tile orientation.  FAILs with
+     * ARRAY_INDEX_OUT_OF_BOUNDS if \c siteIndex is not in the window.
+     */
+    u32 SiteIndexToTileIndex(u32 siteIndex) const
+    {
+      if (siteIndex >= SITES)
+      {
+        FAIL(ARRAY_INDEX_OUT_OF_BOUNDS);
+      }
+      return m_symIndex[siteIndex];
+    }
+
+    /**
+     * Stores \c atom at the window site with MDist index \c
+     * tileIndex, in untransformed Tile orientation, and marks the
+     * site dirty if its contents actually changed.
+     */
+    void PlaceAtomTracked(const T & atom, u32 tileIndex)
+    {
+      const T & site = TileIndexToAtom(tileIndex);
+      const T before = site;
+      m_tile.PlaceAtom(atom, TileIndexToTile(tileIndex));
+      if (site != before)
+      {
+#ifdef MFM_EVENT_ROLLBACK
+        if (!m_isDirty[tileIndex])
+        {
+          m_undo[tileIndex] = before;
+        }
+#endif
+        MarkDirty(tileIndex);
+      }
+    }
+
     /**
      * Low-level, private because this does not guarantee loc is in
      * the window!
@@ -108,7 +217,12 @@ namespace MFM {
      */
     void SetSymmetry(const PointSymmetry psym)
     {
+      if ((u32) psym >= PSYM_SYMMETRY_COUNT)
+      {
+        FAIL(ILLEGAL_ARGUMENT);
+      }
       m_sym = psym;
+      m_symIndex = MDistTables::symmetricIndex[psym];
     }
 
     /**
@@ -149,25 +263,128 @@ namespace MFM {
       return m_tile.IsLiveSite(MapToTile(location));
     }
 
+    /**
+     * Checks to see if the site with MDist index \c siteIndex, as
+     * seen through the current PointSymmetry, may be used during
+     * event execution.
+     *
+     * @param siteIndex The MDist index of the site to check; FAILs
+     *                  with ARRAY_INDEX_OUT_OF_BOUNDS if it is not
+     *                  in this EventWindow .
+     *
+     * @returns \c true if this site may be reached during event
+     *          execution, else \c false .
+     */
+    bool IsLiveSite(u32 siteIndex) const
+    {
+      return m_tile.IsLiveSite(TileIndexToTile(SiteIndexToTileIndex(siteIndex)));
+    }
+
     /**
      * Constructs a new EventWindow which takes place on a specified
      * Tile with the default PointSymmetry of PSYM_NORMAL .
      *
      * @param tile The Tile which this EventWindow will take place in.
      */
-    EventWindow(Tile<CC> & tile) : m_tile(tile), m_sym(PSYM_NORMAL)
-    { }
+    EventWindow(Tile<CC> & tile) :
+      m_tile(tile),
+      m_sym(PSYM_NORMAL),
+      m_symIndex(MDistTables::symmetricIndex[PSYM_NORMAL]),
+      m_centerAtom(0),
+      m_dirtySiteCount(0)
+    {
+      for (u32 i = 0; i < SITES; ++i)
+      {
+        m_isDirty[i] = false;
+      }
+    }
 
     /**
      * Place this EventWindow within GetTile, in untransformed Tile
-     * coordinates.
+     * coordinates.  This also forgets any sites previously recorded
+     * as dirty.
      *
-     * @param center The new center of this EventWindow .
+     * @param center The new center of this EventWindow .  The whole
+     *               window must fit within the Tile, else this FAILs
+     *               with ILLEGAL_ARGUMENT .
      */
     void SetCenterInTile(const SPoint& center) {
+      if (((u32) (center.GetX() - R)) > W - 2 * R - 1 ||
+          ((u32) (center.GetY() - R)) > W - 2 * R - 1)
+      {
+        FAIL(ILLEGAL_ARGUMENT);
+      }
       m_center = center;
+      m_centerAtom = m_tile.GetWritableAtom(center);
+      ClearDirtySites();
+    }
+
+    /**
+     * Forgets all sites recorded as modified since the center was
+     * last set.
+     */
+    void ClearDirtySites()
+    {
+      while (m_dirtySiteCount > 0)
+      {
+        m_isDirty[m_dirtySites[--m_dirtySiteCount]] = false;
+      }
+    }
+
+    /**
+     * Gets the number of sites of this EventWindow whose contents
+     * have changed since the center was last set.
+     *
+     * @returns The number of modified sites in this EventWindow .
+     */
+    u32 GetDirtySiteCount() const
+    {
+      return m_dirtySiteCount;
+    }
+
+    /**
+     * Gets the MDist index, in untransformed Tile orientation (i.e.,
+     * ignoring the current PointSymmetry), of the \c i th modified
+     * site of this EventWindow .
+     *
+     * @param i Which modified site to get; must be less than
+     *          GetDirtySiteCount(), else this FAILs with
+     *          ARRAY_INDEX_OUT_OF_BOUNDS .
+     *
+     * @returns The MDist index of the \c i th modified site.
+     */
+    u32 GetDirtySite(u32 i) const
+    {
+      if (i >= m_dirtySiteCount)
+      {
+        FAIL(ARRAY_INDEX_OUT_OF_BOUNDS);
+      }
+      return m_dirtySites[i];
     }
 
+#ifdef MFM_EVENT_ROLLBACK
+    /**
+     * Restores every modified site of this EventWindow to what it
+     * held when the center was last set, so a failed event leaves no
+     * partial effects.  The sites remain dirty, so their restored
+     * contents still reach any neighbors that saw the changes.
+     *
+     * The snapshots go back with Tile::WriteAtom rather than
+     * PlaceAtom: they were already exposed to radiation once, and a
+     * restore must neither corrupt them nor draw on the Tile's
+     * Random.  WriteAtom counts only the change back, so the atom
+     * counts end where they began.
+     */
+    void RollBack()
+    {
+      for (u32 i = 0; i < m_dirtySiteCount; ++i)
+      {
+        const u32 tileIndex = m_dirtySites[i];
+        m_tile.WriteAtom(m_undo[tileIndex], TileIndexToTile(tileIndex));
+      }
+    }
+#endif
+
     /**
      * Get the position this EventWindow within the Tile it resides
      * in, in untransformed Tile coordinates.
@@ -206,7 +423,7 @@ namespace MFM {
      */
     const T& GetCenterAtom() const
     {
-      return *m_tile.GetAtom(m_center);
+      return *m_centerAtom;
     }
 
     /**
@@ -217,7 +434,7 @@ namespace MFM {
      */
     void SetCenterAtom(const T& atom)
     {
-      return m_tile.PlaceAtom(atom, m_center);
+      PlaceAtomTracked(atom, 0);
     }
 
     /**
@@ -232,6 +449,23 @@ namespace MFM {
      */
     const T& GetRelativeAtom(const SPoint& offset) const;
 
+    /**
+     * Gets the Atom at a specified MDist index in this EventWindow,
+     * as seen through the current PointSymmetry.  This is the
+     * cheapest way to visit the window: it is a pair of table
+     * lookups, with no symmetry dispatch and no Tile bounds checks.
+     *
+     * @param siteIndex The MDist index of the Atom to be retrieved.
+     *                  If this is not inside the EventWindow, will
+     *                  FAIL with ARRAY_INDEX_OUT_OF_BOUNDS .
+     *
+     * @returns The Atom at \c siteIndex .
+     */
+    const T& GetRelativeAtom(u32 siteIndex) const
+    {
+      return TileIndexToAtom(SiteIndexToTileIndex(siteIndex));
+    }
+
     /**
      * Sets an Atom residing at a specified location in this
      * EventWindow to a specified Atom .
@@ -247,6 +481,22 @@ namespace MFM {
      */
     bool SetRelativeAtom(const SPoint& offset, const T & atom);
 
+    /**
+     * Sets the Atom at a specified MDist index in this EventWindow,
+     * as seen through the current PointSymmetry, to a specified Atom
+     * .
+     *
+     * @param siteIndex The MDist index of the Atom to be set.  If
+     *                  this is not inside the EventWindow, will FAIL
+     *                  with ARRAY_INDEX_OUT_OF_BOUNDS .
+     *
+     * @param atom The Atom to place in this EventWindow .
+     *
+     * @returns \c true if the site is live and so was set, else \c
+     *          false .
+     */
+    bool SetRelativeAtom(u32 siteIndex, const T & atom);
+
     /**
      * Takes the Atom in a specified location and swaps it with an
      * Atom in another location.
@@ -257,6 +507,16 @@ namespace MFM {
      */
     void SwapAtoms(const SPoint& locA, const SPoint& locB);
 
+    /**
+     * Takes the Atom at one MDist index of this EventWindow and swaps
+     * it with the Atom at another.
+     *
+     * @param siteA The MDist index of the first Atom to swap
+     *
+     * @param siteB The MDist index of the second Atom to swap
+     */
+    void SwapAtoms(u32 siteA, u32 siteB);
+
   };
 } /* namespace MFM */
 
@@ -13,10 +13,25 @@ SPoint EventWindow<CC>::MapToTileValid(const SPoint& offset) const
 template <class CC>
 bool EventWindow<CC>::SetRelativeAtom(const SPoint& offset, const T & atom)
 {
+  s32 siteIndex = MDist<R>::get().FromPoint(offset, R);
+  if (siteIndex < 0)
+  {
+    if (IsLiveSite(offset))
+    {
+      FAIL(ILLEGAL_ARGUMENT);
+    }
+    return false;
+  }
+  return SetRelativeAtom((u32) siteIndex, atom);
+}
 
-  if (IsLiveSite(offset))
+template <class CC>
+bool EventWindow<CC>::SetRelativeAtom(u32 siteIndex, const T & atom)
+{
+  const u32 tileIndex = SiteIndexToTileIndex(siteIndex);
+  if (m_tile.IsLiveSite(TileIndexToTile(tileIndex)))
   {
-    m_tile.PlaceAtom(atom, MapToTileValid(offset));
+    PlaceAtomTracked(atom, tileIndex);
     return true;
   }
   return false;
@@ -25,19 +40,36 @@ bool EventWindow<CC>::SetRelativeAtom(const SPoint& offset, const T & atom)
 template <class CC>
 const typename CC::ATOM_TYPE& EventWindow<CC>::GetRelativeAtom(const SPoint& offset) const
 {
-  return *m_tile.GetAtom(MapToTileValid(offset));
+  s32 siteIndex = MDist<R>::get().FromPoint(offset, R);
+  if (siteIndex < 0)
+  {
+    FAIL(ILLEGAL_ARGUMENT);
+  }
+  return GetRelativeAtom((u32) siteIndex);
 }
 
 template <class CC>
 void EventWindow<CC>::SwapAtoms(const SPoint& locA, const SPoint& locB)
 {
-  SPoint arrLocA(MapToTileValid(locA));
-  SPoint arrLocB(MapToTileValid(locB));
+  s32 siteA = MDist<R>::get().FromPoint(locA, R);
+  s32 siteB = MDist<R>::get().FromPoint(locB, R);
+  if (siteA < 0 || siteB < 0)
+  {
+    FAIL(ILLEGAL_ARGUMENT);
+  }
+  SwapAtoms((u32) siteA, (u32) siteB);
+}
+
+template <class CC>
+void EventWindow<CC>::SwapAtoms(u32 siteA, u32 siteB)
+{
+  const u32 tileA = SiteIndexToTileIndex(siteA);
+  const u32 tileB = SiteIndexToTileIndex(siteB);
 
-  T a = *m_tile.GetAtom(arrLocA);
-  T b = *m_tile.GetAtom(arrLocB);
-  m_tile.PlaceAtom(b, arrLocA);
-  m_tile.PlaceAtom(a, arrLocB);
+  T a = TileIndexToAtom(tileA);
+  T b = TileIndexToAtom(tileB);
+  PlaceAtomTracked(b, tileA);
+  PlaceAtomTracked(a, tileB);
 }
 
 
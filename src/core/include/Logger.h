@@ -32,7 +32,20 @@
 #include "ByteSink.h"
 #include "ByteSerializable.h"
 #include "Mutex.h"
+#include "Atomic.h"
 #include <stdarg.h>
+#include <pthread.h>
+
+/**
+ * The least severe Logger::Level that is compiled in at all (as a
+ * number; the default, 8, is Logger::ALL).  Messages below it are
+ * never written whatever the runtime level, and messages logged via
+ * the MFM_LOG_ macros below it cost nothing: their arguments are not
+ * even evaluated.
+ */
+#ifndef MFM_LOG_COMPILED_LEVEL
+#define MFM_LOG_COMPILED_LEVEL 8
+#endif
 
 namespace MFM
 {
@@ -40,6 +53,21 @@ namespace MFM
   /**
    * A logging system used for logging different kinds of messages to
    * a ByteSink .
+   *
+   * By default each message is formatted and written while holding a
+   * lock, so threads that log contend with each other.  After
+   * StartAsync, each thread instead appends a compact record -- the
+   * format string pointer plus its arguments -- to a ring of its own,
+   * without locking, and a background thread formats and writes the
+   * records.  When a thread's ring is full, DEBUG-and-above records
+   * are dropped (and counted), while more severe ones are written
+   * synchronously after the thread's queued records.  A record holds
+   * about 128 bytes of %s and %@ text in all; messages with more, or
+   * with conversions a record can't capture, are also written
+   * synchronously, so nothing is ever clipped.
+   *
+   * Only one Logger may be asynchronous at a time, since each thread
+   * keeps a single ring pointer, not one per Logger.
    */
   class Logger
   {
@@ -170,6 +198,7 @@ namespace MFM
      */
     ByteSink * SetByteSink(ByteSink & byteSink)
     {
+      Mutex::ScopeLock lock(m_mutex); // Hold lock for this block
       ByteSink * old = m_sink;
       m_sink = &byteSink;
       return old;
@@ -186,12 +215,70 @@ namespace MFM
     Logger(ByteSink & sink, Level initialLevel) :
       m_sink(&sink),
       m_logLevel(initialLevel),
+      m_async(false),
+      m_rings(0),
+      m_ringsClaimed(0),
+      m_asyncEpoch(0),
       m_timeStamper(&m_defaultTimeStamper)
     {
+      for (u32 i = 0; i <= MAX; ++i)
+      {
+        m_droppedReported[i] = 0;
+      }
+    }
+
+    ~Logger() ;
+
+    enum
+    {
+      /**
+       * The most threads that can log asynchronously; any more log
+       * synchronously.
+       */
+      MAX_RINGS = 128,
+
+      /**
+       * How many records each thread may have waiting to be written
+       */
+      RING_RECORDS = 64
+    };
+
+    /**
+     * Starts the background thread that writes records queued by
+     * logging threads.  Until StopAsync, messages are written in the
+     * order each thread logged them, but messages from different
+     * threads may interleave differently than they were logged, and
+     * time stamps reflect when they were written.  FAILs with
+     * ILLEGAL_STATE if another Logger is already asynchronous.
+     */
+    void StartAsync() ;
+
+    /**
+     * Writes all queued records, stops the background thread, and
+     * returns this Logger to logging synchronously.  Does nothing
+     * unless StartAsync was called.
+     */
+    void StopAsync() ;
+
+    /**
+     * Checks whether this Logger is logging asynchronously.
+     */
+    bool IsAsync() const
+    {
+      return m_async.Load(MEMORY_ORDER_RELAXED);
     }
 
-    ~Logger()
+    /**
+     * Gets the number of records at \c level dropped so far because
+     * the logging thread's ring was full.
+     */
+    u32 GetDroppedRecords(Level level) const
     {
+      if (!ValidLevel(level))
+      {
+        FAIL(ILLEGAL_ARGUMENT);
+      }
+      return m_dropped[level].Load(MEMORY_ORDER_RELAXED);
     }
 
     /**
@@ -240,10 +327,21 @@ namespace MFM
      */
     void Vreport(Level level, const char * format, va_list & ap)
     {
-      if (IfLog(level))
+      if (level <= MFM_LOG_COMPILED_LEVEL && IfLog(level))
       {
+        if (m_async.Load(MEMORY_ORDER_ACQUIRE) && Enqueue(level, format, ap))
+        {
+          return;
+        }
+
         Mutex::ScopeLock lock(m_mutex); // Hold lock for this block
 
+        if (s_threadRingEpoch == m_asyncEpoch && s_threadRing)
+        {
+          // Anything this thread queued must come out first
+          DrainRing(*s_threadRing);
+        }
+
         m_sink->Printf("%@%s: ",m_timeStamper, StrLevel(level));
         m_sink->Vprintf(format, ap);
         m_sink->Println();
@@ -315,6 +413,7 @@ namespace MFM
      */
     void SetTimeStamper(ByteSerializable * stamper)
     {
+      Mutex::ScopeLock lock(m_mutex); // Hold lock for this block
       m_timeStamper = stamper? stamper : &m_defaultTimeStamper;
       m_defaultTimeStamper.Reset();
     }
@@ -325,10 +424,115 @@ namespace MFM
 
     /**
      * A lock to ensure only one thread does logging at a time; the
-     * underlying ByteSink routines are not thread-safe.
+     * underlying ByteSink routines are not thread-safe.  In async
+     * mode, whoever holds it may also consume from the rings.
      */
     Mutex m_mutex;
 
+    /**
+     * One queued message; see Encode
+     */
+    struct LogRecord;
+
+    /**
+     * A single-producer ring of LogRecords.  Only its owning thread
+     * appends, and records are only consumed under m_mutex.
+     */
+    struct LogRing;
+
+    /**
+     * True between StartAsync and StopAsync
+     */
+    Atomic<bool> m_async;
+
+    /**
+     * MAX_RINGS rings, allocated by the first StartAsync
+     */
+    LogRing * m_rings;
+
+    /**
+     * How many of m_rings have been claimed by threads since
+     * StartAsync; may exceed MAX_RINGS
+     */
+    Atomic<u32> m_ringsClaimed;
+
+    /**
+     * Distinguishes this StartAsync, of this Logger, from all others,
+     * so stale thread-local ring pointers are never used
+     */
+    u32 m_asyncEpoch;
+
+    /**
+     * Source of m_asyncEpoch values
+     */
+    static u32 s_asyncEpochs;
+
+    /**
+     * How many Loggers are asynchronous; never more than one, since
+     * s_threadRing serves whichever one is
+     */
+    static Atomic<u32> s_asyncLoggers;
+
+    /**
+     * The ring this thread appends to, valid if s_threadRingEpoch
+     * matches m_asyncEpoch.  Null if no ring was available.
+     */
+    static __thread LogRing * s_threadRing;
+
+    static __thread u32 s_threadRingEpoch;
+
+    /**
+     * Records dropped at each Level because a ring was full
+     */
+    Atomic<u32> m_dropped[MAX + 1];
+
+    /**
+     * The m_dropped counts already reported in the log.  Guarded by
+     * m_mutex.
+     */
+    u32 m_droppedReported[MAX + 1];
+
+    pthread_t m_writerThread;
+
+    /**
+     * Queues a message on this thread's ring.
+     *
+     * @returns \c false if the message must instead be written
+     *          synchronously -- because its format can't be captured,
+     *          its text won't fit in a record, or the ring is full --
+     *          with \c ap still unused.
+     */
+    bool Enqueue(Level level, const char * format, va_list & ap) ;
+
+    /**
+     * Gets this thread's ring, claiming one if need be.  Returns
+     * null if all MAX_RINGS have been claimed.
+     */
+    LogRing * GetThreadRing() ;
+
+    /**
+     * Writes and removes every record in \c ring.  Caller must hold
+     * m_mutex.
+     *
+     * @returns the number of records written.
+     */
+    u32 DrainRing(LogRing & ring) ;
+
+    /**
+     * Drains every claimed ring and reports any newly dropped
+     * records.  Takes m_mutex.
+     *
+     * @returns the number of records written.
+     */
+    u32 DrainAllRings() ;
+
+    /**
+     * Formats and writes one record.  Caller must hold m_mutex.
+     */
+    void WriteRecord(const LogRecord & rec) ;
+
+    static void * WriterThread(void * arg) ;
+
     class DefaultTimeStamper : public ByteSerializable
     {
       u32 m_calls;
@@ -348,6 +552,105 @@ namespace MFM
 
   extern Logger LOG;
 
+  /**
+   * Limits how often a call site may log, for diagnostics in paths
+   * that can run millions of times a second.  Each LogRateLimiter
+   * allows at most a fixed number of messages per wall-clock second;
+   * the first message allowed in a later second is preceded by a count
+   * of those refused in between.  Typically a call site owns one,
+   * as a static or a member, and logs through one of the
+   * MFM_LOG_*_LIMITED macros.  Safe to share between threads, though
+   * the limit is then approximate.
+   */
+  class LogRateLimiter
+  {
+  public:
+    /**
+     * Constructs a LogRateLimiter allowing \c perSecond messages per
+     * second.
+     */
+    LogRateLimiter(u32 perSecond) :
+      m_perSecond(perSecond),
+      m_second(0),
+      m_count(0),
+      m_refused(0)
+    { }
+
+    /**
+     * Checks whether a message at \c level may be logged now, counting
+     * it either way.
+     */
+    bool Allow(Logger::Level level) ;
+
+    /**
+     * As Allow(level), but as if it were now \c second , a nonzero
+     * count of seconds from any fixed origin.  For callers (such as
+     * tests) that keep their own time.
+     */
+    bool Allow(Logger::Level level, u32 second) ;
+
+    /**
+     * Gets the number of messages refused since the last report.
+     */
+    u32 GetRefused() const
+    {
+      return m_refused.Load(MEMORY_ORDER_RELAXED);
+    }
+
+  private:
+    const u32 m_perSecond;
+
+    /**
+     * The second m_count is counting; zero until first used.
+     */
+    Atomic<u32> m_second;
+
+    Atomic<u32> m_count;
+
+    Atomic<u32> m_refused;
+  };
+
 } /* namespace MFM */
 
+/**
+ * True if messages at Logger::\c level are compiled in and currently
+ * enabled in LOG.
+ */
+#define MFM_LOG_ENABLED(level) \
+  (MFM::Logger::level <= MFM_LOG_COMPILED_LEVEL && MFM::LOG.IfLog(MFM::Logger::level))
+
+/**
+ * Logs to LOG through \c method if \c level is enabled and \c cond
+ * holds, evaluating \c cond and the message arguments only then.
+ * Expands to a single statement, so it is safe as the body of an
+ * unbraced if.
+ */
+#define MFM_LOG_IF(level, method, cond) \
+  if (!(MFM_LOG_ENABLED(level) && (cond))) { } else MFM::LOG.method
+
+/**
+ * Drop-in replacements for LOG.Error(...) etc., which are compiled
+ * out below MFM_LOG_COMPILED_LEVEL and skip argument evaluation when
+ * the runtime level filters them out.  Use as
+ * MFM_LOG_DBG("format", args...);
+ */
+#define MFM_LOG_ERR MFM_LOG_IF(ERROR, Error, true)
+#define MFM_LOG_WRN MFM_LOG_IF(WARNING, Warning, true)
+#define MFM_LOG_MSG MFM_LOG_IF(MESSAGE, Message, true)
+#define MFM_LOG_DBG MFM_LOG_IF(DEBUG, Debug, true)
+
+/**
+ * As MFM_LOG_ERR etc., but also subject to the LogRateLimiter \c
+ * limiter, which is consulted only if the level is enabled.  Use as
+ * MFM_LOG_DBG_LIMITED(limiter)("format", args...);
+ */
+#define MFM_LOG_ERR_LIMITED(limiter) \
+  MFM_LOG_IF(ERROR, Error, (limiter).Allow(MFM::Logger::ERROR))
+#define MFM_LOG_WRN_LIMITED(limiter) \
+  MFM_LOG_IF(WARNING, Warning, (limiter).Allow(MFM::Logger::WARNING))
+#define MFM_LOG_MSG_LIMITED(limiter) \
+  MFM_LOG_IF(MESSAGE, Message, (limiter).Allow(MFM::Logger::MESSAGE))
+#define MFM_LOG_DBG_LIMITED(limiter) \
+  MFM_LOG_IF(DEBUG, Debug, (limiter).Allow(MFM::Logger::DEBUG))
+
 #endif /*LOGGER_H*/
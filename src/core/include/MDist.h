@@ -34,6 +34,9 @@
 #include "Point.h"
 #include "Random.h"
 #include "Dirs.h"
+#include "PSym.h"
+#include "Util.h"     /* For COMPILATION_REQUIREMENT */
+#include "Fail.h"
 
 namespace MFM
 {
@@ -61,9 +64,73 @@ namespace MFM
     MANHATTAN_TABLE_EVENT = MANHATTAN_TABLE_RADIUS_4
   } TableType;
 
+  /**
+   * The precomputed Manhattan distance tables behind every MDist<R>.
+   * Sites are numbered in order of increasing Manhattan length, and
+   * in a fixed order within each length, so the numbering never
+   * depends on the radius: the sites of MDist<R> are exactly the
+   * first EVENT_WINDOW_SITES(R) entries here.  That lets one set of
+   * tables, sized for MAX_RADIUS, serve every MDist.
+   *
+   * The tables themselves are generated into MDist_tables.inc; see
+   * MDist.cpp.
+   */
+  struct MDistTables
+  {
+    /**
+     * The largest radius covered by the tables
+     */
+    static const u32 MAX_RADIUS = MANHATTAN_TABLE_RADIUS_4;
+
+    /**
+     * The width and height of the MAX_RADIUS window
+     */
+    static const u32 MAX_DIAMETER = MAX_RADIUS*2+1;
+
+    /**
+     * The number of sites within MAX_RADIUS of the center
+     */
+    static const u32 MAX_SITES = EVENT_WINDOW_SITES(MAX_RADIUS);
+
+    /**
+     * A pointToIndex entry marking a position beyond MAX_RADIUS
+     */
+    static const u8 NO_INDEX = 0xff;
+
+    /**
+     * indexToPoint[i] is the {x, y} offset of site i from the center
+     */
+    static const s8 indexToPoint[MAX_SITES][2];
+
+    /**
+     * pointToIndex[x + MAX_RADIUS][y + MAX_RADIUS] is the site number
+     * of offset (x, y), or NO_INDEX
+     */
+    static const u8 pointToIndex[MAX_DIAMETER][MAX_DIAMETER];
+
+    /**
+     * firstIndex[r] is the lowest site number of length r, and
+     * firstIndex[MAX_RADIUS+1] is MAX_SITES
+     */
+    static const u8 firstIndex[MAX_RADIUS + 2];
+
+    /**
+     * symmetricIndex[psym][i] is the site number of site i's offset
+     * after mapping it through PointSymmetry psym.  Point symmetries
+     * preserve Manhattan length, so this is a permutation of each
+     * length's sites, and so of the sites of every MDist<R>.
+     */
+    static const u8 symmetricIndex[PSYM_SYMMETRY_COUNT][MAX_SITES];
+  };
+
   /**
    * A singleton class consisting of many utilities used for
-   * calculating Manhattan Distances.
+   * calculating Manhattan Distances.  MDist holds no state of its
+   * own--all its lookups go to the static MDistTables--so there is
+   * nothing to build at startup, and it is not copyable: hold on to
+   * it by reference, as in
+   *
+   *     const MDist<R> & md = MDist<R>::get();
    */
   template <u32 R>
   class MDist
@@ -77,7 +144,10 @@ namespace MFM
     /**
      * Access the singleton MDist of any given size.
      */
-    static MDist<R> & get();
+    static const MDist<R> & get()
+    {
+      return m_instance;
+    }
 
     /**
      * Fills a given SPoint with a random Von Neumann unit vector.
@@ -107,11 +177,11 @@ namespace MFM
      */
     u32 GetFirstIndex(const u32 radius) const
     {
-      if (radius >= sizeof(m_firstIndex)/sizeof(m_firstIndex[0]))
+      if (radius > R + 1)
       {
         FAIL(ILLEGAL_ARGUMENT);
       }
-      return m_firstIndex[radius];
+      return MDistTables::firstIndex[radius];
     }
 
     /**
@@ -127,17 +197,19 @@ namespace MFM
       return GetFirstIndex(radius+1)-1;
     }
 
-    const SPoint & GetPoint(const u32 index) const
+    /**
+     * Gets the offset from the center of the site numbered \c index.
+     */
+    SPoint GetPoint(const u32 index) const
     {
       if (index >= ARRAY_LENGTH)
       {
         FAIL(ILLEGAL_ARGUMENT);
       }
-      return m_indexToPoint[index];
+      return SPoint(MDistTables::indexToPoint[index][0],
+                    MDistTables::indexToPoint[index][1]);
     }
 
-    MDist();
-
     /**
      * Return the coding of offset as a bond if possible.  Returns -1 if
      * the given offset cannot be expressed as a max length radius bond.
@@ -148,26 +220,27 @@ namespace MFM
      * Fills pt with the point represented by bits.
      * Uses a 4-bit rep if maxRadius less than 3
      */
-    void FillFromBits(SPoint& pt, u8 bits, u32 maxRadius);
+    void FillFromBits(SPoint& pt, u8 bits, u32 maxRadius) const;
 
   private:
     static const u32 ARRAY_LENGTH = EVENT_WINDOW_SITES(R);
 
-    static inline u32 ManhattanArea(u32 maxDistance)
+    static MDist<R> m_instance;
+
+    MDist()
     {
-      return EVENT_WINDOW_SITES(maxDistance);
+      COMPILATION_REQUIREMENT< R <= MDistTables::MAX_RADIUS >();
     }
 
-    Point<s32> m_indexToPoint[ARRAY_LENGTH];
-    s32 m_pointToIndex[EVENT_WINDOW_DIAMETER][EVENT_WINDOW_DIAMETER];
-
-    u32 m_firstIndex[R+2];  // m_firstIndex[R+1] holds 'lastIndex[R]'
-
-    void InitEscapesByDirTable();
-    u8 m_escapesByDirection[Dirs::DIR_COUNT][ARRAY_LENGTH];
+    /**
+     * Not implemented; MDist is not copyable.
+     */
+    MDist(const MDist<R> &);
 
-    void InitHorizonsByDirTable();
-    u8 m_horizonsByDirection[Dirs::DIR_COUNT][ARRAY_LENGTH];
+    /**
+     * Not implemented; MDist is not assignable.
+     */
+    MDist<R> & operator=(const MDist<R> &);
 
   };
 } /* namespace MFM */
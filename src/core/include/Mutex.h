@@ -29,6 +29,7 @@
 #define MUTEX_H
 
 #include <pthread.h>  /* for pthread_mutex_t etc */
+#include <time.h>     /* for struct timespec */
 #include "Fail.h"
 
 #ifdef MUTEX_ERROR_CHECKS
@@ -63,6 +64,12 @@ namespace MFM
 
     void CondWait(pthread_cond_t & condvar)
     {
+      // The wait releases the lock without going through
+      // Mutex::Unlock; simulate its effects, lest a wakeup that
+      // nobody else locked in between look like a double lock
+      m_locked = false;
+      m_threadId = 0;
+
       pthread_cond_wait(&condvar, &m_lock);
 
       // The signal gave us back the lock without going through
@@ -75,6 +82,31 @@ namespace MFM
       m_locked = true;
     }
 
+    /**
+     * As CondWait, but gives up at \c deadline (on CLOCK_REALTIME).
+     *
+     * @returns false if the deadline passed before a signal arrived.
+     */
+    bool CondTimedWait(pthread_cond_t & condvar, const struct timespec & deadline)
+    {
+      // As in CondWait.  Here it matters even without spurious
+      // wakeups: nobody need touch the lock before the deadline.
+      m_locked = false;
+      m_threadId = 0;
+
+      bool signaled = !pthread_cond_timedwait(&condvar, &m_lock, &deadline);
+
+      // Either way we have the lock back without going through
+      // Mutex::Lock; simulate its effects
+      if (m_locked)
+      {
+        FAIL(LOCK_FAILURE);
+      }
+      m_threadId = pthread_self();
+      m_locked = true;
+      return signaled;
+    }
+
   public:
 
     class ScopeLock {
@@ -115,6 +147,28 @@ namespace MFM
         }
       }
 
+      /**
+       * As WaitForCondition, but gives up at \c deadline (on
+       * CLOCK_REALTIME).
+       *
+       * @returns true if the predicate holds, false if the deadline
+       *          passed first.
+       */
+      bool WaitForConditionUntil(const struct timespec & deadline)
+      {
+        m_mutex.AssertIHoldTheLock();
+        m_threadIdOfWaiter = m_mutex.m_threadId;
+
+        while (!EvaluatePredicate())
+        {
+          if (!m_mutex.CondTimedWait(m_condvar, deadline))
+          {
+            return EvaluatePredicate();
+          }
+        }
+        return true;
+      }
+
       void SignalCondition()
       {
         m_mutex.AssertIHoldTheLock();
@@ -128,7 +128,7 @@ namespace MFM {
     {
       u32 fixedHeader = AFFixedHeader::Read(this->m_bits);
       u32 repairedHeader =
-        Parity2D_4x4::Correct2DParityIfPossible(fixedHeader);
+        Parity2D_4x4::CheckAndCorrect2DParity(fixedHeader);
 
       if (repairedHeader == 0) return false;
 
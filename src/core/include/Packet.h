@@ -48,7 +48,8 @@ namespace MFM
       /**
        * Used to keep inter-tile buffers from overflowing, this PacketType
        * describes that a Tile has completed processing an event and
-       * is ready to unlock its caches.
+       * is ready to unlock its caches.  Each carries a per-Connection
+       * sequence number, so several may be outstanding at once.
        */
       PACKET_EVENT_COMPLETE,
 
@@ -57,9 +58,18 @@ namespace MFM
        * PacketType describes that a Tile has completed all event
        * processing from another Tile's events. In practice, a Packet
        * of this PacketType should be sent immediately upon receipt
-       * of a PACKET_EVENT_COMPLETE Packet.
+       * of a PACKET_EVENT_COMPLETE Packet, carrying the same sequence
+       * number.
        */
-      PACKET_EVENT_ACKNOWLEDGE
+      PACKET_EVENT_ACKNOWLEDGE,
+
+      /**
+       * This PacketType describes a Tile's intent to write several
+       * atoms at once.  A Packet of this PacketType is immediately
+       * followed, within the same Connection write, by
+       * GetUpdateCount() PacketUpdate records.
+       */
+      PACKET_UPDATE
 
     }PacketType;
 
@@ -88,6 +98,18 @@ namespace MFM
      */
     u8 m_generation;
 
+    /**
+     * The number of PacketUpdate records following a PACKET_UPDATE
+     * Packet.
+     */
+    u8 m_updateCount;
+
+    /**
+     * Matches a PACKET_EVENT_ACKNOWLEDGE to the
+     * PACKET_EVENT_COMPLETE it acknowledges.
+     */
+    u8 m_sequence;
+
     /**
      * Used to describe a location during Tile communication.
      */
@@ -106,7 +128,9 @@ namespace MFM
     Packet(PacketType type, u8 generation) :
       m_type(type),
       m_toNeighbor(Dirs::DIR_COUNT), // Init invalid
-      m_generation(generation)
+      m_generation(generation),
+      m_updateCount(0),
+      m_sequence(0)
     { }
 
     const char* GetTypeString()
@@ -116,6 +140,7 @@ namespace MFM
       case PACKET_WRITE: return "Write";
       case PACKET_EVENT_COMPLETE: return "Event Complete";
       case PACKET_EVENT_ACKNOWLEDGE: return "Event Acknowledge";
+      case PACKET_UPDATE: return "Update";
       }
       return "INVALID";
     }
@@ -221,6 +246,56 @@ namespace MFM
       m_generation = generation;
     }
 
+    /**
+     * Gets the number of PacketUpdate records following this
+     * PACKET_UPDATE Packet.
+     *
+     * @returns The number of PacketUpdate records following this Packet.
+     */
+    u32 GetUpdateCount() const
+    {
+      return m_updateCount;
+    }
+
+    /**
+     * Sets the number of PacketUpdate records following this
+     * PACKET_UPDATE Packet.
+     *
+     * @param count The number of PacketUpdate records that will
+     *              follow this Packet.
+     */
+    void SetUpdateCount(u32 count)
+    {
+      if (count > U8_MAX)
+      {
+        FAIL(ILLEGAL_ARGUMENT);
+      }
+      m_updateCount = (u8) count;
+    }
+
+    /**
+     * Gets the sequence number of this PACKET_EVENT_COMPLETE or
+     * PACKET_EVENT_ACKNOWLEDGE Packet.
+     *
+     * @returns This Packet's sequence number.
+     */
+    u8 GetSequence() const
+    {
+      return m_sequence;
+    }
+
+    /**
+     * Sets the sequence number of this PACKET_EVENT_COMPLETE or
+     * PACKET_EVENT_ACKNOWLEDGE Packet.  Sequence numbers count
+     * events per Connection direction, modulo 256.
+     *
+     * @param sequence The new sequence number of this Packet.
+     */
+    void SetSequence(u8 sequence)
+    {
+      m_sequence = sequence;
+    }
+
     /**
      * Determine if this packet is obsolete compared to \c
      * ourGeneration.
@@ -233,6 +308,68 @@ namespace MFM
       return ((u8) (m_generation - ourGeneration)) >= U8_MAX / 2;
     }
   };
+
+  /**
+   * A single atom write carried in the body of a PACKET_UPDATE
+   * Packet.
+   */
+  template <class T>
+  class PacketUpdate
+  {
+  private:
+
+    /**
+     * The location, in the receiving Tile's coordinates, to write.
+     */
+    SSPoint m_edgeLoc;
+
+    /**
+     * The Atom to write at m_edgeLoc.
+     */
+    T m_atom;
+
+  public:
+
+    /**
+     * Sets this PacketUpdate's held location.
+     *
+     * @param fromPt The SPoint to copy into this PacketUpdate.
+     */
+    void SetLocation(const SPoint& fromPt)
+    {
+      m_edgeLoc = SSPoint(fromPt.GetX(), fromPt.GetY());
+    }
+
+    /**
+     * Gets this PacketUpdate's held location.
+     *
+     * @returns This PacketUpdate's held location.
+     */
+    const SPoint GetLocation() const
+    {
+      return SPoint(m_edgeLoc.GetX(), m_edgeLoc.GetY());
+    }
+
+    /**
+     * Sets this PacketUpdate's held Atom.
+     *
+     * @param atom The Atom to copy into this PacketUpdate.
+     */
+    void SetAtom(const T& atom)
+    {
+      m_atom = atom;
+    }
+
+    /**
+     * Gets a reference to this PacketUpdate's held Atom.
+     *
+     * @returns A reference to this PacketUpdate's held Atom.
+     */
+    T& GetAtom()
+    {
+      return m_atom;
+    }
+  };
 } /* namespace MFM */
 
 #endif /*PACKET_H*/
@@ -31,6 +31,7 @@
 #include "BitVector.h"
 #include "ByteSerializable.h"
 #include "OverflowableCharBufferByteSink.h"
+#include "Atomic.h"
 #include "Util.h"
 
 namespace MFM
@@ -38,6 +39,13 @@ namespace MFM
   class Parameters
   {
    public:
+    /**
+     * The most S32 and Bool Parameters one Parameters collection may
+     * hold; their current values live together in this collection,
+     * rather than in the Parameters themselves.
+     */
+    static const u32 MAX_VALUES = 16;
+
     /**
      * An enumeration of all known types of Parameters .
      */
@@ -282,10 +290,15 @@ namespace MFM
     class S32 : public Parameter
     {
       /**
-       * The mutable current signed 32-bit value that this Parameter
-       * represents.
+       * The Parameters collection holding the mutable current signed
+       * 32-bit value that this Parameter represents.
+       */
+      Parameters & m_owner;
+
+      /**
+       * Where in m_owner the current value lives.
        */
-      s32 m_current;
+      s32 * m_current;
 
       /**
        * The permanent minimum signed 32-bit value that this Parameter
@@ -334,7 +347,7 @@ namespace MFM
 
       virtual void Print(ByteSink & bs) const
       {
-        bs.Print(m_current);
+        bs.Print(*m_current);
       }
 
       virtual bool Read(ByteSource & bs)
@@ -349,7 +362,7 @@ namespace MFM
           return false;
         }
 
-        m_current = val;
+        m_owner.PublishValue(m_current, val);
         return true;
       }
 
@@ -392,6 +405,8 @@ namespace MFM
           const char* description,
           s32 min, s32 initial, s32 max, s32 snap)
         : Parameter(c, tag, name, description),
+          m_owner(c),
+          m_current(c.AllocateValue()),
           m_min(min),
           m_initial(initial),
           m_max(max < min ? min : max),
@@ -402,14 +417,15 @@ namespace MFM
 
       /**
        * Gets the signed 32-bit value which this Parameter is
-       * currently representing.
+       * currently representing.  Not virtual, so that element
+       * behaviors may read their parameters in their inner loops.
        *
        * @returns The signed 32-bit value which this Parameter is
        * currently representing.
        */
-      virtual s32 GetValue() const
+      s32 GetValue() const
       {
-        return m_current;
+        return *m_current;
       }
 
       /**
@@ -422,11 +438,11 @@ namespace MFM
        * @param value The new signed 32-bit value which the Parameter
        *              is wished to represent.
        */
-      virtual void SetValue(s32 value)
+      void SetValue(s32 value)
       {
         value = CLAMP(m_min, m_max, value);
         value -= value % m_snap;
-        m_current = CLAMP(m_min, m_max, value);
+        m_owner.PublishValue(m_current, CLAMP(m_min, m_max, value));
       }
 
       /**
@@ -508,9 +524,15 @@ namespace MFM
     class Bool : public Parameter
     {
       /**
-       * The current boolean value which this Parameter represents.
+       * The Parameters collection holding the current boolean value
+       * which this Parameter represents, as 0 or 1.
+       */
+      Parameters & m_owner;
+
+      /**
+       * Where in m_owner the current value lives.
        */
-      bool m_current;
+      s32 * m_current;
 
       /**
        * The permanent boolean vlue which this Parameter reprsented at
@@ -543,7 +565,7 @@ namespace MFM
 
       virtual void Print(ByteSink& bs) const
       {
-        bs.Print(m_current?"true":"false");
+        bs.Print(*m_current?"true":"false");
       }
 
       virtual bool Read(ByteSource& bs)
@@ -556,13 +578,13 @@ namespace MFM
 
         if (val.Equals("true"))
         {
-          m_current = true;
+          SetValue(true);
           return true;
         }
 
         if (val.Equals("false"))
         {
-          m_current = false;
+          SetValue(false);
           return true;
         }
 
@@ -597,6 +619,8 @@ namespace MFM
           const char* description,
           bool initial)
         : Parameter(c, tag, name, description),
+          m_owner(c),
+          m_current(c.AllocateValue()),
           m_initial(initial)
       {
         SetValue(m_initial);
@@ -604,14 +628,15 @@ namespace MFM
 
       /**
        * Gets the boolean value that this Parameter currently
-       * represents.
+       * represents.  Not virtual, so that element behaviors may read
+       * their parameters in their inner loops.
        *
        * @returns The boolean value that this Parameter currently
        * represents.
        */
-      virtual bool GetValue() const
+      bool GetValue() const
       {
-        return m_current;
+        return *m_current != 0;
       }
 
       /**
@@ -621,9 +646,9 @@ namespace MFM
        * @param value The value that this Parameter will represent
        *              after calling this method.
        */
-      virtual void SetValue(bool value)
+      void SetValue(bool value)
       {
-        m_current = value;
+        m_owner.PublishValue(m_current, value ? 1 : 0);
       }
 
     };
@@ -632,8 +657,40 @@ namespace MFM
      * Constructs and initializes a Parameters collection as an empty collection.
      */
     Parameters() :
-      m_firstParameter(0)
+      m_firstParameter(0),
+      m_valuesUsed(0),
+      m_version(0)
+    {
+    }
+
+    /**
+     * Gets the current values of the S32 and Bool Parameters in this
+     * collection, in the order they were constructed, as one flat
+     * array of GetValueCount() entries.  Bool values are 0 or 1.
+     */
+    const s32 * GetValues() const
+    {
+      return m_values;
+    }
+
+    /**
+     * Gets the number of entries in GetValues() .
+     */
+    u32 GetValueCount() const
+    {
+      return m_valuesUsed;
+    }
+
+    /**
+     * Gets the number of times any value in this collection has been
+     * changed.  A reader that caches values derived from these
+     * Parameters can compare versions to learn when to recompute
+     * them.  The load has acquire semantics, so a reader that sees a
+     * new version also sees the value written before it.
+     */
+    u32 GetVersion() const
     {
+      return m_version.Load(MEMORY_ORDER_ACQUIRE);
     }
 
     /**
@@ -797,6 +854,58 @@ namespace MFM
      * collection.
      */
     Parameter* m_firstParameter;
+
+    /**
+     * The current values of the S32 and Bool Parameters held by this
+     * collection.
+     */
+    s32 m_values[MAX_VALUES];
+
+    /**
+     * The number of entries of m_values in use.
+     */
+    u32 m_valuesUsed;
+
+    /**
+     * Bumped on every change to m_values .
+     */
+    Atomic<u32> m_version;
+
+    /**
+     * Parameters collections are not copyable, since their Parameters
+     * point into them.
+     */
+    Parameters(const Parameters &);
+    Parameters & operator=(const Parameters &);
+
+    /**
+     * Claims the next entry of m_values for a Parameter being
+     * constructed.  FAILs with OUT_OF_ROOM if there are already
+     * MAX_VALUES of them.
+     */
+    s32 * AllocateValue()
+    {
+      if (m_valuesUsed >= MAX_VALUES)
+      {
+        FAIL(OUT_OF_ROOM);
+      }
+      s32 * slot = &m_values[m_valuesUsed++];
+      *slot = 0;
+      return slot;
+    }
+
+    /**
+     * Stores a new value into one of m_values and bumps m_version ,
+     * if the value actually changed.
+     */
+    void PublishValue(s32 * slot, s32 value)
+    {
+      if (*slot != value)
+      {
+        *slot = value;
+        m_version.FetchAdd(1, MEMORY_ORDER_RELEASE);
+      }
+    }
   };
 }
 
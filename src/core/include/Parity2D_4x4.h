@@ -47,15 +47,17 @@ namespace MFM {
      bit errors are detectable.  Most all triple bit errors are
      detectable as well.
 
-     This class uses a table lookup to accelerate the generation and
-     checking of the parity bits.  In particular, \ref Compute2DParity
-     and \ref Check2DParity are both likely inlined and fast enough to
-     use with impunity virtually anywhere.  In addition, \ref
-     CheckAndCorrect2DParity and \ref Remove2DParityFrom are fast \em
-     if no errors are detected, but note only moderate effort has been
-     made to accelerate \ref Correct2DParityIfPossible, which is the
-     routine that actually performs the error correction to the degree
-     possible.
+     This class uses table lookups to accelerate the generation,
+     checking, and correction of the parity bits.  \ref
+     Compute2DParity and \ref Check2DParity are both likely inlined
+     and fast enough to use with impunity virtually anywhere.  Since
+     which row and column groups fail depends only on the \em
+     syndrome -- the XOR of the stored and recomputed parity -- error
+     correction is a second lookup, indexed by the syndrome, that
+     yields the bit to flip.  So \ref CheckAndCorrect2DParity and \ref
+     Remove2DParity are branch-light and fast whether or not errors
+     are detected, which makes them suitable for sweeping entire
+     site arrays.
    */
   class Parity2D_4x4
   {
@@ -67,7 +69,9 @@ namespace MFM {
       ECC_BITS = W + H + 1,
       TABLE_SIZE = 1 << DATA_BITS,
       INDEX_MASK = TABLE_SIZE - 1,
-      ECC_MASK = (1 << ECC_BITS) - 1
+      ECC_MASK = (1 << ECC_BITS) - 1,
+      REPAIR_TABLE_SIZE = 1 << ECC_BITS,
+      UNREPAIRABLE = 0xff
     };
 
     /**
@@ -167,16 +171,19 @@ namespace MFM {
     static u32 CheckAndCorrect2DParity(const u32 allBits) {
       u32 eccBits = (allBits>>DATA_BITS) & ECC_MASK;
       u32 dataBits = allBits&INDEX_MASK;
-      if (Compute2DParity(dataBits) == eccBits)
+      u32 syndrome = Compute2DParity(dataBits) ^ eccBits;
+      if (syndrome == 0)
         return allBits;
-      return Correct2DParityIfPossible(allBits);
+      u32 bitno = repairTable[syndrome];
+      if (bitno == UNREPAIRABLE)
+        return 0;
+      return allBits ^ (1 << bitno);
     }
 
     /**
-       Attempt to error-correct \a allBits.  \b Note: Usually callers
-       will prefer to call \ref CheckAndCorrect2DParity, because it's
-       fast \em if the parity is correct, while this method is slow in
-       all cases.
+       Attempt to error-correct \a allBits.  Now that correction is
+       table-driven this is identical to \ref
+       CheckAndCorrect2DParity, and is retained for existing callers.
 
        The value returned is equal to \a allBits if the parity checks,
        is 0 if the parity does not check but \a allBits is so damaged
@@ -187,13 +194,29 @@ namespace MFM {
        \sa CheckAndCorrect2DParity
 
      */
-    static u32 Correct2DParityIfPossible(u32 allBits);
+    static u32 Correct2DParityIfPossible(u32 allBits) {
+      return CheckAndCorrect2DParity(allBits);
+    }
+
+    /**
+       Attempt to error-correct \a allBits by checking each row and
+       column group separately.  Same return values as \ref
+       Correct2DParityIfPossible, but slow in all cases; used to
+       generate (and test) the repair table.
+     */
+    static u32 Correct2DParitySlow(u32 allBits);
 
     static const u8 indices2D[H + 1][W + 1];
 
   private:
     static const u16 eccTable[TABLE_SIZE];
     static const u32 masks[H + 1 + W + 1];
+
+    /**
+       For each nonzero syndrome, the bit number in the 25-bit value
+       that must be flipped to correct it, or UNREPAIRABLE.
+     */
+    static const u8 repairTable[REPAIR_TABLE_SIZE];
   };
 } /* namespace MFM */
 
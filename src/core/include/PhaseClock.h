@@ -0,0 +1,146 @@
+/*                                              -*- mode:C++ -*-
+  PhaseClock.h Lock-step phase counter shared by a group of threads
+  Copyright (C) 2014 The Regents of the University of New Mexico.  All rights reserved.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301
+  USA
+*/
+
+/**
+  \file PhaseClock.h Lock-step phase counter shared by a group of threads
+  \author David H. Ackley.
+  \date (C) 2014 All rights reserved.
+  \lgpl
+ */
+#ifndef PHASE_CLOCK_H
+#define PHASE_CLOCK_H
+
+#include "itype.h"
+#include "Atomic.h"
+#include "Mutex.h"
+
+namespace MFM
+{
+  /**
+   * A phase counter that a fixed number of participants advance in
+   * lock step: phase N+1 begins only once every participant has
+   * called Arrive() for phase N.  Participants poll GetPhase()
+   * rather than blocking, so they can keep doing other work (such as
+   * servicing their Connections) while they wait.
+   *
+   * An 'outer' thread meters progress by granting phases; no phase
+   * at or beyond the granted limit is ever begun, and the outer
+   * thread may sleep in WaitForLimit() until the clock reaches it.
+   */
+  class PhaseClock
+  {
+  private:
+
+    /**
+     * The phase currently under way
+     */
+    Atomic<u32> m_phase;
+
+    /**
+     * How many participants have finished the current phase
+     */
+    Atomic<u32> m_arrivals;
+
+    /**
+     * How many arrivals complete a phase
+     */
+    u32 m_participants;
+
+    /**
+     * The first phase that may not begin
+     */
+    Atomic<u32> m_limit;
+
+    /**
+     * The mutex guarding m_limitReached
+     */
+    Mutex m_mutex;
+
+    /**
+     * A Mutex::Predicate that waits for m_phase to reach m_limit
+     */
+    struct LimitIsReached : public Mutex::Predicate
+    {
+      PhaseClock & m_phaseClock;
+      LimitIsReached(PhaseClock & pc) : Predicate(pc.m_mutex), m_phaseClock(pc) { }
+
+      virtual bool EvaluatePredicate()
+      {
+        return m_phaseClock.m_phase.Load() >= m_phaseClock.m_limit.Load();
+      }
+    } m_limitReached;
+
+  public:
+
+    /**
+     * Constructs a new PhaseClock at phase 0, with no participants
+     * and no phases granted.
+     */
+    PhaseClock();
+
+    /**
+     * Returns this clock to phase 0 with no phases granted.  Must
+     * only be called while no participant is running.
+     *
+     * @param participants The number of Arrive() calls that complete
+     *                     each phase.
+     */
+    void Reset(u32 participants);
+
+    /**
+     * Gets the phase currently under way.  The load has acquire
+     * semantics, so once a participant sees a new phase, everything
+     * every participant did in the previous phase is visible to it.
+     */
+    u32 GetPhase() const
+    {
+      return m_phase.Load(MEMORY_ORDER_ACQUIRE);
+    }
+
+    /**
+     * Checks whether \c phase has been granted.
+     */
+    bool MayBegin(u32 phase) const
+    {
+      return phase < m_limit.Load(MEMORY_ORDER_ACQUIRE);
+    }
+
+    /**
+     * To be called by each participant exactly once when it has
+     * finished \c phase, which must be the current phase.  The last
+     * arrival advances the clock.
+     */
+    void Arrive(u32 phase);
+
+    /**
+     * To be called by the outer thread.  Allows \c phases more
+     * phases to begin.
+     */
+    void Grant(u32 phases);
+
+    /**
+     * To be called by the outer thread.  Blocks until every granted
+     * phase has completed.
+     */
+    void WaitForLimit();
+  };
+}
+
+#endif /* PHASE_CLOCK_H */
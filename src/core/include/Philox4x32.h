@@ -0,0 +1,158 @@
+/*                                              -*- mode:C++ -*-
+  Philox4x32.h Counter-based PRNG producing four words per block
+  Copyright (C) 2014 The Regents of the University of New Mexico.  All rights reserved.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301
+  USA
+*/
+
+/**
+  \file Philox4x32.h Counter-based PRNG producing four words per block
+  \author David H. Ackley.
+  \date (C) 2014 All rights reserved.
+  \lgpl
+ */
+#ifndef PHILOX4X32_H
+#define PHILOX4X32_H
+
+#include "itype.h"
+
+namespace MFM
+{
+  /**
+   * The Philox4x32-10 counter-based generator of Salmon et al.,
+   * "Parallel Random Numbers: As Easy as 1, 2, 3" (SC11).  Each
+   * block of four outputs is a keyed bijection of a 128-bit counter,
+   * so the whole state is six words, and any point in any stream can
+   * be reached directly by setting the counter.  Here the key comes
+   * from the seed, the low half of the counter counts blocks, and the
+   * high half selects a stream.
+   */
+  class Philox4x32
+  {
+  public:
+    enum
+    {
+      BLOCK_WORDS = 4,
+      ROUNDS = 10
+    };
+
+    Philox4x32()
+    {
+      SetSeed(0);
+    }
+
+    /**
+     * Keys this generator by \c seed and rewinds it to the start of
+     * stream 0.
+     */
+    void SetSeed(u32 seed)
+    {
+      m_key[0] = seed;
+      m_key[1] = 0;
+      SetStream(0, 0);
+    }
+
+    /**
+     * Rewinds this generator to the start of the stream named by \c
+     * hi and \c lo, under the current key.  Distinct streams do not
+     * overlap until 2^64 blocks have been drawn from one of them.
+     */
+    void SetStream(u32 hi, u32 lo)
+    {
+      m_counter[0] = m_counter[1] = 0;
+      m_counter[2] = lo;
+      m_counter[3] = hi;
+      m_used = BLOCK_WORDS;
+    }
+
+    /**
+     * Gets the next 32 pseudo-random bits.
+     */
+    u32 Next()
+    {
+      if (m_used == BLOCK_WORDS)
+      {
+        Generate(m_block);
+        m_used = 0;
+      }
+      return m_block[m_used++];
+    }
+
+    /**
+     * Stores the next \c count outputs in \c out, producing whole
+     * blocks directly into \c out where possible.
+     */
+    void Fill(u32 * out, u32 count)
+    {
+      while (count > 0 && m_used < BLOCK_WORDS)
+      {
+        *out++ = m_block[m_used++];
+        --count;
+      }
+      for (; count >= BLOCK_WORDS; count -= BLOCK_WORDS, out += BLOCK_WORDS)
+      {
+        Generate(out);
+      }
+      while (count-- > 0)
+      {
+        *out++ = Next();
+      }
+    }
+
+  private:
+    u32 m_key[2];
+    u32 m_counter[4];
+    u32 m_block[BLOCK_WORDS];
+    u32 m_used;
+
+    /**
+     * Writes the block for the current counter to \c out, and
+     * advances the counter.
+     */
+    void Generate(u32 * out)
+    {
+      const u32 M0 = 0xD2511F53, M1 = 0xCD9E8D57;
+      const u32 W0 = 0x9E3779B9, W1 = 0xBB67AE85;
+
+      u32 c0 = m_counter[0], c1 = m_counter[1], c2 = m_counter[2], c3 = m_counter[3];
+      u32 k0 = m_key[0], k1 = m_key[1];
+
+      for (u32 r = 0; r < ROUNDS; ++r)
+      {
+        u64 p0 = ((u64) M0) * c0;
+        u64 p1 = ((u64) M1) * c2;
+        c0 = ((u32) (p1 >> 32)) ^ c1 ^ k0;
+        c1 = (u32) p1;
+        c2 = ((u32) (p0 >> 32)) ^ c3 ^ k1;
+        c3 = (u32) p0;
+        k0 += W0;
+        k1 += W1;
+      }
+
+      out[0] = c0;
+      out[1] = c1;
+      out[2] = c2;
+      out[3] = c3;
+
+      if (++m_counter[0] == 0)
+      {
+        ++m_counter[1];
+      }
+    }
+  };
+}
+
+#endif /* PHILOX4X32_H */
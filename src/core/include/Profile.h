@@ -0,0 +1,177 @@
+/*                                              -*- mode:C++ -*-
+  Profile.h Cheap timestamps and histograms for instrumented builds
+  Copyright (C) 2014 The Regents of the University of New Mexico.  All rights reserved.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301
+  USA
+*/
+
+/**
+  \file Profile.h Cheap timestamps and histograms for instrumented builds
+  \author David H. Ackley.
+  \date (C) 2014 All rights reserved.
+  \lgpl
+ */
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include "itype.h"
+#include "Logger.h"
+#include <time.h>   /* For clock_gettime */
+
+namespace MFM
+{
+  /**
+   * A timestamp source cheap enough to read around every event.  On
+   * x86 this is the time stamp counter, in cycles; elsewhere it is
+   * the monotonic clock, in nanoseconds.  Only differences between
+   * two readings on the same thread mean anything.
+   */
+  class ProfileClock
+  {
+  public:
+    static u64 Now()
+    {
+#if defined(__i386__) || defined(__x86_64__)
+      u32 lo, hi;
+      __asm__ __volatile__ ("rdtsc" : "=a" (lo), "=d" (hi));
+      return (((u64) hi) << 32) | lo;
+#else
+      struct timespec now;
+      clock_gettime(CLOCK_MONOTONIC, &now);
+      return ((u64) now.tv_sec) * 1000000000 + now.tv_nsec;
+#endif
+    }
+
+    /**
+     * Gets the name of the units Now() counts in.
+     */
+    static const char * GetUnits()
+    {
+#if defined(__i386__) || defined(__x86_64__)
+      return "cycles";
+#else
+      return "ns";
+#endif
+    }
+  };
+
+  /**
+   * Counts of values in power-of-two buckets.  Bucket 0 holds zeros,
+   * and bucket b > 0 holds values from 2^(b-1) up to 2^b - 1, except
+   * that the last bucket also holds everything larger.
+   */
+  class Log2Histogram
+  {
+  public:
+    enum { BUCKETS = 32 };
+
+    Log2Histogram()
+    {
+      Clear();
+    }
+
+    void Clear()
+    {
+      for (u32 i = 0; i < BUCKETS; ++i)
+      {
+        m_buckets[i] = 0;
+      }
+      m_total = 0;
+    }
+
+    static u32 BucketOf(u64 value)
+    {
+      u32 bucket = 0;
+      while (value != 0 && bucket < BUCKETS - 1)
+      {
+        value >>= 1;
+        ++bucket;
+      }
+      return bucket;
+    }
+
+    void Add(u64 value)
+    {
+      ++m_buckets[BucketOf(value)];
+      m_total += value;
+    }
+
+    /**
+     * Adds all of \c other's counts into this histogram.
+     */
+    void Add(const Log2Histogram & other)
+    {
+      for (u32 i = 0; i < BUCKETS; ++i)
+      {
+        m_buckets[i] += other.m_buckets[i];
+      }
+      m_total += other.m_total;
+    }
+
+    u64 GetBucket(u32 bucket) const
+    {
+      if (bucket >= BUCKETS)
+      {
+        FAIL(ARRAY_INDEX_OUT_OF_BOUNDS);
+      }
+      return m_buckets[bucket];
+    }
+
+    u64 GetCount() const
+    {
+      u64 count = 0;
+      for (u32 i = 0; i < BUCKETS; ++i)
+      {
+        count += m_buckets[i];
+      }
+      return count;
+    }
+
+    /**
+     * Gets the sum of all values added, so GetTotal() / GetCount() is
+     * their mean.
+     */
+    u64 GetTotal() const
+    {
+      return m_total;
+    }
+
+    /**
+     * Gets an upper bound on the value below which \c percent of the
+     * values added fall, or 0 if none have been added.  If that value
+     * is in the last bucket, which has no upper bound, returns
+     * UNBOUNDED.
+     */
+    u64 GetPercentile(u32 percent) const;
+
+    /**
+     * What GetPercentile returns for values in the last bucket
+     */
+    static const u64 UNBOUNDED = ~((u64) 0);
+
+    /**
+     * Logs the count, mean, median, 99th percentile and nonzero
+     * buckets of this histogram, on one line headed by \c label .
+     */
+    void Report(Logger::Level level, const char * label) const;
+
+  private:
+    u64 m_buckets[BUCKETS];
+    u64 m_total;
+  };
+}
+
+#endif /* PROFILE_H */
@@ -1,5 +1,5 @@
 /*                                              -*- mode:C++ -*-
-  Random.h PRNG interface for the Mersenne Twister
+  Random.h PRNG interface over selectable generators
   Copyright (C) 2014 The Regents of the University of New Mexico.  All rights reserved.
 
   This library is free software; you can redistribute it and/or
@@ -19,7 +19,7 @@
 */
 
 /**
-  \file Random.h PRNG interface for the Mersenne Twister
+  \file Random.h PRNG interface over selectable generators
   \author David H. Ackley.
   \author Trent R. Small.
   \date (C) 2014 All rights reserved.
@@ -32,12 +32,34 @@
 
 #include "itype.h"
 #include "RandMT.h"
+#include "Philox4x32.h"
 #include "BitVector.h"
 #include "FXP.h"
 #include "Fail.h"
 
 namespace MFM
 {
+  /**
+   * The generators a Random can draw from.
+   */
+  enum RandomBackend
+  {
+    /**
+     * The Mersenne Twister MT19937.  The default, and the only
+     * backend whose bounded draws match those of earlier versions,
+     * so existing seeds replay identically.
+     */
+    RANDOM_BACKEND_MT,
+
+    /**
+     * The Philox4x32-10 counter-based generator.  Small state, cheap
+     * batch generation, Lemire-style bounded draws, and addressable
+     * streams via Random::SetStream.
+     */
+    RANDOM_BACKEND_PHILOX,
+
+    RANDOM_BACKEND_COUNT
+  };
 
   /**
    * An interface for easy PRNG interaction.
@@ -49,14 +71,18 @@ namespace MFM
     /**
      * Creates a new Random instance that is ready to be used.
      */
-    Random()
+    Random() :
+      _backend(RANDOM_BACKEND_MT),
+      _geometricOdds(0)
     { }
 
     /**
      * Creates a new Random instance, initialized using a specified
      * seed.
      */
-    Random(u32 seed)
+    Random(u32 seed) :
+      _backend(RANDOM_BACKEND_MT),
+      _geometricOdds(0)
     {
       SetSeed(seed);
     }
@@ -78,6 +104,22 @@ namespace MFM
      */
     u32 Create(u32 max) ;
 
+    /**
+     * Stores \c count pseudo-random 32-bit words in \c out.  The
+     * same words as \c count calls to Create(), but cheaper per word
+     * when the backend generates in blocks.
+     */
+    void Fill(u32 * out, u32 count) ;
+
+    /**
+     * Stores \c count uniform pseudo-random numbers from 0..max-1 in
+     * \c out.  With RANDOM_BACKEND_MT these are exactly the numbers
+     * \c count calls to Create(max) would give; other backends map a
+     * whole block of draws at once, so they agree with Create(max)
+     * only in distribution.  FAILs ILLEGAL_ARGUMENT if max==0.
+     */
+    void Fill(u32 * out, u32 count, u32 max) ;
+
     /**
      * Generates a pseudo-random boolean value.
      *
@@ -104,6 +146,20 @@ namespace MFM
      */
     bool OddsOf(u32 thisMany, u32 outOfThisMany) ;
 
+    /**
+     * Return how many consecutive calls to OneIn(odds) would return
+     * false before one returned true -- that is, a geometrically
+     * distributed count of failures before the first success --
+     * using a single draw from the PRNG.  Loops that would otherwise
+     * call OneIn(odds) once per item can instead skip ahead by this
+     * much, so their PRNG usage scales with the number of successes
+     * rather than the number of items.  When odds == 1, always
+     * returns 0.  The result saturates at S32_MAX, so adding it to a
+     * small index cannot overflow.  FAILs ILLEGAL_ARGUMENT if odds
+     * is 0.
+     */
+    u32 CreateGeometric(u32 odds) ;
+
     /**
      * Return true pseudo-randomly, with fixed point bounds.  E.g.,
      * oddsOf(FXP16(0.6),FXP16(2)) returns true on 30% of calls.
@@ -147,11 +203,73 @@ namespace MFM
     void SetSeed(u32 seed)
     {
       _generator.seedMT_MFM(seed);
+      _philox.SetSeed(seed);
+    }
+
+    /**
+     * Selects the generator that subsequent draws come from.  Both
+     * generators are seeded by SetSeed, so this may be called before
+     * or after seeding.
+     */
+    void SetBackend(RandomBackend backend)
+    {
+      if (backend >= RANDOM_BACKEND_COUNT)
+      {
+        FAIL(ILLEGAL_ARGUMENT);
+      }
+      _backend = backend;
+    }
+
+    RandomBackend GetBackend() const
+    {
+      return _backend;
+    }
+
+    /**
+     * Restarts the RANDOM_BACKEND_PHILOX generator at the beginning
+     * of the stream named by \c hi and \c lo, under the current
+     * seed.  The draws that follow depend only on the seed and the
+     * stream name, so, for example, naming a stream after an event
+     * number makes that event's draws reproducible in isolation.
+     * FAILs ILLEGAL_STATE for other backends.
+     */
+    void SetStream(u32 hi, u32 lo)
+    {
+      if (_backend != RANDOM_BACKEND_PHILOX)
+      {
+        FAIL(ILLEGAL_STATE);
+      }
+      _philox.SetStream(hi, lo);
     }
 
   private:
     RandMT _generator;
 
+    Philox4x32 _philox;
+
+    RandomBackend _backend;
+
+    /**
+     * Lemire's multiply-shift mapping of a draw onto 0..max-1,
+     * rejecting the few draws that would bias it.
+     */
+    u32 CreateLemire(u32 max, u32 draw) ;
+
+    /**
+     * The odds most recently given to CreateGeometric, or 0
+     */
+    u32 _geometricOdds;
+
+    /**
+     * -log2(1 - 1/_geometricOdds), in 32.32 fixed point
+     */
+    u64 _geometricScale;
+
+    /**
+     * Computes log2(x) for x >= 1, in 32.32 fixed point.
+     */
+    static u64 Log2Fixed(u64 x) ;
+
   };
 
   /******************************************************************************
@@ -160,16 +278,39 @@ namespace MFM
 
   inline u32 Random::Create()
   {
+    if (_backend == RANDOM_BACKEND_PHILOX)
+    {
+      return _philox.Next();
+    }
     return _generator.randomMT();
   }
 
-  // Avoid modulus artifacts by sampling from round powers of 2 and rejecting
+  inline u32 Random::CreateLemire(const u32 maxval, u32 draw)
+  {
+    u64 product = ((u64) draw) * maxval;
+    if ((u32) product < maxval)
+    {
+      const u32 threshold = (0u - maxval) % maxval;
+      while ((u32) product < threshold)
+      {
+        product = ((u64) Create()) * maxval;
+      }
+    }
+    return (u32) (product >> 32);
+  }
+
+  // Avoid modulus artifacts by sampling from round powers of 2 and
+  // rejecting, or by Lemire's method for newer backends
   inline u32 Random::Create(const u32 maxval)
   {
     if (maxval==0)
     {
       FAIL(ILLEGAL_ARGUMENT);
     }
+    if (_backend != RANDOM_BACKEND_MT)
+    {
+      return CreateLemire(maxval, Create());
+    }
     int bitmask = _getNextPowerOf2(maxval)-1;
     u32 ret;
     do
@@ -0,0 +1,118 @@
+/*                                              -*- mode:C++ -*-
+  SeqLock.h Sequence lock for data with one writer and many readers
+  Copyright (C) 2014 The Regents of the University of New Mexico.  All rights reserved.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301
+  USA
+*/
+
+/**
+  \file SeqLock.h Sequence lock for data with one writer and many readers
+  \author David H. Ackley.
+  \date (C) 2014 All rights reserved.
+  \lgpl
+ */
+#ifndef SEQLOCK_H
+#define SEQLOCK_H
+
+#include "itype.h"
+#include "Atomic.h"
+
+namespace MFM
+{
+  /**
+   * A sequence lock, guarding data that one thread at a time updates
+   * and any number of threads read, without readers ever blocking
+   * the writer.  The writer brackets each update with BeginWrite()
+   * and EndWrite(), which make the sequence number odd for the
+   * duration.  Readers copy what they need between BeginRead() and
+   * ShouldRetryRead(), and start over if a write overlapped the copy:
+   *
+   * \code
+   * u32 seq;
+   * do
+   * {
+   *   seq = lock.BeginRead();
+   *   copy = guarded;
+   * } while (lock.ShouldRetryRead(seq));
+   * \endcode
+   *
+   * Readers must only copy the guarded data inside the loop, never
+   * act on it, since it may be torn until ShouldRetryRead() says
+   * otherwise.
+   */
+  class SeqLock
+  {
+  private:
+    Atomic<u32> m_sequence;
+
+    SeqLock(const SeqLock &);
+    SeqLock & operator=(const SeqLock &);
+
+  public:
+    SeqLock() : m_sequence(0)
+    { }
+
+    /**
+     * To be called by the writer before changing the guarded data.
+     */
+    void BeginWrite()
+    {
+      m_sequence.FetchAdd(1, MEMORY_ORDER_RELAXED);
+
+      // Keep the data stores from moving ahead of the odd sequence
+      AtomicThreadFence(MEMORY_ORDER_RELEASE);
+    }
+
+    /**
+     * To be called by the writer after changing the guarded data.
+     */
+    void EndWrite()
+    {
+      m_sequence.FetchAdd(1, MEMORY_ORDER_RELEASE);
+    }
+
+    /**
+     * To be called by a reader before copying the guarded data.
+     * Waits out any write in progress.
+     *
+     * @returns the sequence number to pass to ShouldRetryRead().
+     */
+    u32 BeginRead() const
+    {
+      u32 seq;
+      while ((seq = m_sequence.Load(MEMORY_ORDER_ACQUIRE)) & 1)
+      {
+        // Writer busy; its updates are short
+      }
+      return seq;
+    }
+
+    /**
+     * To be called by a reader after copying the guarded data.
+     *
+     * @returns \c true if a write may have overlapped the copy, so
+     *          it must be redone.
+     */
+    bool ShouldRetryRead(u32 seq) const
+    {
+      // Keep the data loads from moving past the sequence check
+      AtomicThreadFence(MEMORY_ORDER_ACQUIRE);
+      return m_sequence.Load(MEMORY_ORDER_RELAXED) != seq;
+    }
+  };
+}
+
+#endif /* SEQLOCK_H */
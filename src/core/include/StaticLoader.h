@@ -59,11 +59,38 @@ namespace MFM
     static u32 m_counter;
     static const u32 SLOTS = 1<<BITS;
     static const UUID *(m_uuids[SLOTS]);
+
+    /**
+     * One more than the dense ordinal of each assigned type, or 0 for
+     * unassigned types.  Ordinals are handed out 0, 1, 2.. in
+     * allocation order, so they are small enough to index per-Tile
+     * tables directly even though the types themselves are spread
+     * across all BITS.
+     */
+    static u16 m_ordinals[SLOTS];
+    static u32 m_ordinalsUsed;
+
     static u32 NextType() ;
 
   public:
+    /**
+     * The value OrdinalOfType returns for types never assigned.
+     */
+    static const u32 NO_ORDINAL = 0xffffffff;
+
     static u32 AllocateType(const UUID & forUUID) ;
 
+    /**
+     * Return the dense ordinal of \a type -- 0 for the first type
+     * allocated, 1 for the next, and so on -- or NO_ORDINAL if \a
+     * type has not been assigned.  O(1); suitable for inner loops.
+     */
+    static u32 OrdinalOfType(u32 type) {
+      if (type >= SLOTS)
+        return NO_ORDINAL;
+      return ((u32) m_ordinals[type]) - 1;
+    }
+
     /**
      * Return the type assigned to \a forUUID, or -1 if the UUID is
      * not found.  Note this is O(#types)!  Not for inner loop use!
@@ -8,6 +8,12 @@ namespace MFM {
   template <class CC, u32 BITS>
   const UUID *(StaticLoader<CC,BITS>::m_uuids[SLOTS]);
 
+  template <class CC, u32 BITS>
+  u16 StaticLoader<CC,BITS>::m_ordinals[SLOTS];
+
+  template <class CC, u32 BITS>
+  u32 StaticLoader<CC,BITS>::m_ordinalsUsed = 0;
+
   template <class CC, u32 BITS>
   u32 StaticLoader<CC,BITS>::NextType() {
     u32 type;
@@ -49,6 +55,7 @@ namespace MFM {
 
     u32 type = NextType();
     m_uuids[type] = &forUUID;
+    m_ordinals[type] = (u16) ++m_ordinalsUsed;
     return type;
   }
 
@@ -0,0 +1,130 @@
+/*                                              -*- mode:C++ -*-
+  ThreadBarrier.h Structure allowing a thread to await many others
+  Copyright (C) 2014 The Regents of the University of New Mexico.  All rights reserved.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301
+  USA
+*/
+
+/**
+  \file ThreadBarrier.h Structure allowing a thread to await many others
+  \author David H. Ackley.
+  \date (C) 2014 All rights reserved.
+  \lgpl
+ */
+#ifndef THREAD_BARRIER_H
+#define THREAD_BARRIER_H
+
+#include "itype.h"
+#include "Mutex.h"
+
+namespace MFM
+{
+  /**
+   * A generation-counted barrier on which one 'outer' thread waits
+   * until a known number of 'inner' threads have each arrived once.
+   * The outer thread opens each generation with Begin(), which must
+   * happen before it asks any inner thread to arrive; it then
+   * blocks in Wait() until the last arrival wakes it.
+   */
+  class ThreadBarrier
+  {
+  private:
+
+    /**
+     * The mutex gating all access to the barrier state
+     */
+    Mutex m_mutex;
+
+    /**
+     * The generation most recently opened by Begin()
+     */
+    u32 m_generation;
+
+    /**
+     * The most recent generation in which everyone arrived
+     */
+    u32 m_completedGeneration;
+
+    /**
+     * How many arrivals complete the current generation
+     */
+    u32 m_expected;
+
+    /**
+     * How many arrivals the current generation has had so far
+     */
+    u32 m_arrived;
+
+    /**
+     * A Mutex::Predicate that waits for the current generation to
+     * complete
+     */
+    struct GenerationIsComplete : public Mutex::Predicate
+    {
+      ThreadBarrier & m_threadBarrier;
+      GenerationIsComplete(ThreadBarrier & tb) : Predicate(tb.m_mutex), m_threadBarrier(tb) { }
+
+      virtual bool EvaluatePredicate()
+      {
+        return m_threadBarrier.m_completedGeneration == m_threadBarrier.m_generation;
+      }
+    } m_generationIsComplete;
+
+  public:
+
+    /**
+     * Constructs a new ThreadBarrier with no generation open.
+     */
+    ThreadBarrier();
+
+    /**
+     * Destroys this ThreadBarrier.
+     */
+    ~ThreadBarrier();
+
+    /**
+     * To be called by the outer thread.  Opens a new generation that
+     * will complete after \c expected calls to Arrive().  FAILs with
+     * ILLEGAL_STATE if the previous generation never completed.
+     *
+     * @returns the new generation number, to be passed to Wait().
+     */
+    u32 Begin(u32 expected);
+
+    /**
+     * To be called by an inner thread, once per generation.  The last
+     * arrival wakes the outer thread.  FAILs with ILLEGAL_STATE if
+     * everyone has already arrived.
+     */
+    void Arrive();
+
+    /**
+     * To be called by the outer thread.  Blocks until \c generation
+     * completes, or until \c timeoutMillis have passed.
+     *
+     * @returns true if \c generation completed, false on timeout.
+     */
+    bool Wait(u32 generation, u32 timeoutMillis);
+
+    /**
+     * Gets how many inner threads have arrived in the current
+     * generation.  For diagnostics only.
+     */
+    u32 GetArrivals();
+  };
+}
+
+#endif /* THREAD_BARRIER_H */
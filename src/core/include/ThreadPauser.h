@@ -28,6 +28,8 @@
 #define THREAD_PAUSER_H
 
 #include "Mutex.h"
+#include "Atomic.h"
+#include "ThreadBarrier.h"
 #include "Logger.h"
 
 namespace MFM
@@ -142,14 +144,42 @@ namespace MFM
    private:
 
     /**
-     * The mutex gating all access to the ThreadPauser state
+     * The mutex gating all changes to the ThreadPauser state, and
+     * all waiting for it to change
      */
     Mutex m_mutex;
 
     /**
-     * The ThreadPauser current state
+     * The ThreadPauser current state, held as a u32 ThreadState.  It
+     * is only stored while m_mutex is held, but may be loaded at any
+     * time, so the inner thread can see that it is still running
+     * without touching m_mutex.
      */
-    ThreadState m_threadState;
+    Atomic<u32> m_threadState;
+
+    /**
+     * If non-NULL, the ThreadBarrier to Arrive() at whenever the
+     * inner thread advances to THREADSTATE_PAUSE_READY or
+     * THREADSTATE_RUN_READY, so the outer thread need not poll.
+     */
+    ThreadBarrier * m_barrier;
+
+    /**
+     * Reads m_threadState.
+     */
+    ThreadState LoadState(MemoryOrder order) const
+    {
+      return (ThreadState) m_threadState.Load(order);
+    }
+
+    /**
+     * Changes m_threadState.  m_mutex must be held.
+     */
+    void StoreState(ThreadState state)
+    {
+      m_mutex.AssertIHoldTheLock();
+      m_threadState.Store((u32) state, MEMORY_ORDER_RELEASE);
+    }
 
     /**
      * A Mutex::Predicate that waits for THREADSTATE_RUN_REQUESTED
@@ -161,12 +191,15 @@ namespace MFM
 
       virtual bool EvaluatePredicate()
       {
-        return m_threadPauser.m_threadState == THREADSTATE_RUN_REQUESTED;
+        return m_threadPauser.LoadState(MEMORY_ORDER_RELAXED) == THREADSTATE_RUN_REQUESTED;
       }
     } m_stateIsRunRequested;
 
     /**
-     * A Mutex::Predicate that waits for THREADSTATE_RUNNING
+     * A Mutex::Predicate that waits for THREADSTATE_RUNNING, or for
+     * anything after it: the outer thread may request a pause before
+     * the inner thread wakes up, and would then wait forever for an
+     * inner thread still waiting for THREADSTATE_RUNNING.
      */
     struct StateIsRunning : public Mutex::Predicate
     {
@@ -175,14 +208,30 @@ namespace MFM
 
       virtual bool EvaluatePredicate()
       {
-        return m_threadPauser.m_threadState == THREADSTATE_RUNNING;
+        return m_threadPauser.LoadState(MEMORY_ORDER_RELAXED) != THREADSTATE_RUN_READY;
       }
     } m_stateIsRunning;
 
   public:
 
+    /**
+     * To be called by the inner thread on every iteration of its
+     * loop.  Blocks while paused or waiting to run.
+     *
+     * While running, and no pause has been requested, this is a
+     * single relaxed load: the inner thread can only have reached
+     * THREADSTATE_RUNNING via m_mutex, which already ordered
+     * everything the outer thread did before letting it run, and a
+     * pause request seen late just means one more event.  Every
+     * other state goes through m_mutex.
+     */
     ThreadState GetStateBlockingInner()
     {
+      ThreadState state = LoadState(MEMORY_ORDER_RELAXED);
+      if (state == THREADSTATE_RUNNING)
+      {
+        return state;
+      }
       return GetAdvanceStateInner(false);
     }
 
@@ -193,7 +242,15 @@ namespace MFM
 
     ThreadState GetAdvanceStateInner(bool innerReadyToAdvance) ;
 
-    ThreadState GetStateNonblocking() ;
+    /**
+     * Gets the current state without blocking or taking m_mutex.
+     * The load has acquire semantics, so whatever the thread that
+     * last changed the state did beforehand is visible to the caller.
+     */
+    ThreadState GetStateNonblocking() const
+    {
+      return LoadState(MEMORY_ORDER_ACQUIRE);
+    }
 
     /**
      * Given the ThreadPauser is currently in state fromState, advance
@@ -211,6 +268,17 @@ namespace MFM
      */
     ThreadPauser();
 
+    /**
+     * Sets the ThreadBarrier that the inner thread arrives at each
+     * time it becomes ready to pause or to run, or NULL for none.
+     * Must only be called while the inner thread is paused.
+     */
+    void SetBarrier(ThreadBarrier * barrier)
+    {
+      Mutex::ScopeLock lock(m_mutex);  // Hold the lock during this block
+      m_barrier = barrier;
+    }
+
     /**
      * Destroys this ThreadPauser.
      */
@@ -28,31 +28,32 @@
 #define QUE_H
 
 #include "itype.h"
+#include "Atomic.h"
 #include <pthread.h>
 
-#define THREADQUEUE_MAX_BYTES (1536 + 1)  // non-multiple of 16 for testing
+#define THREADQUEUE_MAX_BYTES 8192  // Must be a power of two
+
+#define THREADQUEUE_CACHE_LINE_BYTES 64
 
 namespace MFM
 {
   /**
-   * A thread-safe queue implementation, backed by a byte buffer of
-   * fixed length.
+   * A single-producer, single-consumer queue, backed by a byte buffer
+   * of fixed length.  Exactly one thread may Write to a ThreadQueue,
+   * and exactly one (other) thread may Read from it; under that
+   * restriction no locks are taken on the Write or Read paths.  The
+   * mutex and condition variable are used only by ReadBlocking, when
+   * the reader actually has to sleep.
    */
   class ThreadQueue
   {
   private:
 
     /**
-     * The pthread_mutex_t required to lock this ThreadQueue upon
-     * reading and writing.
-     */
-    pthread_mutex_t m_lock;
-
-    /**
-     * The pthread_cond_t required to wake a waiting thread during an
-     * IO conflict.
+     * Mask converting a free-running head counter into an index
+     * within m_queueData.
      */
-    pthread_cond_t m_cond;
+    enum { INDEX_MASK = THREADQUEUE_MAX_BYTES - 1 };
 
     /**
      * The actual data held within this ThreadQueue.
@@ -60,38 +61,71 @@ namespace MFM
     u8 m_queueData[THREADQUEUE_MAX_BYTES];
 
     /**
-     * The location within m_queueData which the next byte received
-     * through Write() will be written to.
+     * The free-running count of bytes ever published by Write().
+     * Written only by the producer.  The byte at which the next
+     * Write will begin is m_queueData[m_writeHead & INDEX_MASK].
+     * Starts the producer's cache line, so the consumer's indices
+     * are never on it.
      *
      * @sa Write
      */
-    u32 m_writeHead;
+    Atomic<u32> m_writeHead __attribute__((aligned(THREADQUEUE_CACHE_LINE_BYTES)));
+
+    /**
+     * The producer's most recently observed value of m_readHead,
+     * used to avoid touching the consumer's cache line on every
+     * Write.
+     */
+    u32 m_producerReadHead;
 
     /**
-     * The location within m_queueData which the next byte asked for
-     * by Read() will be read from.
+     * The free-running count of bytes ever consumed by Read().
+     * Written only by the consumer.  The next byte asked for by
+     * Read() is m_queueData[m_readHead & INDEX_MASK].  Starts the
+     * consumer's cache line.
      *
      * @sa Read
      */
-    u32 m_readHead;
+    Atomic<u32> m_readHead __attribute__((aligned(THREADQUEUE_CACHE_LINE_BYTES)));
 
     /**
-     * The number of bytes currently available to be read from
-     * m_queueData.
+     * The consumer's most recently observed value of m_writeHead,
+     * used to avoid touching the producer's cache line on every
+     * Read.
      */
-    u32 m_heldBytes;
+    u32 m_consumerWriteHead;
 
     /**
-     * Reads a specified number of bytes from this ThreadQueue into a
+     * Nonzero while the consumer is (about to be) asleep in
+     * ReadBlocking, so the producer knows it must signal m_cond.
+     * Off the consumer's line, since both sides write it.
+     */
+    Atomic<u32> m_readerWaiting __attribute__((aligned(THREADQUEUE_CACHE_LINE_BYTES)));
+
+    /**
+     * The pthread_mutex_t protecting m_cond.  It is never taken on
+     * the non-blocking paths.
+     */
+    pthread_mutex_t m_lock;
+
+    /**
+     * The pthread_cond_t on which a reader in ReadBlocking waits for
+     * more bytes.
+     */
+    pthread_cond_t m_cond;
+
+    /**
+     * Copies \a length bytes out of the ring, starting at free-running
+     * position \a from, into \a toBuffer, in at most two memcpys.
+     */
+    void CopyOut(u8* toBuffer, u32 from, u32 length) const;
+
+    /**
+     * Reads up to \a length bytes from this ThreadQueue into a
      * specified buffer. These bytes are taken directly from the front
      * of the underlying queue. This does not block, and instead reads
      * as many bytes as possible from the underlying queue, up to the
-     * specified limit, before returning.
-     *
-     * ****************NOTICE*******************
-     * This function ignores the mutex and is meant to be for internal
-     * use only!
-     * *****************NOTICE*******************
+     * specified limit, before returning.  Consumer only.
      *
      * @param bytes The buffer to read bytes into. This buffer will be
      *              overwritten during this call.
@@ -99,8 +133,17 @@ namespace MFM
      * @param length The number of bytes to read from the front of the
      *               underlying queue.
      *
+     * @returns The number of bytes actually read.
+     */
+    u32 ReadAvailable(u8* bytes, u32 length);
+
+    /**
+     * Sleeps the consumer until at least one byte is available.
      */
-    u32 UnsafeRead(u8* bytes, u32 length);
+    void WaitForBytes();
+
+    // Declare away copy ctor; pthread objects can't be copied
+    ThreadQueue(const ThreadQueue &);
 
   public:
 
@@ -117,8 +160,10 @@ namespace MFM
 
     /**
      * Writes a specified number of bytes to this ThreadQueue from a
-     * specified buffer. If writing is not available, this thread
-     * waits until it is.
+     * specified buffer.  The bytes become visible to the reader all
+     * at once, so a multi-record packet written in a single call is
+     * never seen partially.  FAILs with OUT_OF_RESOURCES if the bytes
+     * do not fit.  Producer only.
      *
      * @param bytes The buffer where bytes will be taken from during
      *              writing.
@@ -133,7 +178,7 @@ namespace MFM
      * Reads a specified number of bytes from this ThreadQueue into a
      * specified buffer. These bytes are taken directly from the front
      * of the underlying queue. This blocks the calling thread until
-     * all bytes have been read.
+     * all bytes have been read.  Consumer only.
      *
      * @param bytes The buffer to read bytes into. This buffer will be
      *              overrwritten during this call.
@@ -145,10 +190,10 @@ namespace MFM
 
     /**
      * Reads a specified number of bytes from this ThreadQueue into a
-     * specified buffer. These bytes are taken directly from the front
-     * of the underlying queue. This does not block, and instead reads
-     * as many bytes as possible from the underlying queue, up to the
-     * specified limit, before returning.
+     * specified buffer, if that many bytes are available. These bytes
+     * are taken directly from the front of the underlying queue. This
+     * does not block; if fewer than \a length bytes are held, nothing
+     * is read.  Consumer only.
      *
      * @param bytes The buffer to read bytes into. This buffer will be
      *              overrwritten during this call.
@@ -156,14 +201,16 @@ namespace MFM
      * @param length The number of bytes to read from the front of the
      *               underlying queue.
      *
-     * @returns The number of bytes read successfully from this call.
+     * @returns The number of bytes read successfully from this call,
+     *          which is either 0 or \a length .
      */
     u32 Read(u8* bytes, u32 length);
 
     /**
-     * Writes a series of held bytes to a specified buffer. This FAILs
-     * with ARRAY_INDEX_OUT_OF_BOUNDS if reading will go over the
-     * bounds of this ThreadQueue .
+     * Writes a series of held bytes to a specified buffer, without
+     * consuming them. This FAILs with ARRAY_INDEX_OUT_OF_BOUNDS if
+     * reading will go over the bounds of this ThreadQueue .  Must
+     * not race with the consumer.
      *
      * @param toBuffer The buffer to read bytes from this ThreadQueue
      *                 into.
@@ -184,11 +231,11 @@ namespace MFM
     u32 BytesAvailable() ;
 
     /**
-     * Erases all held data within this TheadQueue. This should only
+     * Discards all held data within this TheadQueue. This should only
      * be called in erronous cases where the ThreadQueue should no
-     * longer need to hold any data inside. This should NEVER be used
-     * in tandem with a call to ReadBlocking; this will create a
-     * deadlock.
+     * longer need to hold any data inside, and only from the
+     * consumer's side.  This should NEVER be used in tandem with a
+     * call to ReadBlocking; this will create a deadlock.
      */
     void Flush();
 
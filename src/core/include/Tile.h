@@ -33,10 +33,14 @@
 #include "Random.h"  /* for Random */
 #include "Packet.h"
 #include "Point.h"
+#include "Rect.h"
 #include "EventWindow.h"
 #include "ElementTable.h"
 #include "Connection.h"
 #include "ThreadPauser.h"
+#include "PhaseClock.h"
+#include "SeqLock.h"
+#include "Profile.h"
 #include "OverflowableCharBufferByteSink.h"  /* for OString16 */
 
 namespace MFM
@@ -46,6 +50,28 @@ namespace MFM
 #define BACKGROUND_RADIATION_SITE_ODDS 1000
 #define BACKGROUND_RADIATION_BIT_ODDS 100
 
+  /**
+   * The ways a Tile may decide when to execute its events.
+   *
+   * @sa Tile::SetEventSchedule
+   */
+  enum EventSchedule
+  {
+    /** Events at random sites, each locking whatever Connections it
+        needs, whenever it can get them.  The default. */
+    SCHEDULE_LOCKING,
+
+    /** Reproducible lock-step rounds, independent of thread timing */
+    SCHEDULE_DETERMINISTIC,
+
+    /** Checkerboard phases, in which boundary events need no locks */
+    SCHEDULE_CHECKERBOARD,
+
+    /** Like SCHEDULE_LOCKING, but events needing no locks are drawn
+        in batches and executed grouped by element type */
+    SCHEDULE_BATCHED
+  };
+
   /**
    * An enumeration of the kinds of memory regions which may exist in
    * a Tile.
@@ -84,6 +110,7 @@ namespace MFM
     enum { R = P::EVENT_WINDOW_RADIUS };
     enum { W = P::TILE_WIDTH };
     enum { B = P::ELEMENT_TABLE_BITS };
+    enum { EVENT_LOGS_PER_SECOND = 20 };
 
   public:
 
@@ -108,6 +135,125 @@ namespace MFM
      */
     static const u32 OWNED_SIDE = TILE_WIDTH-2*R;
 
+    /**
+     * The maximum number of events whose PACKET_EVENT_COMPLETE may
+     * be awaiting acknowledgment on any one Connection.  While any
+     * are outstanding, this Tile keeps that Connection locked but
+     * goes on executing other events.
+     */
+    static const u32 EVENT_ACK_WINDOW = 4;
+
+    /**
+     * The number of colors in the checkerboard used by the phased
+     * EventSchedules.  No two neighboring Tiles share a color.
+     */
+    static const u32 CHECKERBOARD_COLORS = 4;
+
+    /**
+     * In deterministic mode, the number of phases in one round: an
+     * interior phase, in which every Tile executes its events that
+     * need no locks, and then one boundary phase per checkerboard
+     * color, in which only Tiles of that color execute their events
+     * that do.
+     *
+     * @sa SetEventSchedule
+     */
+    static const u32 DETERMINISTIC_PHASES_PER_ROUND = 1 + CHECKERBOARD_COLORS;
+
+    /**
+     * In deterministic mode, the number of sites each Tile draws per
+     * round, so that a round is one AEPS.
+     */
+    static const u32 DETERMINISTIC_EVENTS_PER_ROUND = OWNED_SIDE * OWNED_SIDE;
+
+    /**
+     * In batched mode, the number of sites drawn per batch.  Enough
+     * that each of the few element types typically present forms a
+     * run of several events, while the insertion sort by type stays
+     * cheap.
+     *
+     * @sa SetEventSchedule
+     */
+    static const u32 BATCHED_EVENTS = 64;
+
+    /**
+     * How many events a running Tile executes between publications
+     * of its Stats.  Must be a power of two.
+     */
+    static const u32 STATS_PUBLISH_EVENTS = 1024;
+
+    /**
+     * A copy of the statistics a Tile keeps as it runs, published for
+     * other threads to read while it goes on running.
+     *
+     * @sa PublishStats
+     * @sa GetStats
+     */
+    struct Stats
+    {
+      u64 m_eventsExecuted;
+      u32 m_eventsFailed;
+      u32 m_failuresErased;
+      u64 m_regionEvents[REGION_COUNT];
+      u64 m_lockEvents[LOCKTYPE_COUNT];
+      u64 m_lockAttempts;
+      u64 m_lockAttemptsSucceeded;
+      u64 m_siteEvents[OWNED_SIDE][OWNED_SIDE];
+      s32 m_atomCount[ELEMENT_TABLE_SIZE];
+      s32 m_illegalAtomCount;
+      u64 m_elementData[P::ELEMENT_DATA_SLOTS];
+    };
+
+    /**
+     * Where a Tile's time goes and what it waits on, as recorded in
+     * builds with MFM_INSTRUMENT defined (make INSTRUMENT=1).  Times
+     * are in ProfileClock units.  Other builds record nothing, and
+     * pay nothing for it.
+     *
+     * @sa GetProfile
+     */
+    struct Profile
+    {
+      /** TryLock failures because the neighbor held the Connection,
+          by Dir */
+      u64 m_lockBusy[Dirs::DIR_COUNT];
+
+      /** TryLock failures because EVENT_ACK_WINDOW of our events on
+          the Connection still awaited acknowledgment, by Dir */
+      u64 m_lockWindowFull[Dirs::DIR_COUNT];
+
+      /** The most bytes FlushAndWaitOnAllBuffers has found waiting to
+          be read on each Connection, by Dir */
+      u32 m_inputHighWater[Dirs::DIR_COUNT];
+
+      /** The most events ever awaiting acknowledgment at once */
+      u32 m_pendingEventsHighWater;
+
+      /** Time spent in each call of FlushAndWaitOnAllBuffers */
+      Log2Histogram m_flushWait;
+
+      /** Time per event, from executing its center atom to sending
+          its updates, by the region of its center */
+      Log2Histogram m_regionEventTime[REGION_COUNT];
+
+      /** The same times by the element table index of the type of
+          the center atom */
+      Log2Histogram m_elementEventTime[ELEMENT_TABLE_SIZE];
+
+      Profile()
+      {
+        Clear();
+      }
+
+      void Clear();
+
+      /**
+       * Adds \c other into this Profile: counts and histograms sum,
+       * and high-water marks take the larger.
+       */
+      void Add(const Profile & other);
+    };
+
   private:
     /**
      * A brief name or label for this Tile, for reporting and debugging
@@ -123,6 +269,13 @@ namespace MFM
      */
     bool m_backgroundRadiationEnabled;
 
+    /**
+     * One more than the number of PlaceAtom writes to let pass before the
+     * next one is struck by background radiation, or 0 if that
+     * distance has yet to be drawn.
+     */
+    u32 m_writesUntilRadiation;
+
 #if 0
     /** The 1-in-this odds of bit corruptions during atom writing.  (0
         means no corruptions).  (NOT YET IMPLEMENTED)  */
@@ -136,6 +289,12 @@ namespace MFM
     /** The PRNG used for generating all random numbers in this Tile. */
     Random m_random;
 
+    /** The PRNG used only to jitter waiting in
+        FlushAndWaitOnAllBuffers.  It is kept apart from m_random so
+        that how long this Tile happens to wait cannot change its
+        events. */
+    Random m_backoffRandom;
+
     /** The number of events executed in this Tile since
         initialization. */
     u64 m_eventsExecuted;
@@ -166,6 +325,13 @@ namespace MFM
     u64 m_lockAttempts;
     u64 m_lockAttemptsSucceeded;
 
+    /**
+     * Limits the debug messages this Tile's thread may log per event
+     * or per packet, such as for failed events and insane atoms,
+     * which can otherwise swamp the log.
+     */
+    LogRateLimiter m_eventLog;
+
     /**
      * The number of events which have occurred in every individual
      * site. Indexed as m_siteEvents[x][y], x,y : 0..OWNED_SIDE-1.
@@ -190,6 +356,35 @@ namespace MFM
     /** Set to true if an impossible count is detected */
     bool m_needRecount;
 
+    /**
+     * The last Stats published by PublishStats, guarded by
+     * m_statsLock
+     */
+    Stats m_publishedStats;
+
+    SeqLock m_statsLock;
+
+#ifdef MFM_INSTRUMENT
+    /** What this Tile has recorded since its last ResetProfile */
+    Profile m_profile;
+#endif
+
+    /**
+     * Reads \c field of m_publishedStats consistently.
+     */
+    template <class F>
+    F ReadPublished(const F & field) const
+    {
+      F value;
+      u32 seq;
+      do
+      {
+        seq = m_statsLock.BeginRead();
+        value = field;
+      } while (m_statsLock.ShouldRetryRead(seq));
+      return value;
+    }
+
     /** A count of corrupted atoms for which an element could not be
         found */
     s32 m_illegalAtomCount;
@@ -209,6 +404,44 @@ namespace MFM
         Connection. */
     bool m_iLocked[8];
 
+    /** The number of PACKET_EVENT_COMPLETEs sent on each Connection
+        that have not yet been acknowledged. */
+    u32 m_outstandingAcks[8];
+
+    /**
+     * An event whose PACKET_EVENT_COMPLETEs have not all been
+     * acknowledged.  Every Connection the event locked stays locked
+     * until the last of its acknowledgments arrives, so that no
+     * neighbor can start an event in the shared region before all of
+     * its recipients have applied its updates.
+     */
+    struct PendingEvent
+    {
+      /** Dirs still owing this event an acknowledgment */
+      u8 m_waitMask;
+
+      /** Dirs whose locks this event needs held */
+      u8 m_lockMask;
+    };
+
+    /** Enough for EVENT_ACK_WINDOW events in flight on every
+        Connection at once. */
+    static const u32 MAX_PENDING_EVENTS = 8 * EVENT_ACK_WINDOW;
+
+    /** Events awaiting acknowledgment, oldest first. */
+    PendingEvent m_pendingEvents[MAX_PENDING_EVENTS];
+
+    /** The number of entries in use in m_pendingEvents */
+    u32 m_pendingEventCount;
+
+    /** The sequence number for the next PACKET_EVENT_COMPLETE sent
+        on each Connection. */
+    u8 m_sendSequence[8];
+
+    /** The sequence number expected on the next
+        PACKET_EVENT_ACKNOWLEDGE received on each Connection. */
+    u8 m_ackSequence[8];
+
     /**
      * The real Connections to half of this Tile's neighbors. Indexing
      * begins at EUDIR_EAST and ends at EUDIR_SOUTHWEST .
@@ -228,6 +461,13 @@ namespace MFM
      */
     bool m_threadInitialized;
 
+    /**
+     * If true, Start() does not create m_thread, and this Tile's
+     * events happen only when some other thread calls
+     * ExecuteQuantum().
+     */
+    bool m_threadless;
+
     /**
      * Returns true if this Tile is paused, or if the accessing thread
      * is this Tile's owner.
@@ -235,7 +475,7 @@ namespace MFM
     bool IsPausedOrOwner()
     {
       return m_threadPauser.GetStateNonblocking()==THREADSTATE_PAUSED
-        || pthread_equal(pthread_self(), m_thread);
+        || (!m_threadless && pthread_equal(pthread_self(), m_thread));
     }
 
 #if 0
@@ -271,6 +511,113 @@ namespace MFM
      */
     u8 m_generation;
 
+    /**
+     * How this Tile decides when to execute its events.
+     *
+     * @sa SetEventSchedule
+     */
+    EventSchedule m_eventSchedule;
+
+    /**
+     * For the phased EventSchedules, the PhaseClock this Tile keeps
+     * in step with, shared by every Tile in the grid.
+     */
+    PhaseClock * m_phaseClock;
+
+    /**
+     * This Tile's checkerboard color, 0..CHECKERBOARD_COLORS-1, which
+     * picks the phases in which it executes its boundary events.
+     */
+    u32 m_phaseColor;
+
+    /**
+     * The phase of m_phaseClock this Tile is working on, or has
+     * finished if m_phaseArrived is true.
+     */
+    u32 m_phase;
+
+    /**
+     * True once this Tile has arrived at m_phaseClock for m_phase .
+     */
+    bool m_phaseArrived;
+
+    /**
+     * The number of sites drawn so far in the current round.
+     */
+    u32 m_roundDraws;
+
+    /**
+     * The sites drawn whose events need locks (in deterministic
+     * mode) or might conflict with a neighbor's (in checkerboard
+     * mode), in the order drawn.  They are executed in this Tile's
+     * boundary phase.
+     */
+    SPoint m_deferredSites[DETERMINISTIC_EVENTS_PER_ROUND];
+
+    /**
+     * The number of entries in m_deferredSites .
+     */
+    u32 m_deferredCount;
+
+    /**
+     * The number of entries in m_deferredSites already executed.
+     */
+    u32 m_deferredNext;
+
+    /**
+     * In batched mode, the sites of the current batch whose events
+     * need no locks, sorted by the type of atom at each when drawn.
+     */
+    SPoint m_batchSites[BATCHED_EVENTS];
+
+    /**
+     * The center atom types that m_batchSites is sorted by.
+     */
+    u32 m_batchTypes[BATCHED_EVENTS];
+
+    /**
+     * Returns this Tile to the start of phase 0 of its phased
+     * EventSchedule, forgetting any sites drawn.
+     */
+    void ResetPhases();
+
+    /**
+     * Checks that sending one more event's packets in the given
+     * directions would not exceed EVENT_ACK_WINDOW on any of them.
+     *
+     * @param dirMask The Dirs the event might send to.
+     */
+    bool HasAckRoom(u32 dirMask) const;
+
+    /**
+     * Performs one iteration of the checkerboard schedule.  Sites are
+     * drawn uniformly at all times.  Events needing no locks are
+     * executed at once; the rest are deferred until the phase for
+     * this Tile's color, when no neighbor executes any such events,
+     * and are then executed without locking.  Once they are done and
+     * acknowledged, this Tile arrives at m_phaseClock .  A Tile with
+     * no room left to defer waits for its phase.
+     */
+    void ExecuteCheckerboardStep();
+
+    /**
+     * Performs one iteration of the deterministic schedule: draws
+     * and executes (or defers) a site in the interior phase, executes
+     * a deferred site in this Tile's boundary phase, or otherwise
+     * services Connections and, once everything this Tile sent in
+     * the phase is acknowledged, arrives at m_phaseClock .
+     */
+    void ExecuteDeterministicStep();
+
+    /**
+     * Performs one iteration of the batched schedule: draws
+     * BATCHED_EVENTS sites, executes those needing locks at once as
+     * SCHEDULE_LOCKING would, then executes the rest grouped by their
+     * center atom types, looking up each type's Element once per run
+     * so consecutive events dispatch to the same Element::Behavior .
+     */
+    void ExecuteBatchedStep();
+
     /**
      * Checks to see if this Tile owns the connection over a particular
      * cache.
@@ -297,9 +644,10 @@ namespace MFM
     void CreateWindowAt(const SPoint& pt);
 
     /**
-     * Populates m_outgoingPackets with all Packets describing the state of
-     * this Tile's caches. All Packets created by this method are ready to
-     * be output to other Tiles.
+     * Sends every site of m_executingWindow that was modified during
+     * the current event, and that is visible to a connected neighbor,
+     * to that neighbor.  All of the modified sites for a given
+     * neighbor are packed into a single PACKET_UPDATE record.
      *
      * @returns a bitfield describing which neighbors need to be
      *          waited on for receipt of an acknowledgement
@@ -309,15 +657,43 @@ namespace MFM
     u32 SendRelevantAtoms();
 
     /**
-     * Alerts a neighboring Tile that this Tile has completed its
+     * Finds the connected neighbors whose caches hold a copy of the
+     * site at \c localLoc.
+     *
+     * @param localLoc The location, in this Tile's coordinates, of an
+     *                 owned site.
+     *
+     * @returns a Dir mask of the connected neighbors that need to be
+     *          told about any change to the site at \c localLoc.
+     */
+    u32 GetRelevantNeighbors(const SPoint& localLoc) const;
+
+    /**
+     * Sends a single PACKET_UPDATE record to \c neighbor, holding
+     * each of the \c count sites in \c locs whose corresponding
+     * entry in \c siteDirs includes \c neighbor.
+     *
+     * @param neighbor The Dir of the connected neighbor to update.
+     *
+     * @param locs The locations, in this Tile's coordinates, of the
+     *             candidate sites.
+     *
+     * @param siteDirs For each entry of \c locs, the Dir mask of the
+     *                 neighbors which need that site.
+     *
+     * @param count The number of entries in \c locs and \c siteDirs.
+     */
+    void SendAtomUpdates(Dir neighbor, const SPoint * locs, const u32 * siteDirs, u32 count);
+
+    /**
+     * Alerts neighboring Tiles that this Tile has completed its
      * event. This keeps the inter-tile buffers from overflowing. This
-     * should be the last thing called (once per relevant neighbor)
-     * during an event.
+     * should be the last thing called during an event.  Each packet
+     * sent is tagged with the next sequence number for its
+     * Connection and counted in m_outstandingAcks until acknowledged.
      *
-     * @param neighbor The EuclidDir of the direction of the
-     *                 neighboring Tile which should be sent an "Event
-     *                 Complete" packet and waited on for an
-     *                 acknowledgement Packet.
+     * @param dirWaitWord A Dirs mask of the neighboring Tiles which
+     *                    should be sent an "Event Complete" packet.
      */
     void SendEndEventPackets(u32 dirWaitWord);
 
@@ -358,7 +734,8 @@ namespace MFM
      *
      * @returns true if there is no connection in \c connectionDir.
      *          Otherwise, returns true if the lock for the specified
-     *          direction has been acquired, else false.
+     *          direction has been acquired, or is still held from an
+     *          earlier event awaiting acknowledgment, else false.
      */
     bool TryLock(Dir connectionDir);
 
@@ -401,8 +778,40 @@ namespace MFM
      */
     void UnlockCorner(Dir corner);
 
+    /**
+     * Unlocks the Connection of the specified direction, unless some
+     * event awaiting acknowledgment still needs it held, in which
+     * case the lock is kept until the last such event is retired.
+     */
     void UnlockDir(Dir dir) ;
 
+    /**
+     * Gets the Dirs whose Connections must be locked to execute an
+     * event in a given region.
+     *
+     * @param regionDir the EuclidDir of the region.
+     *
+     * @returns a Dir mask of one edge, or of a corner and its two
+     *          adjacent edges.
+     */
+    static u32 GetRegionLockMask(Dir regionDir);
+
+    /**
+     * Gets the Dirs whose locks are still needed by events awaiting
+     * acknowledgment.
+     */
+    u32 GetPendingLockMask() const;
+
+    /**
+     * Records an event whose PACKET_EVENT_COMPLETEs were just sent,
+     * so the locks it needs outlive its UnlockRegion call.
+     *
+     * @param waitMask the Dirs the event was sent to.
+     *
+     * @param lockMask the Dirs the event locked.
+     */
+    void AddPendingEvent(u32 waitMask, u32 lockMask);
+
     /**
      * Unlocks an edge of this Tile. This takes into account the fact
      * that three regions must be unlocked when attempting to use this
@@ -450,8 +859,22 @@ namespace MFM
 
     /**
      * Performs a single Event on the generated EventWindow .
+     *
+     * @param expected If non-null, the Element the center atom is
+     *                 expected to belong to, which is then dispatched
+     *                 to without a type lookup.
+     *
+     * @sa ElementTable::Execute(EventWindow<CC>&, const Element<CC>*)
      */
-    void DoEvent(bool locked, Dir lockRegion);
+    void DoEvent(bool locked, Dir lockRegion, const Element<CC> * expected = 0);
+
+    /**
+     * Cleans up after an event whose behavior FAILed: counts the
+     * failure and erases the center atom.  When built with
+     * MFM_EVENT_ROLLBACK, first undoes everything else the event
+     * wrote.
+     */
+    void EraseFailedEvent();
 
    public:
     void ReportTileStatus(Logger::Level level);
@@ -478,6 +901,12 @@ namespace MFM
      */
     Tile();
 
+    /**
+     * Destroys this Tile, first ending its thread if it has one.
+     * The Tile must be paused, or never started.
+     */
+    ~Tile();
+
     /**
      * Reinitializes a Tile to a like-new (actually, like-OnceOnlyInit()ed) state.
      */
@@ -686,6 +1115,68 @@ namespace MFM
       return m_eventsExecuted;
     }
 
+    /**
+     * Copies this Tile's current statistics into m_publishedStats.
+     * Called by this Tile's thread every STATS_PUBLISH_EVENTS events
+     * and as it readies to pause, and by whoever changes the Tile
+     * while it is paused.  Only one thread may publish at a time.
+     */
+    void PublishStats();
+
+    /**
+     * Gets a consistent copy of the Stats this Tile last published.
+     * Any thread may call this at any time; it never blocks this
+     * Tile.  While this Tile is paused, its published Stats are
+     * current.
+     */
+    void GetStats(Stats & stats) const;
+
+    /**
+     * As GetEventsExecuted, but from the published Stats, so safe
+     * from any thread.
+     */
+    u64 GetPublishedEventsExecuted() const
+    {
+      return ReadPublished(m_publishedStats.m_eventsExecuted);
+    }
+
+    /**
+     * As GetAtomCount, but from the published Stats, so safe from
+     * any thread.
+     */
+    u32 GetPublishedAtomCount(ElementType atomType) const;
+
+    /**
+     * Gets slot \c index of this Tile's element-specific data (see
+     * ElementTable::GetAllElementData) from the published Stats, so
+     * safe from any thread.
+     */
+    u64 GetPublishedElementData(u32 index) const
+    {
+      if (index >= P::ELEMENT_DATA_SLOTS)
+      {
+        FAIL(ARRAY_INDEX_OUT_OF_BOUNDS);
+      }
+      return ReadPublished(m_publishedStats.m_elementData[index]);
+    }
+
+#ifdef MFM_INSTRUMENT
+    /**
+     * Gets what this Tile has recorded since its last ResetProfile.
+     * Unlike the Stats, this is not published: only read it while
+     * this Tile is paused.
+     */
+    const Profile & GetProfile() const
+    {
+      return m_profile;
+    }
+
+    void ResetProfile()
+    {
+      m_profile.Clear();
+    }
+#endif
+
     /**
      * Checks to see if a specified SPoint is in a given region of this
      * Tile (i.e. cache, shared, visible, or hidden).
@@ -891,6 +1382,36 @@ namespace MFM
      */
     void SendAcknowledgmentPacket(Packet<T>& packet);
 
+    /**
+     * Processes a PACKET_EVENT_ACKNOWLEDGE Packet that has just been
+     * read from the Connection in direction \c from, retiring the
+     * oldest outstanding event sent that way and unlocking any
+     * Connections no remaining event needs.  FAILs with ILLEGAL_STATE if the
+     * acknowledgment was unexpected or out of sequence.
+     *
+     * @param from The Dir of the Connection \c packet arrived on.
+     *
+     * @param packet The PACKET_EVENT_ACKNOWLEDGE Packet.
+     */
+    void ReceiveAcknowledgmentPacket(Dir from, Packet<T>& packet);
+
+    /**
+     * Checks for Connections with many unacknowledged events.
+     *
+     * @returns true if more than \c maxOutstanding events sent on
+     *          any Connection are still awaiting acknowledgment.
+     */
+    bool HasOutstandingAcks(u32 maxOutstanding) const;
+
+    /**
+     * Gets the number of events sent on the Connection in direction
+     * \c dir that are still awaiting acknowledgment.
+     */
+    u32 GetOutstandingAcks(Dir dir) const
+    {
+      return m_outstandingAcks[dir];
+    }
+
     /**
      * Processes a Packet, performing all necessary operations defined by
      * Packet semantics.
@@ -899,6 +1420,18 @@ namespace MFM
      */
     void ReceivePacket(Packet<T>& packet);
 
+    /**
+     * Processes a PACKET_UPDATE Packet that has just been read from
+     * the Connection in direction \c from, by reading the
+     * PacketUpdate records that follow it from that same Connection
+     * and storing their Atoms.
+     *
+     * @param from The Dir of the Connection \c header arrived on.
+     *
+     * @param header The PACKET_UPDATE Packet heading the records.
+     */
+    void ReceiveUpdatePacket(Dir from, Packet<T>& header);
+
 #if 0 /* Doesn't exist? */
     /**
      * Gets a Pointer to the next Packet which is queued inside of
@@ -948,15 +1481,18 @@ namespace MFM
 
     /**
      * Process all incoming and outgoing Packets which are pending on
-     * this Tile .
+     * this Tile , repeating until enough outstanding events have
+     * been acknowledged.
      *
-     * @param dirWaitWord A word describing which buffers need to be
-     *                    waited on for Packet communication.
+     * @param maxOutstanding Keep waiting while more than this many
+     *                       events are unacknowledged on any
+     *                       Connection.  Zero waits for every
+     *                       acknowledgment.
      *
      * @return true if any connection locks are currently held (by
      * either end), else false
      */
-    bool FlushAndWaitOnAllBuffers(u32 dirWaitWord);
+    bool FlushAndWaitOnAllBuffers(u32 maxOutstanding);
 
     /**
      * Log warnings if connection buffers are not empty.
@@ -990,10 +1526,49 @@ namespace MFM
     }
 
     /**
-     * Executes a single new EventWindow at a randomly chosen location.
+     * Runs this Tile's event loop on the calling thread until the
+     * Tile is reinitialized, blocking whenever the Tile is paused.
      */
     void Execute();
 
+    /**
+     * Performs up to \c maxSteps iterations of this Tile's event loop
+     * on the calling thread, without ever blocking.  This is how a
+     * threadless Tile is driven.  At most one thread may be inside
+     * ExecuteQuantum() for a given Tile at a time.
+     *
+     * @param maxSteps The most event attempts to make.
+     *
+     * @returns \c false if this Tile was paused (or waiting to run)
+     *          and so did nothing, else \c true .
+     *
+     * @sa SetThreadless
+     */
+    bool ExecuteQuantum(u32 maxSteps);
+
+    /**
+     * Sets whether Start() should create a thread to run this Tile,
+     * or leave it to be run via ExecuteQuantum().  Must be called
+     * before this Tile is first started.
+     */
+    void SetThreadless(bool value)
+    {
+      if (m_threadInitialized)
+      {
+        FAIL(ILLEGAL_STATE);
+      }
+      m_threadless = value;
+    }
+
+    /**
+     * Performs one iteration of this Tile's event loop: a single
+     * event attempt while running, or one step of a pause or run
+     * transition.  Never waits for a neighbor's acknowledgments.
+     *
+     * @param state The current state of m_threadPauser .
+     */
+    void ExecuteStep(ThreadState state);
+
     /**
      * Used during thread execution to call the execution loop.
      *
@@ -1025,6 +1600,53 @@ namespace MFM
      */
     void InternalPutAtom(const T & atom, s32 x, s32 y);
 
+    /**
+     * The body of PlaceAtom: applies any background radiation to \c
+     * newAtom, then stores it at \c pt with WriteAtom.
+     *
+     * @returns \c false, having stored nothing, if radiation left \c
+     *          newAtom inconsistent; else \c true.
+     */
+    bool StoreAtom(T & newAtom, const SPoint& pt);
+
+    /**
+     * Stores \c atom, just received from the neighbor that owns \c
+     * pt , in our cache.  Unlike PlaceAtom, applies no background
+     * radiation: the owner's write already had its chance, and
+     * irradiating our copy as well would leave the cache disagreeing
+     * with the original -- and would make radiation draws depend on
+     * when packets happen to arrive.
+     */
+    void ReceiveAtom(const T& atom, const SPoint& pt);
+
+    /**
+     * Stores \c newAtom at \c pt as is, keeping the atom counts and
+     * change times up to date.
+     */
+    void WriteAtom(const T& newAtom, const SPoint& pt);
+
+    /**
+     * Replaces the atom at \c pt with Empty, keeping the atom counts
+     * up to date.  Used when a write fails.
+     */
+    void EraseAtom(const SPoint& pt);
+
+    /**
+     * Adjusts the atom counts for the site at \c pt having changed
+     * from \c oldType to \c newType.  Sites in the cache are not
+     * counted, so changes there are ignored.  Every change to
+     * m_atoms that can change a type must go through here (or
+     * WriteAtom), so the counts never need a full RecountAtoms.
+     */
+    void CountTypeChange(const SPoint& pt, u32 oldType, u32 newType)
+    {
+      if (oldType != newType && !IsInCache(pt))
+      {
+        IncrAtomCount(oldType, -1);
+        IncrAtomCount(newType, 1);
+      }
+    }
+
     /**
      * Sets the internal count of Atoms of a specified ElementType.
      *
@@ -1036,7 +1658,8 @@ namespace MFM
     void SetAtomCount(ElementType atomType, s32 count);
 
     /**
-     * Begins event execution on this Tile on its own thread.
+     * Begins event execution on this Tile on its own thread (or, if
+     * it is threadless, allows ExecuteQuantum() to execute events).
      * Events will continue to happen until paused.
      *
      * @sa Pause
@@ -1051,6 +1674,49 @@ namespace MFM
      */
     void Pause();
 
+    /**
+     * Sets how this Tile decides when to execute its events.  Must
+     * only be called while this Tile is paused.
+     *
+     * In SCHEDULE_DETERMINISTIC, a Tile's events are a function only
+     * of its Random seed and the states of the Tiles around it.
+     * Events happen in rounds of DETERMINISTIC_PHASES_PER_ROUND
+     * phases, paced by \c clock .  A boundary event that a neighbor
+     * might contend for is never raced for the lock; it is deferred
+     * to the boundary phase for this Tile's \c color , in which no
+     * neighbor executes events.
+     *
+     * In SCHEDULE_CHECKERBOARD, boundary events are likewise deferred
+     * to this Tile's phase, but phases are paced only by the Tiles
+     * themselves, and need no locks at all.
+     *
+     * In SCHEDULE_BATCHED, events lock as in SCHEDULE_LOCKING, but
+     * sites are drawn BATCHED_EVENTS at a time, and those needing no
+     * locks are executed grouped by element type.  Events within a
+     * batch are thereby reordered, which is usually harmless but is
+     * not the strictly sequential draw-and-execute of the default.
+     *
+     * @param schedule The EventSchedule to follow.
+     *
+     * @param clock The PhaseClock shared by all Tiles in the grid,
+     *              for the phased schedules; else ignored.
+     *
+     * @param color This Tile's checkerboard color,
+     *              0..CHECKERBOARD_COLORS-1; no two neighboring Tiles
+     *              may share a color.
+     */
+    void SetEventSchedule(EventSchedule schedule, PhaseClock * clock, u32 color);
+
+    /**
+     * Sets the ThreadBarrier this Tile arrives at each time it
+     * becomes ready to pause or to run, or NULL for none.  Must only
+     * be called while this Tile is paused.
+     */
+    void SetControlBarrier(ThreadBarrier * barrier)
+    {
+      m_threadPauser.SetBarrier(barrier);
+    }
+
     /**
      * Sees if this Tile is ready to be run.  We let all tiles respond
      * to a RunRequest before moving on to actually running, so this
@@ -1098,8 +1764,9 @@ namespace MFM
     void IncrAtomCount(ElementType atomType, s32 delta);
 
     /** Do a full count of atom types and FAIL unless the atom
-        histogram in m_atomCount is consistent with the content of
-        m_atoms. */
+        histogram in m_atomCount, and m_illegalAtomCount, are
+        consistent with the content of m_atoms.  As costly as
+        RecountAtoms, so only for debugging and tests. */
     void AssertValidAtomCounts() const;
 
     /**
@@ -1110,7 +1777,8 @@ namespace MFM
 
     /**
      * Resets all atom counts and refreshes the atoms counts inside
-     * this tile.
+     * this tile.  Does not publish them, since the constructor gets
+     * here (via ClearAtoms) before the other statistics are set.
      */
     void RecountAtoms();
 
@@ -1131,6 +1799,11 @@ namespace MFM
     void RegisterElement(const Element<CC> & anElement)
     {
       elementTable.RegisterElement(anElement);
+      if (m_illegalAtomCount > 0)
+      {
+        // Some atoms we counted as illegal may be of this type now
+        RecountAtoms();
+      }
     }
 
     /**
@@ -1161,7 +1834,9 @@ namespace MFM
     /**
      * Iterates through each Atom in this Tile, XRaying each atom
      * based on a provided rate and flipping a bit in each selected
-     * atom at a provided rate.
+     * atom at a provided rate.  Selected sites are found by skipping
+     * ahead with Random::CreateGeometric rather than drawing once
+     * per site.
      *
      * @param siteOdds The odds of an Atom to be selected for XRay.
      *
@@ -1170,6 +1845,34 @@ namespace MFM
      */
     void XRay(u32 siteOdds, u32 bitOdds);
 
+    /**
+     * Checks the ECC of every Atom in a region of this Tile,
+     * repairing those Atoms that can be repaired and replacing the
+     * rest with Empty.  Meant for epoch maintenance of a paused Tile,
+     * so that corrupted atoms are found in one cheap sweep rather
+     * than only when an event happens to land on them.  Atom counts
+     * are refreshed if anything changed.
+     *
+     * @param region The sites to check, in Tile coordinates.  It is
+     *               clipped to the Tile.
+     *
+     * @param repaired Incremented by the number of Atoms repaired.
+     *
+     * @param erased Incremented by the number of Atoms that could
+     *               not be repaired and were replaced with Empty.
+     */
+    void CheckAndRepairRegion(const Rect & region, u32 & repaired, u32 & erased);
+
+    /**
+     * Checks and repairs every site of this Tile, caches included.
+     *
+     * \sa CheckAndRepairRegion
+     */
+    void CheckAndRepairAtoms(u32 & repaired, u32 & erased)
+    {
+      CheckAndRepairRegion(Rect(0, 0, TILE_WIDTH, TILE_WIDTH), repaired, erased);
+    }
+
   };
 } /* namespace MFM */
 
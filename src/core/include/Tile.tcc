@@ -5,18 +5,46 @@
 #include "AtomSerializer.h"
 #include "PacketSerializer.h"
 #include "Util.h"
+#include <string.h>  /* For memcpy */
 
 namespace MFM
 {
   template <class CC>
   Tile<CC>::Tile() :
+    m_eventLog(EVENT_LOGS_PER_SECOND),
     m_executingWindow(*this),
-    m_generation(0)
+    m_threadless(false),
+    m_generation(0),
+    m_eventSchedule(SCHEDULE_LOCKING),
+    m_phaseClock(NULL),
+    m_phaseColor(0)
   {
+    // A full window of maximal events must fit in a connection buffer
+    COMPILATION_REQUIREMENT<EVENT_ACK_WINDOW *
+                            (2 * sizeof(Packet<T>) +
+                             EVENT_WINDOW_SITES(R) * sizeof(PacketUpdate<T>))
+                            <= THREADQUEUE_MAX_BYTES>();
+
     m_lockAttempts = m_lockAttemptsSucceeded = 0;
+    m_illegalAtomCount = 0;  // Reinit's RegisterElement reads it before ClearAtoms
     Reinit();
   }
 
+  template <class CC>
+  Tile<CC>::~Tile()
+  {
+    if (m_threadInitialized && !m_threadless &&
+        m_threadPauser.GetStateNonblocking() == THREADSTATE_PAUSED)
+    {
+      // Wake our thread just far enough for Execute() to notice it
+      // should quit, so nobody is left waiting on our ThreadPauser
+      m_threadInitialized = false;
+      m_threadPauser.SetBarrier(NULL);
+      m_threadPauser.RequestRun();
+      pthread_join(m_thread, NULL);
+    }
+  }
+
   template <class CC>
   void Tile<CC>::Reinit()
   {
@@ -32,10 +60,13 @@ namespace MFM
 #endif
 
     m_eventsExecuted = 0;
+    m_eventsFailed = 0;
+    m_failuresErased = 0;
 
     m_executeOwnEvents = true;
 
     m_backgroundRadiationEnabled = false;
+    m_writesUntilRadiation = 0;
 
     /* Set up our connection pointers. Some of these may remain NULL, */
     /* symbolizing a dead edge.       */
@@ -53,7 +84,12 @@ namespace MFM
            comes. */
         m_connections[i] = NULL;
       }
+      m_iLocked[i] = false;
+      m_outstandingAcks[i] = 0;
+      m_sendSequence[i] = 0;
+      m_ackSequence[i] = 0;
     }
+    m_pendingEventCount = 0;
 
     /* Zero out all of the counting fields */
     for(u32 i = 0; i < REGION_COUNT; i++)
@@ -64,6 +100,9 @@ namespace MFM
     {
       m_lockEvents[i] = 0;
     }
+#ifdef MFM_INSTRUMENT
+    m_profile.Clear();
+#endif
     for(u32 x = 0; x < OWNED_SIDE; x++)
     {
       for(u32 y = 0; y < OWNED_SIDE; y++)
@@ -73,9 +112,40 @@ namespace MFM
       }
     }
 
+    ResetPhases();
+
     m_needRecount = false;
     m_threadInitialized = false;
     //    m_threadPaused = false;
+
+    PublishStats();
+  }
+
+  template <class CC>
+  void Tile<CC>::ResetPhases()
+  {
+    m_phase = 0;
+    m_phaseArrived = false;
+    m_roundDraws = 0;
+    m_deferredCount = 0;
+    m_deferredNext = 0;
+  }
+
+  template <class CC>
+  void Tile<CC>::SetEventSchedule(EventSchedule schedule, PhaseClock * clock, u32 color)
+  {
+    if (color >= CHECKERBOARD_COLORS)
+    {
+      FAIL(ILLEGAL_ARGUMENT);
+    }
+    if ((schedule == SCHEDULE_DETERMINISTIC || schedule == SCHEDULE_CHECKERBOARD) && !clock)
+    {
+      FAIL(NULL_POINTER);
+    }
+    m_eventSchedule = schedule;
+    m_phaseClock = clock;
+    m_phaseColor = color;
+    ResetPhases();
   }
 
   /* Definitely not thread safe. Make sure to pause and join this Tile
@@ -202,12 +272,132 @@ namespace MFM
     // Acknowledge on whatever generation they said they were
     Packet<T> sendout(PACKET_EVENT_ACKNOWLEDGE, packet.GetGeneration());
     sendout.SetReceivingNeighbor(from);
+    sendout.SetSequence(packet.GetSequence());
 
     m_connections[from]->Write(!IS_OWNED_CONNECTION(from),
                                (u8*)&sendout,
                                sizeof(Packet<T>));
   }
 
+  template <class CC>
+  void Tile<CC>::ReceiveAcknowledgmentPacket(Dir from, Packet<T>& packet)
+  {
+    if (m_outstandingAcks[from] == 0)
+    {
+      FAIL(ILLEGAL_STATE);  /* Acknowledging an event we never sent! */
+    }
+    if (packet.GetSequence() != m_ackSequence[from])
+    {
+      FAIL(ILLEGAL_STATE);  /* Acknowledgments out of sequence! */
+    }
+
+    ++m_ackSequence[from];
+    --m_outstandingAcks[from];
+
+    /* Acknowledgments arrive in order on each connection, so this one
+       belongs to the oldest pending event still waiting on 'from'. */
+    u32 i;
+    for(i = 0; i < m_pendingEventCount; ++i)
+    {
+      if (Dirs::TestDirInMask(m_pendingEvents[i].m_waitMask, from))
+      {
+        break;
+      }
+    }
+    if (i == m_pendingEventCount)
+    {
+      FAIL(ILLEGAL_STATE);  /* Acknowledging an event we never recorded! */
+    }
+
+    m_pendingEvents[i].m_waitMask =
+      Dirs::RemoveDirInMask(m_pendingEvents[i].m_waitMask, from);
+    if (m_pendingEvents[i].m_waitMask != 0)
+    {
+      return;
+    }
+
+    u32 retiredLocks = m_pendingEvents[i].m_lockMask;
+    for(--m_pendingEventCount; i < m_pendingEventCount; ++i)
+    {
+      m_pendingEvents[i] = m_pendingEvents[i + 1];
+    }
+
+    for(Dir dir = Dirs::NORTH; dir < Dirs::DIR_COUNT; ++dir)
+    {
+      if (Dirs::TestDirInMask(retiredLocks, dir) && m_iLocked[dir])
+      {
+        UnlockDir(dir);
+      }
+    }
+  }
+
+  template <class CC>
+  u32 Tile<CC>::GetRegionLockMask(Dir regionDir)
+  {
+    u32 mask = Dirs::AddDirToMask(0, regionDir);
+    switch(regionDir)
+    {
+    case Dirs::NORTH:
+    case Dirs::EAST:
+    case Dirs::SOUTH:
+    case Dirs::WEST:
+      return mask;
+
+    case Dirs::NORTHWEST:
+    case Dirs::NORTHEAST:
+    case Dirs::SOUTHEAST:
+    case Dirs::SOUTHWEST:
+      mask = Dirs::AddDirToMask(mask, Dirs::CCWDir(regionDir));
+      return Dirs::AddDirToMask(mask, Dirs::CWDir(regionDir));
+
+    default:
+      FAIL(ILLEGAL_ARGUMENT);
+    }
+  }
+
+  template <class CC>
+  u32 Tile<CC>::GetPendingLockMask() const
+  {
+    u32 mask = 0;
+    for(u32 i = 0; i < m_pendingEventCount; ++i)
+    {
+      mask |= m_pendingEvents[i].m_lockMask;
+    }
+    return mask;
+  }
+
+  template <class CC>
+  void Tile<CC>::AddPendingEvent(u32 waitMask, u32 lockMask)
+  {
+    if (m_pendingEventCount >= MAX_PENDING_EVENTS)
+    {
+      FAIL(OUT_OF_ROOM);
+    }
+    PendingEvent & pe = m_pendingEvents[m_pendingEventCount++];
+    pe.m_waitMask = (u8) waitMask;
+    pe.m_lockMask = (u8) (lockMask | waitMask);
+
+#ifdef MFM_INSTRUMENT
+    if (m_pendingEventCount > m_profile.m_pendingEventsHighWater)
+    {
+      m_profile.m_pendingEventsHighWater = m_pendingEventCount;
+    }
+#endif
+  }
+
+  template <class CC>
+  bool Tile<CC>::HasOutstandingAcks(u32 maxOutstanding) const
+  {
+    for(Dir dir = Dirs::NORTH; dir < Dirs::DIR_COUNT; ++dir)
+    {
+      if (m_outstandingAcks[dir] > maxOutstanding)
+      {
+        return true;
+      }
+    }
+    return false;
+  }
+
   template <class CC>
   void Tile<CC>::ReceivePacket(Packet<T>& packet)
   {
@@ -225,15 +415,15 @@ namespace MFM
       {
         if(packet.GetAtom().IsSane())
         {
-          PlaceAtom(packet.GetAtom(), packet.GetLocation());
+          ReceiveAtom(packet.GetAtom(), packet.GetLocation());
         }
         else
         {
-          LOG.Debug("%s received insane atom for (%d,%d), discarding",
-                    this->GetLabel(),
-                    packet.GetLocation().GetX(),
-                    packet.GetLocation().GetY());
-          PlaceAtom(Element_Empty<CC>::THE_INSTANCE.GetDefaultAtom(), packet.GetLocation());
+          MFM_LOG_DBG_LIMITED(m_eventLog)("%s received insane atom for (%d,%d), discarding",
+                                          this->GetLabel(),
+                                          packet.GetLocation().GetX(),
+                                          packet.GetLocation().GetY());
+          ReceiveAtom(Element_Empty<CC>::THE_INSTANCE.GetDefaultAtom(), packet.GetLocation());
         }
       }
       break;
@@ -248,6 +438,46 @@ namespace MFM
     }
   }
 
+  template <class CC>
+  void Tile<CC>::ReceiveUpdatePacket(Dir from, Packet<T>& header)
+  {
+    PacketUpdate<T> updates[EVENT_WINDOW_SITES(R)];
+    const u32 count = header.GetUpdateCount();
+    if (count > EVENT_WINDOW_SITES(R))
+    {
+      FAIL(ILLEGAL_STATE);  /* More sites than any event could touch! */
+    }
+
+    const u32 length = count * sizeof(PacketUpdate<T>);
+    if (length > 0 &&
+        m_connections[from]->Read(!IS_OWNED_CONNECTION(from), (u8*) updates, length) != length)
+    {
+      FAIL(ILLEGAL_STATE);  /* Didn't read the whole update record! */
+    }
+
+    if (header.GetGeneration() != m_generation)
+    {
+      LOG.Debug("Received obsolete update packet in %d", m_generation);
+      return;
+    }
+
+    for (u32 i = 0; i < count; ++i)
+    {
+      if(updates[i].GetAtom().IsSane())
+      {
+        ReceiveAtom(updates[i].GetAtom(), updates[i].GetLocation());
+      }
+      else
+      {
+        MFM_LOG_DBG_LIMITED(m_eventLog)("%s received insane atom for (%d,%d), discarding",
+                                        this->GetLabel(),
+                                        updates[i].GetLocation().GetX(),
+                                        updates[i].GetLocation().GetY());
+        ReceiveAtom(Element_Empty<CC>::THE_INSTANCE.GetDefaultAtom(), updates[i].GetLocation());
+      }
+    }
+  }
+
   template <class CC>
   void Tile<CC>::FillLastExecutedAtom(SPoint& out)
   {
@@ -346,52 +576,90 @@ namespace MFM
     }
 
     T newAtom = atom;
+#ifdef MFM_EVENT_ROLLBACK
+    /* No frame of our own: a radiation fault is our only failure,
+       so handle it in place rather than via FAIL */
+    if (!StoreAtom(newAtom, pt))
+    {
+      EraseAtom(pt);
+    }
+#else
     unwind_protect(
     {
-      InternalPutAtom(Element_Empty<CC>::THE_INSTANCE.GetDefaultAtom(),
-                      pt.GetX(), pt.GetY());
-      RecountAtoms();
+      EraseAtom(pt);
     },
     {
-      if(m_backgroundRadiationEnabled &&
-         m_random.OneIn(BACKGROUND_RADIATION_SITE_ODDS))
+      if (!StoreAtom(newAtom, pt))
       {
-        // Write fault!
-        newAtom.XRay(m_random, BACKGROUND_RADIATION_BIT_ODDS);
-
-        if (!newAtom.IsSane())
-        {
-          // This is actually more like bogus control flow, rather a
-          // 'true' failure :(.  We just want to empty the site and
-          // recount, the same as if an inconsistency had been
-          // detected elsewhere in the code.
-          FAIL(INCONSISTENT_ATOM);
-        }
+        // This is actually more like bogus control flow, rather a
+        // 'true' failure :(.  We just want to empty the site and
+        // recount, the same as if an inconsistency had been
+        // detected elsewhere in the code.
+        FAIL(INCONSISTENT_ATOM);
       }
+    });
+#endif
+  }
+
+  template <class CC>
+  bool Tile<CC>::StoreAtom(T & newAtom, const SPoint& pt)
+  {
+    if(m_backgroundRadiationEnabled && m_writesUntilRadiation == 0)
+    {
+      m_writesUntilRadiation =
+        m_random.CreateGeometric(BACKGROUND_RADIATION_SITE_ODDS) + 1;
+    }
+
+    if(m_backgroundRadiationEnabled && --m_writesUntilRadiation == 0)
+    {
+      // Write fault!
+      newAtom.XRay(m_random, BACKGROUND_RADIATION_BIT_ODDS);
 
-      const T& oldAtom = *GetAtom(pt);
-      bool owned = IsOwnedSite(pt);
-      if (oldAtom != newAtom)
+      if (!newAtom.IsSane())
       {
-        if (owned)
-        {
-          const SPoint opt = pt - SPoint(R,R); // Really no routine to map into owned coords?
-          m_lastChangedEventNumber[opt.GetX()][opt.GetY()] = m_eventsExecuted;
-        }
+        return false;
+      }
+    }
 
-        u32 oldType = oldAtom.GetType();
-        u32 newType = newAtom.GetType();
-        if(newType != oldType && owned)
-        {
-          // Here we're displacing an oldType
-          // atom with a newType atom
-          IncrAtomCount(oldType, -1);
-          IncrAtomCount(newType, 1);
-        }
+    WriteAtom(newAtom, pt);
+    return true;
+  }
+
+  template <class CC>
+  void Tile<CC>::ReceiveAtom(const T& atom, const SPoint& pt)
+  {
+    if (!IsLiveSite(pt))
+    {
+      return;
+    }
+    WriteAtom(atom, pt);
+  }
 
-        InternalPutAtom(newAtom,pt.GetX(),pt.GetY());
+  template <class CC>
+  void Tile<CC>::WriteAtom(const T& newAtom, const SPoint& pt)
+  {
+    const T& oldAtom = *GetAtom(pt);
+    bool owned = IsOwnedSite(pt);
+    if (oldAtom != newAtom)
+    {
+      if (owned)
+      {
+        const SPoint opt = pt - SPoint(R,R); // Really no routine to map into owned coords?
+        m_lastChangedEventNumber[opt.GetX()][opt.GetY()] = m_eventsExecuted;
       }
-    });
+
+      CountTypeChange(pt, oldAtom.GetType(), newAtom.GetType());
+
+      InternalPutAtom(newAtom,pt.GetX(),pt.GetY());
+    }
+  }
+
+  template <class CC>
+  void Tile<CC>::EraseAtom(const SPoint& pt)
+  {
+    const T & empty = Element_Empty<CC>::THE_INSTANCE.GetDefaultAtom();
+    CountTypeChange(pt, GetAtom(pt)->GetType(), empty.GetType());
+    InternalPutAtom(empty, pt.GetX(), pt.GetY());
   }
 
   template <class CC>
@@ -497,6 +765,8 @@ namespace MFM
       {
         Packet<T> sendout(PACKET_EVENT_COMPLETE, m_generation);
         sendout.SetReceivingNeighbor(dir);
+        sendout.SetSequence(m_sendSequence[dir]++);
+        ++m_outstandingAcks[dir];
 
         /* We don't care about what other kind of stuff is in the Packet */
         m_connections[dir]->Write(!IS_OWNED_CONNECTION(dir),
@@ -508,73 +778,128 @@ namespace MFM
   }
 
   template <class CC>
-  u32 Tile<CC>::SendRelevantAtoms()
+  u32 Tile<CC>::GetRelevantNeighbors(const SPoint& localLoc) const
   {
     // Extract short names for parameter types
     typedef typename CC::PARAM_CONFIG P;
 
-    SPoint localLoc;
-    SPoint ewCenter;
+    const s32 r2 = R * 2;
+    u32 dirs = 0;
 
-    u32 dirBitfield = 0;
+    /* West neighbor? */
+    if(IsConnected(Dirs::WEST) && localLoc.GetX() < r2)
+    {
+      dirs = Dirs::AddDirToMask(dirs, Dirs::WEST);
+      if(IsConnected(Dirs::NORTH) && localLoc.GetY() < r2)
+      {
+        dirs = Dirs::AddDirToMask(dirs, Dirs::NORTHWEST);
+        dirs = Dirs::AddDirToMask(dirs, Dirs::NORTH);
+      }
+      else if(IsConnected(Dirs::SOUTH) && localLoc.GetY() >= P::TILE_WIDTH - r2)
+      {
+        dirs = Dirs::AddDirToMask(dirs, Dirs::SOUTHWEST);
+        dirs = Dirs::AddDirToMask(dirs, Dirs::SOUTH);
+      }
+    }
+    /*East neighbor?*/
+    else if(IsConnected(Dirs::EAST) && localLoc.GetX() >= P::TILE_WIDTH - r2)
+    {
+      dirs = Dirs::AddDirToMask(dirs, Dirs::EAST);
+      if(IsConnected(Dirs::NORTH) && localLoc.GetY() < r2)
+      {
+        dirs = Dirs::AddDirToMask(dirs, Dirs::NORTHEAST);
+        dirs = Dirs::AddDirToMask(dirs, Dirs::NORTH);
+      }
+      if(IsConnected(Dirs::SOUTH) && localLoc.GetY() >= P::TILE_WIDTH - r2)
+      {
+        dirs = Dirs::AddDirToMask(dirs, Dirs::SOUTHEAST);
+        dirs = Dirs::AddDirToMask(dirs, Dirs::SOUTH);
+      }
+    }
+    else if(IsConnected(Dirs::NORTH) && localLoc.GetY() < r2)
+    {
+      dirs = Dirs::AddDirToMask(dirs, Dirs::NORTH);
+    }
+    else if(IsConnected(Dirs::SOUTH) && localLoc.GetY() >= P::TILE_WIDTH - r2)
+    {
+      dirs = Dirs::AddDirToMask(dirs, Dirs::SOUTH);
+    }
 
-    const s32 r2 = R * 2;
-    ewCenter = m_executingWindow.GetCenterInTile();
+    /* Corners may be absent even when both of their faces exist */
+    for (Dir dir = Dirs::NORTHEAST; dir < Dirs::DIR_COUNT; dir += 2)
+    {
+      if (Dirs::TestDirInMask(dirs, dir) && !IsConnected(dir))
+      {
+        dirs = Dirs::RemoveDirInMask(dirs, dir);
+      }
+    }
+    return dirs;
+  }
 
-    for(u32 i = 0; i < m_executingWindow.GetAtomCount(); i++)
+  template <class CC>
+  void Tile<CC>::SendAtomUpdates(Dir neighbor, const SPoint * locs, const u32 * siteDirs, u32 count)
+  {
+    struct
     {
-      MDist<R>::get().FillFromBits(localLoc, i, R);
-      localLoc.Add(ewCenter);
+      Packet<T> m_header;
+      PacketUpdate<T> m_updates[EVENT_WINDOW_SITES(R)];
+    } batch = { Packet<T>(PACKET_UPDATE, m_generation) };
 
-      /* Send to West neighbor? */
-      if(IsConnected(Dirs::WEST) && localLoc.GetX() < r2)
+    u32 updates = 0;
+    for (u32 i = 0; i < count; ++i)
+    {
+      if (Dirs::TestDirInMask(siteDirs[i], neighbor))
       {
-        SendAtom(Dirs::WEST, localLoc);
-        dirBitfield = Dirs::AddDirToMask(dirBitfield, Dirs::WEST);
-        if(IsConnected(Dirs::NORTH) && localLoc.GetY() < r2)
-        {
-          SendAtom(Dirs::NORTHWEST, localLoc);
-          SendAtom(Dirs::NORTH, localLoc);
-          dirBitfield = Dirs::AddDirToMask(dirBitfield, Dirs::NORTHWEST);
-          dirBitfield = Dirs::AddDirToMask(dirBitfield, Dirs::NORTH);
-        }
-        else if(IsConnected(Dirs::SOUTH) && localLoc.GetY() >= P::TILE_WIDTH - r2)
-        {
-          SendAtom(Dirs::SOUTHWEST, localLoc);
-          SendAtom(Dirs::SOUTH, localLoc);
-          dirBitfield = Dirs::AddDirToMask(dirBitfield, Dirs::SOUTHWEST);
-          dirBitfield = Dirs::AddDirToMask(dirBitfield, Dirs::SOUTH);
-        }
+        PacketUpdate<T> & update = batch.m_updates[updates++];
+        update.SetLocation(GetNeighborLoc(neighbor, locs[i]));
+        update.SetAtom(*GetAtom(locs[i]));
       }
-      /*East neighbor?*/
-      else if(IsConnected(Dirs::EAST) && localLoc.GetX() >= P::TILE_WIDTH - r2)
+    }
+
+    batch.m_header.SetReceivingNeighbor(neighbor);
+    batch.m_header.SetUpdateCount(updates);
+
+    /* Send out the header and all its records in one write */
+    m_connections[neighbor]->Write(!IS_OWNED_CONNECTION(neighbor),
+                                   (u8*)&batch,
+                                   (u32) ((u8*) &batch.m_updates[updates] - (u8*) &batch));
+  }
+
+  template <class CC>
+  u32 Tile<CC>::SendRelevantAtoms()
+  {
+    const u32 dirtySites = m_executingWindow.GetDirtySiteCount();
+    const SPoint & ewCenter = m_executingWindow.GetCenterInTile();
+
+    SPoint locs[EVENT_WINDOW_SITES(R)];
+    u32 siteDirs[EVENT_WINDOW_SITES(R)];
+    u32 dirBitfield = 0;
+
+    for(u32 i = 0; i < dirtySites; i++)
+    {
+      MDist<R>::get().FillFromBits(locs[i], m_executingWindow.GetDirtySite(i), R);
+      locs[i].Add(ewCenter);
+
+      siteDirs[i] = GetRelevantNeighbors(locs[i]);
+      if (siteDirs[i] == 0)
       {
-        SendAtom(Dirs::EAST, localLoc);
-        dirBitfield = Dirs::AddDirToMask(dirBitfield, Dirs::EAST);
-        if(IsConnected(Dirs::NORTH) && localLoc.GetY() < r2)
-        {
-          SendAtom(Dirs::NORTHEAST, localLoc);
-          SendAtom(Dirs::NORTH, localLoc);
-          dirBitfield = Dirs::AddDirToMask(dirBitfield, Dirs::NORTHEAST);
-          dirBitfield = Dirs::AddDirToMask(dirBitfield, Dirs::NORTH);
-        }
-        if(IsConnected(Dirs::SOUTH) && localLoc.GetY() >= P::TILE_WIDTH - r2)
-        {
-          SendAtom(Dirs::SOUTHEAST, localLoc);
-          SendAtom(Dirs::SOUTH, localLoc);
-          dirBitfield = Dirs::AddDirToMask(dirBitfield, Dirs::SOUTHEAST);
-          dirBitfield = Dirs::AddDirToMask(dirBitfield, Dirs::SOUTH);
-        }
+        continue;
       }
-      else if(IsConnected(Dirs::NORTH) && localLoc.GetY() < r2)
+
+      /* Did this atom get corrupted? Destroy it! */
+      if(!GetAtom(locs[i])->IsSane())
       {
-        SendAtom(Dirs::NORTH, localLoc);
-        dirBitfield = Dirs::AddDirToMask(dirBitfield, Dirs::NORTH);
+        PlaceAtom(Element_Empty<CC>::THE_INSTANCE.GetDefaultAtom(), locs[i]);
       }
-      else if(IsConnected(Dirs::SOUTH) && localLoc.GetY() >= P::TILE_WIDTH - r2)
+
+      dirBitfield |= siteDirs[i];
+    }
+
+    for (Dir dir = Dirs::NORTH; dir < Dirs::DIR_COUNT; ++dir)
+    {
+      if (Dirs::TestDirInMask(dirBitfield, dir))
       {
-        SendAtom(Dirs::SOUTH, localLoc);
-        dirBitfield = Dirs::AddDirToMask(dirBitfield, Dirs::SOUTH);
+        SendAtomUpdates(dir, locs, siteDirs, dirtySites);
       }
     }
     return dirBitfield;
@@ -583,14 +908,29 @@ namespace MFM
   template <class CC>
   bool Tile<CC>::TryLock(Dir connectionDir)
   {
-    assert(!m_iLocked[connectionDir]);
-
     if (!IsConnected(connectionDir))
     {
       return true;
     }
+    if (m_iLocked[connectionDir])
+    {
+      /* Still held for events awaiting acknowledgment; usable
+         unless that would put too many events in flight. */
+      assert(Dirs::TestDirInMask(GetPendingLockMask(), connectionDir));
+      if (m_outstandingAcks[connectionDir] < EVENT_ACK_WINDOW)
+      {
+        return true;
+      }
+#ifdef MFM_INSTRUMENT
+      ++m_profile.m_lockWindowFull[connectionDir];
+#endif
+      return false;
+    }
     if (!m_connections[connectionDir]->Lock())
     {
+#ifdef MFM_INSTRUMENT
+      ++m_profile.m_lockBusy[connectionDir];
+#endif
       return false;
     }
     m_iLocked[connectionDir] = true;
@@ -683,11 +1023,11 @@ namespace MFM
     const u32 MILLION = 1000000;
     if ((m_lockAttempts % (1*MILLION)) == 0)
     {
-      LOG.Debug("Locks %dM of %dM (%d%%) for %s",
-                (u32) (m_lockAttemptsSucceeded / MILLION),
-                (u32) (m_lockAttempts / MILLION),
-                (u32) (100 * m_lockAttemptsSucceeded / m_lockAttempts),
-                this->GetLabel());
+      MFM_LOG_DBG("Locks %dM of %dM (%d%%) for %s",
+                  (u32) (m_lockAttemptsSucceeded / MILLION),
+                  (u32) (m_lockAttempts / MILLION),
+                  (u32) (100 * m_lockAttemptsSucceeded / m_lockAttempts),
+                  this->GetLabel());
     }
     return success;
   }
@@ -706,7 +1046,7 @@ namespace MFM
   template <class CC>
   void Tile<CC>::UnlockDir(Dir dir)
   {
-    if (IsConnected(dir))
+    if (IsConnected(dir) && !Dirs::TestDirInMask(GetPendingLockMask(), dir))
     {
       assert(m_iLocked[dir]);
 
@@ -804,6 +1144,12 @@ namespace MFM
             Packet<T> buffer((PacketType) 0xff, 0xff);  // Deliberately invalid initialization
             m_connections[dir]->PeekRead(false, (u8*) &buffer, i, sizeof(Packet<T>));
 
+            if (buffer.GetType() == PACKET_UPDATE)
+            {
+              // Skip over the records that follow an update header
+              i += buffer.GetUpdateCount() * sizeof(PacketUpdate<T>);
+            }
+
             PacketSerializer<CC> serializer(buffer);
 
             LOG.Warning(" %3d%s%04x: %@",
@@ -826,14 +1172,17 @@ namespace MFM
 
 
   template <class CC>
-  bool Tile<CC>::FlushAndWaitOnAllBuffers(u32 dirWaitWord)
+  bool Tile<CC>::FlushAndWaitOnAllBuffers(u32 maxOutstanding)
   {
+#ifdef MFM_INSTRUMENT
+    u64 startTime = ProfileClock::Now();
+#endif
     Packet<T> readPack(PACKET_WRITE, m_generation);
     u32 readBytes;
     u32 locksStillHeld = 0;
     u32 loops = 0;
-    s32 sleepTimer = m_random.Create(10000);
-    do
+    s32 sleepTimer = m_backoffRandom.Create(10000);
+    while (true)
     {
       locksStillHeld = 0; // Assume this
 
@@ -843,11 +1192,19 @@ namespace MFM
         if(IsConnected(dir))
         {
 
-          if (m_iLocked[dir] || m_connections[dir]->IsLockedByAnother())
+          if (m_iLocked[dir] || m_connections[dir]->IsLocked())
           {
             ++locksStillHeld;
           }
 
+#ifdef MFM_INSTRUMENT
+          u32 waiting = m_connections[dir]->ReadableByteCount(!IS_OWNED_CONNECTION(dir));
+          if (waiting > m_profile.m_inputHighWater[dir])
+          {
+            m_profile.m_inputHighWater[dir] = waiting;
+          }
+#endif
+
           while((readBytes = m_connections[dir]->Read(!IS_OWNED_CONNECTION(dir),
                                                       (u8*)&readPack, sizeof(Packet<T>))))
           {
@@ -855,28 +1212,34 @@ namespace MFM
             {
               FAIL(ILLEGAL_STATE);  /* Didn't read enough for a full packet! */
             }
-            if(dirWaitWord & (1 << dir))
+            switch(readPack.GetType())
             {
-              if(readPack.GetType() == PACKET_EVENT_ACKNOWLEDGE)
-              {
-                dirWaitWord &= (~(1 << dir));
-              }
-              else
-              {
-                FAIL(ILLEGAL_STATE);  /* Didn't get an acknowledgment right away */
-              }
+            case PACKET_UPDATE:
+              ReceiveUpdatePacket(dir, readPack);
+              break;
+            case PACKET_EVENT_ACKNOWLEDGE:
+              ReceiveAcknowledgmentPacket(dir, readPack);
+              break;
+            default:
+              ReceivePacket(readPack);
+              break;
             }
-            ReceivePacket(readPack);
           }
 
         }
         /* Have we waited long enough without a response? Let's disconnect that tile. */
 
       }
+
+      if (!HasOutstandingAcks(maxOutstanding))
+      {
+        break;  // Within the window, so no need to wait
+      }
+
       if (++loops >= 1000000)
       {
-        LOG.Error("Tile %s flush looped %d times, but dirWaitWord (0x%x) still not 0, and %d locks held",
-                  this->GetLabel(), loops, dirWaitWord, locksStillHeld);
+        LOG.Error("Tile %s flush looped %d times, but acks still outstanding, and %d locks held",
+                  this->GetLabel(), loops, locksStillHeld);
         FAIL(LOCK_FAILURE);  // Not really, but it's a marker
       }
 
@@ -884,65 +1247,93 @@ namespace MFM
       {
         // Try sleeping every once in a while
         Sleep(0, loops);
-        sleepTimer = m_random.Create(1000);
+        sleepTimer = m_backoffRandom.Create(1000);
       }
       else
       {
         pthread_yield();
       }
+    }
 
-    } while(dirWaitWord);
-
+#ifdef MFM_INSTRUMENT
+    m_profile.m_flushWait.Add(ProfileClock::Now() - startTime);
+#endif
     return locksStillHeld > 0;
   }
 
   template <class CC>
-  void Tile<CC>::DoEvent(bool locked, Dir lockRegion)
+  void Tile<CC>::EraseFailedEvent()
   {
-    u32 dirWaitWord = 0;
-    unwind_protect(
-      {
-        ++m_eventsFailed;
-        ++m_failuresErased;
+    ++m_eventsFailed;
+    ++m_failuresErased;
 
-        if ((m_failuresErased % 100) == 0)
-        {
-          LOG.Debug("%d erasures tile %s", m_failuresErased, this->GetLabel());
-        }
+    if ((m_failuresErased % 100) == 0)
+    {
+      MFM_LOG_DBG("%d erasures tile %s", m_failuresErased, this->GetLabel());
+    }
 
-        if(!m_executingWindow.GetCenterAtom().IsSane())
-        {
-          LOG.Debug("FE(INSANE)");
-        }
-        else
-        {
-          LOG.Debug("FE(%x) (SANE)",m_executingWindow.GetCenterAtom().GetType());
-        }
+    if(!m_executingWindow.GetCenterAtom().IsSane())
+    {
+      MFM_LOG_DBG_LIMITED(m_eventLog)("FE(INSANE)");
+    }
+    else
+    {
+      MFM_LOG_DBG_LIMITED(m_eventLog)("FE(%x) (SANE)",m_executingWindow.GetCenterAtom().GetType());
+    }
 
+#ifdef MFM_EVENT_ROLLBACK
+    m_executingWindow.RollBack();
+#endif
+    m_executingWindow.SetCenterAtom(Element_Empty<CC>::THE_INSTANCE.GetDefaultAtom());
+  }
 
-        m_executingWindow.SetCenterAtom(Element_Empty<CC>::THE_INSTANCE.GetDefaultAtom());
+  template <class CC>
+  void Tile<CC>::DoEvent(bool locked, Dir lockRegion, const Element<CC> * expected)
+  {
+#ifdef MFM_INSTRUMENT
+    u64 startTime = ProfileClock::Now();
+    s32 elementIndex = elementTable.GetIndex(m_executingWindow.GetCenterAtom().GetType());
+#endif
+    unwind_protect(
+      {
+        EraseFailedEvent();
       },
       {
-        elementTable.Execute(m_executingWindow);
+        elementTable.Execute(m_executingWindow, expected);
       });
 
     // XXX INSANE SLOWDOWN FOR DEBUG: AssertValidAtomCounts();
 
     m_lastExecutedAtom = m_executingWindow.GetCenterInTile();
 
-    dirWaitWord = SendRelevantAtoms();
-
-    SendEndEventPackets(dirWaitWord);
-
-    FlushAndWaitOnAllBuffers(dirWaitWord);
+    u32 sentMask = SendRelevantAtoms();
+    SendEndEventPackets(sentMask);
+    if (sentMask != 0)
+    {
+      AddPendingEvent(sentMask, locked ? GetRegionLockMask(lockRegion) : 0);
+    }
 
+    TileRegion region = RegionIn(m_executingWindow.GetCenterInTile());
+#ifdef MFM_INSTRUMENT
+    u64 eventTime = ProfileClock::Now() - startTime;
+    m_profile.m_regionEventTime[region].Add(eventTime);
+    if (elementIndex >= 0)
+    {
+      m_profile.m_elementEventTime[elementIndex].Add(eventTime);
+    }
+#endif
 
     ++m_eventsExecuted;
-    ++m_regionEvents[RegionIn(m_executingWindow.GetCenterInTile())];
+    ++m_regionEvents[region];
 
     ++m_siteEvents[m_executingWindow.GetCenterInTile().GetX() - R]
                   [m_executingWindow.GetCenterInTile().GetY() - R];
 
+    if ((m_eventsExecuted & (STATS_PUBLISH_EVENTS - 1)) == 0)
+    {
+      PublishStats();
+    }
+
     if(locked)
     {
       UnlockRegion(lockRegion);
@@ -951,15 +1342,20 @@ namespace MFM
       {
       case Dirs::NORTH: case Dirs::SOUTH:
       case Dirs::EAST:  case Dirs::WEST:
-        ++m_regionEvents[LOCKTYPE_SINGLE]; break;
+        ++m_lockEvents[LOCKTYPE_SINGLE]; break;
       default: /* UnlockRegion would have caught a bad argument. */
-        ++m_regionEvents[LOCKTYPE_TRIPLE]; break;
+        ++m_lockEvents[LOCKTYPE_TRIPLE]; break;
       }
     }
     else
     {
-      ++m_regionEvents[LOCKTYPE_NONE];
+      ++m_lockEvents[LOCKTYPE_NONE];
     }
+
+    /* Don't wait for this event's acknowledgments -- the locks they
+       guard stay held until they arrive, and TryLock won't reuse a
+       lock whose window is full. */
+    FlushAndWaitOnAllBuffers(EVENT_ACK_WINDOW);
   }
 
   template <class CC>
@@ -967,64 +1363,343 @@ namespace MFM
   {
     while(m_threadInitialized)
     {
-      RecountAtomsIfNeeded();
+      ExecuteStep(m_threadPauser.GetStateBlockingInner());
+    }
+  }
+
+  template <class CC>
+  bool Tile<CC>::ExecuteQuantum(u32 maxSteps)
+  {
+    /* Whichever worker thread runs us, FAILs here are ours */
+    MFMPtrToErrEnvStackPtr = &m_errorEnvironmentStackTop;
 
-      switch (m_threadPauser.GetStateBlockingInner())
+    for(u32 i = 0; i < maxSteps; ++i)
+    {
+      ThreadState state = m_threadPauser.GetStateNonblocking();
+      if (state == THREADSTATE_PAUSED || state == THREADSTATE_RUN_READY)
       {
-      case THREADSTATE_RUN_REQUESTED:
-        m_threadPauser.AdvanceStateInner();
-        break;
+        // Nothing for us to do until the grid moves us along
+        return i > 0;
+      }
 
-      case THREADSTATE_RUN_READY:
-        // The pauser should be blocking us whenever this is true!
-        assert(false);
+      ExecuteStep(state);
+
+      if (state != THREADSTATE_RUNNING)
+      {
+        // Transitions need only one step per quantum
         break;
+      }
+    }
+    return true;
+  }
 
-      case THREADSTATE_RUNNING:
-        if (m_executeOwnEvents)
-        {
-          // It's showtime!
-          bool locked = false;
-          Dir lockRegion = Dirs::NORTH;
+  template <class CC>
+  void Tile<CC>::ExecuteStep(ThreadState state)
+  {
+    RecountAtomsIfNeeded();
 
-          CreateRandomWindow();
+    switch (state)
+    {
+    case THREADSTATE_RUN_REQUESTED:
+      m_threadPauser.AdvanceStateInner();
+      break;
 
-          if (IsInHidden(m_executingWindow.GetCenterInTile()) ||
-              !HasAnyConnections(lockRegion = VisibleAt(m_executingWindow.GetCenterInTile())) ||
-              (locked = LockRegion(lockRegion)))
-          {
-            DoEvent(locked, lockRegion);
-          }
+    case THREADSTATE_RUN_READY:
+      // The pauser should be blocking us whenever this is true!
+      assert(false);
+      break;
+
+    case THREADSTATE_RUNNING:
+      if (m_eventSchedule == SCHEDULE_DETERMINISTIC)
+      {
+        ExecuteDeterministicStep();
+      }
+      else if (m_eventSchedule == SCHEDULE_CHECKERBOARD)
+      {
+        ExecuteCheckerboardStep();
+      }
+      else if (m_eventSchedule == SCHEDULE_BATCHED && m_executeOwnEvents)
+      {
+        ExecuteBatchedStep();
+      }
+      else if (m_executeOwnEvents)
+      {
+        // It's showtime!
+        bool locked = false;
+        Dir lockRegion = Dirs::NORTH;
+
+        CreateRandomWindow();
+
+        if (IsInHidden(m_executingWindow.GetCenterInTile()) ||
+            !HasAnyConnections(lockRegion = VisibleAt(m_executingWindow.GetCenterInTile())) ||
+            (locked = LockRegion(lockRegion)))
+        {
+          DoEvent(locked, lockRegion);
         }
         else
         {
-          FlushAndWaitOnAllBuffers(0);
+          // Couldn't lock; maybe there's news from the lock holder
+          FlushAndWaitOnAllBuffers(EVENT_ACK_WINDOW);
         }
-        break;
+      }
+      else
+      {
+        FlushAndWaitOnAllBuffers(EVENT_ACK_WINDOW);
+      }
+      break;
 
-      case THREADSTATE_PAUSE_REQUESTED:
-        // Confirm we are done with our event (including processing
-        // any needed inbound ACKs, and freeing connection locks) by
-        // advancing to pause ready.
+    case THREADSTATE_PAUSE_REQUESTED:
+      // Finish our events (including processing all outstanding
+      // inbound ACKs, which frees our connection locks), then
+      // confirm that by advancing to pause ready.  We don't wait
+      // here for the ACKs, since whoever owes them to us may need
+      // this thread to run.
+      FlushAndWaitOnAllBuffers(EVENT_ACK_WINDOW);
+      if (!HasOutstandingAcks(0))
+      {
+        PublishStats();  // So whoever paused us sees it all
         m_threadPauser.AdvanceStateInner();
-        break;
+      }
+      break;
+
+    case THREADSTATE_PAUSE_READY:
+      if (FlushAndWaitOnAllBuffers(0))   // Mop up if necessary
+      {
+        pthread_yield();                 // And try to hurry others
+      }
+      break;
+
+    case THREADSTATE_PAUSED:
+      // The pauser should be blocking us whenever this is true!
+      assert(false);
+      break;
+
+    default:
+      assert(false);
+    }
+  }
+
+  template <class CC>
+  void Tile<CC>::ExecuteDeterministicStep()
+  {
+    u32 phase = m_phaseClock->GetPhase();
+    if (m_phaseArrived)
+    {
+      if (phase == m_phase)
+      {
+        // Others are still at it; keep their packets moving
+        FlushAndWaitOnAllBuffers(EVENT_ACK_WINDOW);
+        return;
+      }
+      m_phase = phase;
+      m_phaseArrived = false;
+    }
+
+    if (!m_phaseClock->MayBegin(m_phase))
+    {
+      FlushAndWaitOnAllBuffers(EVENT_ACK_WINDOW);
+      return;
+    }
+
+    u32 step = m_phase % DETERMINISTIC_PHASES_PER_ROUND;
+    if (step == 0)
+    {
+      // Interior phase: every tile at once, since none of these
+      // events can see, or be seen by, a neighbor's events
+      if (m_executeOwnEvents && m_roundDraws < DETERMINISTIC_EVENTS_PER_ROUND)
+      {
+        ++m_roundDraws;
+        CreateRandomWindow();
 
-      case THREADSTATE_PAUSE_READY:
-        if (FlushAndWaitOnAllBuffers(0))   // Mop up if necessary
+        const SPoint & center = m_executingWindow.GetCenterInTile();
+        if (IsInHidden(center) || !HasAnyConnections(VisibleAt(center)))
         {
-          pthread_yield();                 // And try to hurry others
+          DoEvent(false, Dirs::NORTH);
         }
-        break;
+        else
+        {
+          m_deferredSites[m_deferredCount++] = center;
+        }
+        return;
+      }
+    }
+    else if (step - 1 == m_phaseColor && m_deferredNext < m_deferredCount)
+    {
+      // Our boundary phase: no neighbor is executing events, so
+      // locking fails only when too many of ours are unacknowledged,
+      // and then we retry the same site.
+      m_executingWindow.SetCenterInTile(m_deferredSites[m_deferredNext]);
 
-      case THREADSTATE_PAUSED:
-        // The pauser should be blocking us whenever this is true!
-        assert(false);
-        break;
+      Dir lockRegion = VisibleAt(m_executingWindow.GetCenterInTile());
+      if (LockRegion(lockRegion))
+      {
+        ++m_deferredNext;
+        DoEvent(true, lockRegion);
+      }
+      else
+      {
+        FlushAndWaitOnAllBuffers(EVENT_ACK_WINDOW);
+      }
+      return;
+    }
 
-      default:
-        assert(false);
+    // Our part of this phase is done once our neighbors have applied
+    // all our updates
+    FlushAndWaitOnAllBuffers(EVENT_ACK_WINDOW);
+    if (HasOutstandingAcks(0))
+    {
+      return;
+    }
+
+    if (step == DETERMINISTIC_PHASES_PER_ROUND - 1)
+    {
+      m_roundDraws = 0;
+      m_deferredCount = 0;
+      m_deferredNext = 0;
+    }
+    m_phaseArrived = true;
+    m_phaseClock->Arrive(m_phase);
+  }
+
+  template <class CC>
+  void Tile<CC>::ExecuteBatchedStep()
+  {
+    /* Draw every window center up front, as CreateRandomWindow
+       would, avoiding the cache */
+    const u32 maxval = TILE_WIDTH - (EVENT_WINDOW_RADIUS << 1);
+    u32 coords[2 * BATCHED_EVENTS];
+    m_random.Fill(coords, 2 * BATCHED_EVENTS, maxval);
+
+    u32 count = 0;
+    for(u32 i = 0; i < BATCHED_EVENTS; ++i)
+    {
+      m_executingWindow.SetCenterInTile(SPoint(coords[2 * i] + EVENT_WINDOW_RADIUS,
+                                               coords[2 * i + 1] + EVENT_WINDOW_RADIUS));
+
+      const SPoint & center = m_executingWindow.GetCenterInTile();
+      Dir lockRegion = Dirs::NORTH;
+      if (IsInHidden(center) || !HasAnyConnections(lockRegion = VisibleAt(center)))
+      {
+        // Insertion sort by type, keeping draw order within a type
+        const T & atom = m_executingWindow.GetCenterAtom();
+        u32 type = atom.IsSane() ? atom.GetType() : Element_Empty<CC>::THE_INSTANCE.GetType();
+        u32 j = count++;
+        for(; j > 0 && m_batchTypes[j - 1] > type; --j)
+        {
+          m_batchSites[j] = m_batchSites[j - 1];
+          m_batchTypes[j] = m_batchTypes[j - 1];
+        }
+        m_batchSites[j] = center;
+        m_batchTypes[j] = type;
+      }
+      else if (LockRegion(lockRegion))
+      {
+        DoEvent(true, lockRegion);
+      }
+      else
+      {
+        // Couldn't lock; maybe there's news from the lock holder
+        FlushAndWaitOnAllBuffers(EVENT_ACK_WINDOW);
+      }
+    }
+
+    const u32 emptyType = Element_Empty<CC>::THE_INSTANCE.GetType();
+    for(u32 i = 0; i < count; )
+    {
+      const u32 type = m_batchTypes[i];
+      const Element<CC> * elt = type == emptyType ? 0 : elementTable.Lookup(type);
+      do
+      {
+        /* Earlier events in the batch may have changed this site;
+           DoEvent checks the type again before trusting elt. */
+        m_executingWindow.SetCenterInTile(m_batchSites[i]);
+        DoEvent(false, Dirs::NORTH, elt);
+      } while (++i < count && m_batchTypes[i] == type);
+    }
+  }
+
+  template <class CC>
+  bool Tile<CC>::HasAckRoom(u32 dirMask) const
+  {
+    for(Dir dir = Dirs::NORTH; dir < Dirs::DIR_COUNT; ++dir)
+    {
+      if (Dirs::TestDirInMask(dirMask, dir) && IsConnected(dir) &&
+          m_outstandingAcks[dir] >= EVENT_ACK_WINDOW)
+      {
+        return false;
       }
     }
+    return true;
+  }
+
+  template <class CC>
+  void Tile<CC>::ExecuteCheckerboardStep()
+  {
+    u32 phase = m_phaseClock->GetPhase();
+    if (phase != m_phase)
+    {
+      m_phase = phase;
+      m_phaseArrived = false;
+    }
+
+    if (!m_phaseArrived)
+    {
+      if (m_phase % CHECKERBOARD_COLORS != m_phaseColor)
+      {
+        // Not our phase; we owe the others nothing
+        m_phaseArrived = true;
+        m_phaseClock->Arrive(m_phase);
+      }
+      else if (m_deferredNext < m_deferredCount)
+      {
+        // Our phase: our neighbors are executing only events that
+        // cannot touch this one, so it needs no locks
+        m_executingWindow.SetCenterInTile(m_deferredSites[m_deferredNext]);
+
+        Dir region = VisibleAt(m_executingWindow.GetCenterInTile());
+        if (HasAckRoom(GetRegionLockMask(region)))
+        {
+          ++m_deferredNext;
+          DoEvent(false, region);
+        }
+        else
+        {
+          FlushAndWaitOnAllBuffers(EVENT_ACK_WINDOW);
+        }
+        return;
+      }
+      else
+      {
+        // Done once our neighbors have applied all our updates
+        FlushAndWaitOnAllBuffers(EVENT_ACK_WINDOW);
+        if (HasOutstandingAcks(0))
+        {
+          return;
+        }
+        m_deferredCount = 0;
+        m_deferredNext = 0;
+        m_phaseArrived = true;
+        m_phaseClock->Arrive(m_phase);
+      }
+    }
+
+    if (!m_executeOwnEvents || m_deferredCount >= DETERMINISTIC_EVENTS_PER_ROUND)
+    {
+      FlushAndWaitOnAllBuffers(EVENT_ACK_WINDOW);
+      return;
+    }
+
+    CreateRandomWindow();
+
+    const SPoint & center = m_executingWindow.GetCenterInTile();
+    if (IsInHidden(center) || !HasAnyConnections(VisibleAt(center)))
+    {
+      DoEvent(false, Dirs::NORTH);
+    }
+    else
+    {
+      m_deferredSites[m_deferredCount++] = center;
+    }
   }
 
   template <class CC>
@@ -1047,6 +1722,103 @@ namespace MFM
     return m_atomCount[idx];
   }
 
+  template <class CC>
+  u32 Tile<CC>::GetPublishedAtomCount(ElementType atomType) const
+  {
+    s32 idx = elementTable.GetIndex(atomType);
+    if (idx < 0)
+    {
+      return 0;
+    }
+    return ReadPublished(m_publishedStats.m_atomCount[idx]);
+  }
+
+  template <class CC>
+  void Tile<CC>::PublishStats()
+  {
+    Stats & stats = m_publishedStats;
+    m_statsLock.BeginWrite();
+
+    stats.m_eventsExecuted = m_eventsExecuted;
+    stats.m_eventsFailed = m_eventsFailed;
+    stats.m_failuresErased = m_failuresErased;
+    for (u32 i = 0; i < REGION_COUNT; ++i)
+    {
+      stats.m_regionEvents[i] = m_regionEvents[i];
+    }
+    for (u32 i = 0; i < LOCKTYPE_COUNT; ++i)
+    {
+      stats.m_lockEvents[i] = m_lockEvents[i];
+    }
+    stats.m_lockAttempts = m_lockAttempts;
+    stats.m_lockAttemptsSucceeded = m_lockAttemptsSucceeded;
+    memcpy(stats.m_siteEvents, m_siteEvents, sizeof(m_siteEvents));
+    memcpy(stats.m_atomCount, m_atomCount, sizeof(m_atomCount));
+    stats.m_illegalAtomCount = m_illegalAtomCount;
+    memcpy(stats.m_elementData, elementTable.GetAllElementData(),
+           sizeof(stats.m_elementData));
+
+    m_statsLock.EndWrite();
+  }
+
+  template <class CC>
+  void Tile<CC>::GetStats(Stats & stats) const
+  {
+    u32 seq;
+    do
+    {
+      seq = m_statsLock.BeginRead();
+      memcpy(&stats, &m_publishedStats, sizeof(stats));
+    } while (m_statsLock.ShouldRetryRead(seq));
+  }
+
+  template <class CC>
+  void Tile<CC>::Profile::Clear()
+  {
+    for (u32 i = 0; i < Dirs::DIR_COUNT; ++i)
+    {
+      m_lockBusy[i] = m_lockWindowFull[i] = 0;
+      m_inputHighWater[i] = 0;
+    }
+    m_pendingEventsHighWater = 0;
+    m_flushWait.Clear();
+    for (u32 i = 0; i < REGION_COUNT; ++i)
+    {
+      m_regionEventTime[i].Clear();
+    }
+    for (u32 i = 0; i < ELEMENT_TABLE_SIZE; ++i)
+    {
+      m_elementEventTime[i].Clear();
+    }
+  }
+
+  template <class CC>
+  void Tile<CC>::Profile::Add(const Profile & other)
+  {
+    for (u32 i = 0; i < Dirs::DIR_COUNT; ++i)
+    {
+      m_lockBusy[i] += other.m_lockBusy[i];
+      m_lockWindowFull[i] += other.m_lockWindowFull[i];
+      if (other.m_inputHighWater[i] > m_inputHighWater[i])
+      {
+        m_inputHighWater[i] = other.m_inputHighWater[i];
+      }
+    }
+    if (other.m_pendingEventsHighWater > m_pendingEventsHighWater)
+    {
+      m_pendingEventsHighWater = other.m_pendingEventsHighWater;
+    }
+    m_flushWait.Add(other.m_flushWait);
+    for (u32 i = 0; i < REGION_COUNT; ++i)
+    {
+      m_regionEventTime[i].Add(other.m_regionEventTime[i]);
+    }
+    for (u32 i = 0; i < ELEMENT_TABLE_SIZE; ++i)
+    {
+      m_elementEventTime[i].Add(other.m_elementEventTime[i]);
+    }
+  }
+
   template <class CC>
   void Tile<CC>::SetAtomCount(ElementType atomType, s32 count)
   {
@@ -1070,11 +1842,14 @@ namespace MFM
       // Possible xrays before start means we can't assert even here
       //      AssertValidAtomCounts();
       RecountAtoms();
+      m_backoffRandom.SetSeed(m_random.Create());
       m_threadInitialized = true;
-      if (pthread_create(&m_thread, NULL, ExecuteThreadHelper, this))
+      if (!m_threadless &&
+          pthread_create(&m_thread, NULL, ExecuteThreadHelper, this))
         FAIL(ILLEGAL_STATE);
     }
 
+    PublishStats();  // Catch up with any changes made while paused
     m_threadPauser.RequestRun();
   }
 
@@ -1185,10 +1960,12 @@ namespace MFM
     for (u32 r = 0; r < Dirs::DIR_COUNT; ++r)
     {
       const char * lab = Dirs::GetName(r);
-      LOG.Log(level,"    %s from %s: %s",
+      LOG.Log(level,"    %s from %s: %s, %d acks outstanding",
               lab, m_label.GetZString(),
-              m_iLocked[r]?"LOCKED":"unlocked");
+              m_iLocked[r]?"LOCKED":"unlocked",
+              m_outstandingAcks[r]);
     }
+    LOG.Log(level,"   Pending events: %d", m_pendingEventCount);
     LOG.Log(level,"   -Connection details-");
     for (u32 r = 0; r < Dirs::DIR_COUNT; ++r)
     {
@@ -1212,6 +1989,7 @@ namespace MFM
   void Tile<CC>::AssertValidAtomCounts() const
   {
     s32 counts[ELEMENT_TABLE_SIZE];
+    s32 illegal = 0;
     for (u32 i = 0; i < ELEMENT_TABLE_SIZE; ++i)
     {
       counts[i] = 0;
@@ -1231,7 +2009,8 @@ namespace MFM
         s32 type = elementTable.GetIndex(atom->GetType());
         if (type < 0)
         {
-          FAIL(UNKNOWN_ELEMENT);
+          ++illegal;
+          continue;
         }
         counts[type]++;
       }
@@ -1243,6 +2022,10 @@ namespace MFM
         FAIL(ILLEGAL_STATE);
       }
     }
+    if (illegal != m_illegalAtomCount)
+    {
+      FAIL(ILLEGAL_STATE);
+    }
   }
 
   template <class CC>
@@ -1292,20 +2075,60 @@ namespace MFM
   template <class CC>
   void Tile<CC>::SingleXRay(u32 x, u32 y)
   {
-    m_atoms[x][y].XRay(m_random, BACKGROUND_RADIATION_BIT_ODDS);
+    T & atom = m_atoms[x][y];
+    u32 oldType = atom.GetType();
+    atom.XRay(m_random, BACKGROUND_RADIATION_BIT_ODDS);
+    CountTypeChange(SPoint(x, y), oldType, atom.GetType());
   }
 
   template <class CC>
   void Tile<CC>::XRay(u32 siteOdds, u32 bitOdds)
   {
-    for(u32 x = 0; x < W; x++)
+    const u32 sites = W * W;
+    for(u32 i = m_random.CreateGeometric(siteOdds); i < sites;
+        i += m_random.CreateGeometric(siteOdds) + 1)
     {
-      for(u32 y = 0; y < W; y++)
+      T & atom = m_atoms[i / W][i % W];
+      u32 oldType = atom.GetType();
+      atom.XRay(m_random, bitOdds);
+      CountTypeChange(SPoint(i / W, i % W), oldType, atom.GetType());
+    }
+  }
+
+  template <class CC>
+  void Tile<CC>::CheckAndRepairRegion(const Rect & region, u32 & repaired, u32 & erased)
+  {
+    Rect clip(region);
+    clip &= Rect(0, 0, TILE_WIDTH, TILE_WIDTH);
+    if (clip.IsEmpty())
+    {
+      return;
+    }
+
+    const u32 x0 = clip.GetX(), x1 = x0 + clip.GetWidth();
+    const u32 y0 = clip.GetY(), y1 = y0 + clip.GetHeight();
+
+    for(u32 x = x0; x < x1; x++)
+    {
+      for(u32 y = y0; y < y1; y++)
       {
-        if(m_random.OneIn(siteOdds))
+        T & atom = m_atoms[x][y];
+        if (atom.IsSane())
+        {
+          continue;
+        }
+
+        u32 oldType = atom.GetType();
+        if (atom.HasBeenRepaired())
+        {
+          ++repaired;
+        }
+        else
         {
-          m_atoms[x][y].XRay(m_random, bitOdds);
+          atom = Element_Empty<CC>::THE_INSTANCE.GetDefaultAtom();
+          ++erased;
         }
+        CountTypeChange(SPoint(x, y), oldType, atom.GetType());
       }
     }
   }
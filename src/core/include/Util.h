@@ -73,6 +73,11 @@ namespace MFM {
     return -1;
   }
 
+  inline static u64 MakeMaskClip64(const u32 length) {
+    if (length<64) return (((u64) 1) << length) - 1;
+    return ~((u64) 0);
+  }
+
   template <class T>
   inline T MAX(T x, T y) {
     return (x > y) ? x : y;
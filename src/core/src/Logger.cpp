@@ -1,6 +1,452 @@
 #include "Logger.h"
+#include "Util.h"   /* For Sleep */
+#include "OverflowableCharBufferByteSink.h"  /* For OString128 */
+#include <time.h>   /* For clock_gettime */
 
 namespace MFM {
 
   Logger LOG(DevNull, Logger::ERROR);
+
+  u32 Logger::s_asyncEpochs = 0;
+
+  Atomic<u32> Logger::s_asyncLoggers(0);
+
+  __thread Logger::LogRing * Logger::s_threadRing = 0;
+
+  __thread u32 Logger::s_threadRingEpoch = 0;
+
+  struct Logger::LogRecord
+  {
+    enum
+    {
+      MAX_ARGS = 8,
+      TEXT_BYTES = 128,
+      MAX_SPEC = 15,     // Longest '%..' conversion we'll replay
+      NULL_TEXT = 0xffff
+    };
+
+    const char * m_format;
+    u8 m_level;
+    u8 m_argCount;
+    u16 m_textUsed;
+
+    /** Integer and pointer arguments as given; for %s and %@, the
+        offset of the argument's text in m_text, or NULL_TEXT */
+    u64 m_args[MAX_ARGS];
+
+    /** Copies of %s arguments, and renderings of %@ arguments.
+        Records whose text won't fit aren't queued. */
+    char m_text[TEXT_BYTES];
+
+    /**
+     * Checks that every conversion in \c format can be captured, and
+     * that there are no more than MAX_ARGS of them.  Anything else,
+     * including bad formats, goes the synchronous route.
+     */
+    static bool CanEncode(const char * format)
+    {
+      u32 args = 0;
+      while (*format)
+      {
+        if (*format++ != '%')
+        {
+          continue;
+        }
+        const char * spec = format;
+        while (*format == '#' || (*format >= '0' && *format <= '9'))
+        {
+          ++format;
+        }
+        if (format - spec >= MAX_SPEC - 1)
+        {
+          return false;
+        }
+        switch (*format++)
+        {
+        case '%':
+          break;
+        case 'c': case 'd': case 'x': case 'b': case 'o': case 't':
+        case 'D': case 'X': case 'H': case 'h': case 'l':
+        case 'q': case 'p': case 's': case '@':
+          if (++args > MAX_ARGS)
+          {
+            return false;
+          }
+          break;
+        default:
+          return false;
+        }
+      }
+      return true;
+    }
+
+    /**
+     * Copies \c zstr into m_text, and sets \c offset to where it
+     * starts.
+     *
+     * @returns \c false if \c zstr wouldn't all fit.
+     */
+    bool SaveText(const char * zstr, u64 & offset)
+    {
+      if (!zstr)
+      {
+        offset = NULL_TEXT;
+        return true;
+      }
+      u16 start = m_textUsed;
+      while (*zstr)
+      {
+        if (m_textUsed >= TEXT_BYTES - 1)
+        {
+          return false;
+        }
+        m_text[m_textUsed++] = *zstr++;
+      }
+      m_text[m_textUsed++] = '\0';
+      offset = start;
+      return true;
+    }
+
+    const char * GetText(u64 offset) const
+    {
+      return offset == NULL_TEXT ? 0 : &m_text[offset];
+    }
+
+    /**
+     * Captures \c format and its arguments, which must have passed
+     * CanEncode.
+     *
+     * @returns \c false if the text of the %s and %@ arguments
+     *          wouldn't fit in m_text, leaving this record unusable.
+     */
+    bool Encode(Level level, const char * format, va_list & ap)
+    {
+      m_format = format;
+      m_level = (u8) level;
+      m_argCount = 0;
+      m_textUsed = 0;
+
+      while (*format)
+      {
+        if (*format++ != '%')
+        {
+          continue;
+        }
+        bool alt = false;
+        while (*format == '#' || (*format >= '0' && *format <= '9'))
+        {
+          alt = alt || *format == '#';
+          ++format;
+        }
+        char conv = *format++;
+        if (conv == '%')
+        {
+          continue;
+        }
+
+        u64 & arg = m_args[m_argCount++];
+        switch (conv)
+        {
+        case 'q':
+          arg = va_arg(ap, u64);
+          break;
+        case 'p':
+          arg = (uptr) va_arg(ap, void *);
+          break;
+        case 's':
+          if (!SaveText(va_arg(ap, const char *), arg))
+          {
+            return false;
+          }
+          break;
+        case '@':
+          {
+            // Can't defer this: render it now
+            s32 argument = alt ? va_arg(ap, s32) : 0;
+            ByteSerializable * bs = va_arg(ap, ByteSerializable *);
+            OString128 text;
+            if (!bs) text.Print("(null)");
+            else text.Print(*bs, argument);
+            if (text.HasOverflowed() || !SaveText(text.GetZString(), arg))
+            {
+              return false;
+            }
+          }
+          break;
+        default:
+          arg = va_arg(ap, u32);
+          break;
+        }
+      }
+      return true;
+    }
+  };
+
+  struct Logger::LogRing
+  {
+    /** Next record the owner will fill */
+    Atomic<u32> m_head;
+
+    /** Next record to be written */
+    Atomic<u32> m_tail;
+
+    LogRecord m_records[RING_RECORDS];
+  };
+
+  Logger::~Logger()
+  {
+    StopAsync();
+    delete [] m_rings;
+  }
+
+  void Logger::StartAsync()
+  {
+    if (m_async.Load())
+    {
+      return;
+    }
+
+    if (s_asyncLoggers.FetchAdd(1, MEMORY_ORDER_ACQ_REL) != 0)
+    {
+      // Each thread has one ring pointer, not one per Logger
+      s_asyncLoggers.FetchSub(1, MEMORY_ORDER_ACQ_REL);
+      FAIL(ILLEGAL_STATE);
+    }
+
+    if (!m_rings)
+    {
+      m_rings = new LogRing[MAX_RINGS];
+    }
+    for (u32 i = 0; i < MAX_RINGS; ++i)
+    {
+      m_rings[i].m_head.Store(0);
+      m_rings[i].m_tail.Store(0);
+    }
+    m_ringsClaimed.Store(0);
+    m_asyncEpoch = ++s_asyncEpochs;
+
+    m_async.Store(true);
+    if (pthread_create(&m_writerThread, NULL, WriterThread, this))
+    {
+      m_async.Store(false);
+      s_asyncLoggers.FetchSub(1, MEMORY_ORDER_ACQ_REL);
+      FAIL(ILLEGAL_STATE);
+    }
+  }
+
+  void Logger::StopAsync()
+  {
+    if (!m_async.Load())
+    {
+      return;
+    }
+    m_async.Store(false);
+    pthread_join(m_writerThread, NULL);
+
+    // Catch anything queued while the writer was finishing up
+    DrainAllRings();
+
+    s_asyncLoggers.FetchSub(1, MEMORY_ORDER_ACQ_REL);
+  }
+
+  void * Logger::WriterThread(void * arg)
+  {
+    Logger & log = *((Logger *) arg);
+    while (log.m_async.Load(MEMORY_ORDER_ACQUIRE))
+    {
+      if (log.DrainAllRings() == 0)
+      {
+        Sleep(0, 1000000);  // Idle; check again in a millisecond
+      }
+    }
+    log.DrainAllRings();
+    return NULL;
+  }
+
+  Logger::LogRing * Logger::GetThreadRing()
+  {
+    if (s_threadRingEpoch != m_asyncEpoch)
+    {
+      u32 index = m_ringsClaimed.FetchAdd(1, MEMORY_ORDER_ACQ_REL);
+      s_threadRing = index < MAX_RINGS ? &m_rings[index] : 0;
+      s_threadRingEpoch = m_asyncEpoch;
+    }
+    return s_threadRing;
+  }
+
+  bool Logger::Enqueue(Level level, const char * format, va_list & ap)
+  {
+    if (!LogRecord::CanEncode(format))
+    {
+      return false;
+    }
+
+    LogRing * ring = GetThreadRing();
+    if (!ring)
+    {
+      return false;
+    }
+
+    u32 head = ring->m_head.Load(MEMORY_ORDER_RELAXED);
+    u32 tail = ring->m_tail.Load(MEMORY_ORDER_ACQUIRE);
+    if (head - tail >= RING_RECORDS)
+    {
+      if (level <= WARNING)
+      {
+        return false;  // Too important to lose; write it ourselves
+      }
+      m_dropped[level].FetchAdd(1, MEMORY_ORDER_RELAXED);
+      return true;
+    }
+
+    // Encode from a copy, so ap is still unused if we give up
+    va_list copy;
+    __builtin_va_copy(copy, ap);
+    bool encoded = ring->m_records[head % RING_RECORDS].Encode(level, format, copy);
+    va_end(copy);
+    if (!encoded)
+    {
+      return false;  // Too much text to queue; write it all ourselves
+    }
+
+    ring->m_head.Store(head + 1, MEMORY_ORDER_RELEASE);
+    return true;
+  }
+
+  u32 Logger::DrainRing(LogRing & ring)
+  {
+    u32 tail = ring.m_tail.Load(MEMORY_ORDER_RELAXED);
+    u32 head = ring.m_head.Load(MEMORY_ORDER_ACQUIRE);
+    u32 written = head - tail;
+    for (; tail != head; ++tail)
+    {
+      WriteRecord(ring.m_records[tail % RING_RECORDS]);
+    }
+    ring.m_tail.Store(tail, MEMORY_ORDER_RELEASE);
+    return written;
+  }
+
+  u32 Logger::DrainAllRings()
+  {
+    Mutex::ScopeLock lock(m_mutex); // Hold lock for this block
+
+    u32 rings = m_ringsClaimed.Load(MEMORY_ORDER_ACQUIRE);
+    if (rings > MAX_RINGS)
+    {
+      rings = MAX_RINGS;
+    }
+
+    u32 written = 0;
+    for (u32 i = 0; i < rings; ++i)
+    {
+      written += DrainRing(m_rings[i]);
+    }
+
+    for (u32 level = MIN; level <= MAX; ++level)
+    {
+      u32 dropped = m_dropped[level].Load(MEMORY_ORDER_RELAXED);
+      if (dropped != m_droppedReported[level])
+      {
+        m_sink->Printf("%@%s: [%d %s records dropped]",
+                       m_timeStamper, StrLevel(WARNING),
+                       dropped - m_droppedReported[level], StrLevel((Level) level));
+        m_sink->Println();
+        m_droppedReported[level] = dropped;
+      }
+    }
+
+    return written;
+  }
+
+  void Logger::WriteRecord(const LogRecord & rec)
+  {
+    m_sink->Printf("%@%s: ", m_timeStamper, StrLevel((Level) rec.m_level));
+
+    // Replay the format as ByteSink::Vprintf would, one conversion
+    // at a time
+    const char * format = rec.m_format;
+    u32 argIndex = 0;
+    u8 p;
+    while ((p = *format++))
+    {
+      if (p != '%')
+      {
+        if (p == '\n')
+          m_sink->Println();
+        else
+          m_sink->Print(p, Format::BYTE);
+        continue;
+      }
+
+      const char * spec = format - 1;
+      while (*format == '#' || (*format >= '0' && *format <= '9'))
+      {
+        ++format;
+      }
+      char conv = *format++;
+      if (conv == '%')
+      {
+        m_sink->Print('%', Format::BYTE);
+        continue;
+      }
+
+      char mini[LogRecord::MAX_SPEC + 1];
+      u32 len = format - spec;
+      for (u32 i = 0; i < len; ++i)
+      {
+        mini[i] = spec[i];
+      }
+      mini[len] = '\0';
+
+      u64 arg = rec.m_args[argIndex++];
+      switch (conv)
+      {
+      case 'q':
+        m_sink->Printf(mini, arg);
+        break;
+      case 'p':
+        m_sink->Printf(mini, (void *) (uptr) arg);
+        break;
+      case 's':
+        m_sink->Printf(mini, rec.GetText(arg));
+        break;
+      case '@':
+        m_sink->Print(rec.GetText(arg));
+        break;
+      default:
+        m_sink->Printf(mini, (u32) arg);
+        break;
+      }
+    }
+    m_sink->Println();
+  }
+
+  bool LogRateLimiter::Allow(Logger::Level level)
+  {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return Allow(level, (u32) now.tv_sec + 1);  // Never 0
+  }
+
+  bool LogRateLimiter::Allow(Logger::Level level, u32 second)
+  {
+    u32 was = m_second.Load(MEMORY_ORDER_RELAXED);
+    if (was != second && m_second.CompareExchange(was, second))
+    {
+      // We're first into the new second
+      m_count.Store(0, MEMORY_ORDER_RELAXED);
+      u32 refused = m_refused.Exchange(0, MEMORY_ORDER_RELAXED);
+      if (refused > 0)
+      {
+        LOG.Log(level, "[%d similar messages suppressed]", refused);
+      }
+    }
+
+    if (m_count.FetchAdd(1, MEMORY_ORDER_RELAXED) < m_perSecond)
+    {
+      return true;
+    }
+    m_refused.FetchAdd(1, MEMORY_ORDER_RELAXED);
+    return false;
+  }
 }
@@ -2,5 +2,103 @@
 
 
 namespace MFM {
+
+#include "MDist_tables.inc"
+
 } /* namespace MFM */
 
+#ifdef WRITE_MDIST_TABLES
+#include <stdio.h>
+#include <stdlib.h>
+// g++ -O -I ../include -I ../../platform-linux/include -DWRITE_MDIST_TABLES MDist.cpp -o MDist.elf;./MDist.elf > MDist_tables.inc;rm -f MDist.elf
+
+namespace MFM {
+
+  static u32 ManhattanLength(s32 x, s32 y) {
+    return (u32) (abs(x) + abs(y));
+  }
+
+  static void WriteMDistTables(FILE * output) {
+    const s32 R = MDistTables::MAX_RADIUS;
+    const s32 D = MDistTables::MAX_DIAMETER;
+
+    /* We store the points in just one table, sorted by their lengths,
+       and remember where the different lengths begin.  This lets us
+       index and select offsets of any given length, or contiguous
+       range of lengths, from zero up to MAX_RADIUS. */
+    s32 points[MDistTables::MAX_SITES][2];
+    u32 pointToIndex[MDistTables::MAX_DIAMETER][MDistTables::MAX_DIAMETER];
+    u32 firstIndex[MDistTables::MAX_RADIUS + 2];
+
+    for (s32 x = 0; x < D; ++x)
+      for (s32 y = 0; y < D; ++y)
+        pointToIndex[x][y] = MDistTables::NO_INDEX;
+
+    u32 next = 0;
+    for (s32 length = 0; length <= R; ++length) {
+      firstIndex[length] = next;
+      for (s32 x = 0; x < D; ++x) {
+        for (s32 y = 0; y < D; ++y) {
+          if (ManhattanLength(x - R, y - R) == (u32) length) {
+            points[next][0] = x - R;
+            points[next][1] = y - R;
+            pointToIndex[x][y] = next;
+            ++next;
+          }
+        }
+      }
+    }
+    firstIndex[R + 1] = next;
+    if (next != MDistTables::MAX_SITES)
+      abort();
+
+    fprintf(output,"%s", "  //// GENERATED TABLES: DO NOT EDIT\n");
+
+    fprintf(output,"%s", "  const s8 MDistTables::indexToPoint[MAX_SITES][2] =\n    {\n");
+    for (u32 i = 0; i < next; ++i) {
+      fprintf(output,"      { %2d, %2d }%s // %2d\n",
+              points[i][0], points[i][1], i == next - 1 ? " " : ",", i);
+    }
+    fprintf(output,"%s", "    };\n");
+
+    fprintf(output,"%s", "  const u8 MDistTables::pointToIndex[MAX_DIAMETER][MAX_DIAMETER] =\n    {\n");
+    for (s32 x = 0; x < D; ++x) {
+      fprintf(output,"%s", "      { ");
+      for (s32 y = 0; y < D; ++y) {
+        fprintf(output,"0x%02x%s", pointToIndex[x][y], y == D - 1 ? "" : ", ");
+      }
+      fprintf(output," }%s // x = %2d\n", x == D - 1 ? " " : ",", x - R);
+    }
+    fprintf(output,"%s", "    };\n");
+
+    fprintf(output,"%s", "  const u8 MDistTables::firstIndex[MAX_RADIUS + 2] =\n    { ");
+    for (s32 length = 0; length <= R + 1; ++length) {
+      fprintf(output,"%d%s", firstIndex[length], length == R + 1 ? "" : ", ");
+    }
+    fprintf(output,"%s", " };\n");
+
+    fprintf(output,"%s", "  const u8 MDistTables::symmetricIndex[PSYM_SYMMETRY_COUNT][MAX_SITES] =\n    {");
+    for (u32 psym = 0; psym < PSYM_SYMMETRY_COUNT; ++psym) {
+      fprintf(output,"%s", "\n      {");
+      for (u32 i = 0; i < next; ++i) {
+        const SPoint in(points[i][0], points[i][1]);
+        const SPoint out = Map(in, (PointSymmetry) psym, in);
+        if (i%16==0)
+          fprintf(output,"\n        ");
+        fprintf(output,"%2d", pointToIndex[out.GetX() + R][out.GetY() + R]);
+        if (i != next - 1)
+          fprintf(output,", ");
+      }
+      fprintf(output,"\n      }%s // psym %d", psym == PSYM_SYMMETRY_COUNT - 1 ? " " : ",", psym);
+    }
+    fprintf(output,"\n    };\n");
+
+    fprintf(output,"%s", "  //// END OF GENERATED TABLES\n");
+  }
+}
+
+int main() {
+  MFM::WriteMDistTables(stdout);
+  return 0;
+}
+#endif
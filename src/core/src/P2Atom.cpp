@@ -80,17 +80,7 @@ namespace MFM {
 
   P2Atom& P2Atom::operator=(P2Atom rhs)
   {
-    int start;
-    for(u32 i = 0;
-        i < P2ATOM_SIZE / BitVector<P2ATOM_SIZE>::BITS_PER_UNIT; i++)
-      {
-        start = i * BitVector<P2ATOM_SIZE>::BITS_PER_UNIT;
-        m_bits.Write(start,
-                     BitVector<P2ATOM_SIZE>::BITS_PER_UNIT,
-                     rhs.m_bits.Read(start,
-                                     BitVector<P2ATOM_SIZE>::BITS_PER_UNIT
-                                     ));
-      }
+    m_bits = rhs.m_bits;
     return *this;
   }
 } /* namespace MFM */
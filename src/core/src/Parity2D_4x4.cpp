@@ -15,7 +15,7 @@ namespace MFM {
     return 1<<bitno;
   }
 
-  u32 Parity2D_4x4::Correct2DParityIfPossible(u32 allBits)
+  u32 Parity2D_4x4::Correct2DParitySlow(u32 allBits)
   {
     s32 failed[2];  // [row0], [col1]
     failed[0] = failed[1] = -1;
@@ -118,6 +118,29 @@ namespace MFM {
     }
     fprintf(output,"%s", "  };\n");
   }
+  static void WriteRepairTable(FILE * output) {
+    // Which groups fail depends only on the syndrome, so correct a
+    // valid codeword (that of zero) with each syndrome applied
+    const u32 base = Parity2D_4x4::Add2DParity(0);
+    fprintf(output,"%s", "  const u8 Parity2D_4x4::repairTable[REPAIR_TABLE_SIZE] =\n    {");
+    for (u32 syndrome = 0; syndrome < Parity2D_4x4::REPAIR_TABLE_SIZE; ++syndrome) {
+      u32 allBits = base ^ (syndrome << Parity2D_4x4::DATA_BITS);
+      u32 fixed = Parity2D_4x4::Correct2DParitySlow(allBits);
+      u32 bitno = Parity2D_4x4::UNREPAIRABLE;
+      if (fixed != 0 && fixed != allBits) {
+        u32 diff = fixed ^ allBits;
+        for (bitno = 0; (diff & 1) == 0; ++bitno)
+          diff >>= 1;
+      }
+      if (syndrome%16==0)
+        fprintf(output,"\n     ");
+      fprintf(output,"0x%02x", bitno);
+      if (syndrome!=Parity2D_4x4::REPAIR_TABLE_SIZE-1)
+        fprintf(output,", ");
+    }
+    fprintf(output,"\n    };\n");
+  }
+
   static void WriteParityTables(FILE * output) {
     fprintf(output,"%s", "  //// GENERATED TABLES: DO NOT EDIT\n");
     WriteMasksTable(output);
@@ -130,6 +153,7 @@ namespace MFM {
         fprintf(output,", ");
     }
     fprintf(output,"\n    };\n");
+    WriteRepairTable(output);
     fprintf(output,"%s", "  //// END OF GENERATED TABLES\n");
   }
 }
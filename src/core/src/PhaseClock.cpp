@@ -0,0 +1,62 @@
+#include "PhaseClock.h"
+
+namespace MFM
+{
+  PhaseClock::PhaseClock() :
+    m_phase(0),
+    m_arrivals(0),
+    m_participants(0),
+    m_limit(0),
+    m_limitReached(*this)
+  {
+  }
+
+  void PhaseClock::Reset(u32 participants)
+  {
+    m_participants = participants;
+    m_arrivals.Store(0);
+    m_limit.Store(0);
+    m_phase.Store(0);
+  }
+
+  void PhaseClock::Arrive(u32 phase)
+  {
+    if (phase != m_phase.Load(MEMORY_ORDER_RELAXED))
+    {
+      FAIL(ILLEGAL_ARGUMENT);
+    }
+
+    /* acq_rel: the last arrival must see everyone's phase work, so
+       that its release of the next phase publishes all of it. */
+    u32 arrived = m_arrivals.FetchAdd(1, MEMORY_ORDER_ACQ_REL) + 1;
+    if (arrived < m_participants)
+    {
+      return;
+    }
+    if (arrived > m_participants)
+    {
+      FAIL(ILLEGAL_STATE);
+    }
+
+    m_arrivals.Store(0, MEMORY_ORDER_RELAXED);
+    m_phase.Store(phase + 1, MEMORY_ORDER_RELEASE);
+
+    if (phase + 1 >= m_limit.Load(MEMORY_ORDER_ACQUIRE))
+    {
+      Mutex::ScopeLock lock(m_mutex);  // Hold the lock during this block
+      m_limitReached.SignalCondition();
+    }
+  }
+
+  void PhaseClock::Grant(u32 phases)
+  {
+    Mutex::ScopeLock lock(m_mutex);  // Hold the lock during this block
+    m_limit.FetchAdd(phases, MEMORY_ORDER_RELEASE);
+  }
+
+  void PhaseClock::WaitForLimit()
+  {
+    Mutex::ScopeLock lock(m_mutex);  // Hold the lock during this block
+    m_limitReached.WaitForCondition();
+  }
+}
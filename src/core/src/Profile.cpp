@@ -0,0 +1,90 @@
+#include "Profile.h"
+#include "OverflowableCharBufferByteSink.h"  /* For OString128 */
+
+namespace MFM
+{
+  const u64 Log2Histogram::UNBOUNDED;
+
+  u64 Log2Histogram::GetPercentile(u32 percent) const
+  {
+    u64 count = GetCount();
+    if (count == 0)
+    {
+      return 0;
+    }
+
+    u64 wanted = (count * percent + 99) / 100;
+    u64 seen = 0;
+    for (u32 i = 0; i < BUCKETS - 1; ++i)
+    {
+      seen += m_buckets[i];
+      if (seen >= wanted && seen > 0)
+      {
+        return i == 0 ? 0 : (((u64) 1) << i) - 1;
+      }
+    }
+    return UNBOUNDED;  // The catch-all bucket
+  }
+
+  /**
+   * Prints a percentile bound from GetPercentile, as " p<percent><=<bound>"
+   */
+  static void PrintPercentile(ByteSink & sink, u32 percent, u64 bound)
+  {
+    sink.Printf(" p%d", percent);
+    if (bound == Log2Histogram::UNBOUNDED)
+    {
+      sink.Printf(">=2^%d", Log2Histogram::BUCKETS - 2);
+    }
+    else
+    {
+      sink.Print("<=");
+      sink.Print(bound);
+    }
+  }
+
+  void Log2Histogram::Report(Logger::Level level, const char * label) const
+  {
+    u64 count = GetCount();
+    if (count == 0)
+    {
+      return;
+    }
+
+    OString128 line;
+    line.Print(label);
+    line.Print(": n=");
+    line.Print(count);
+    line.Print(" mean=");
+    line.Print(m_total / count);
+    PrintPercentile(line, 50, GetPercentile(50));
+    PrintPercentile(line, 99, GetPercentile(99));
+    line.Print(" ");
+    line.Print(ProfileClock::GetUnits());
+    LOG.Log(level, "%s", line.GetZString());
+
+    // The buckets, a few to a line so each can still be queued
+    const u32 PER_LINE = 6;
+    OString128 buckets;
+    u32 onLine = 0;
+    for (u32 i = 0; i < BUCKETS; ++i)
+    {
+      if (m_buckets[i] == 0)
+      {
+        continue;
+      }
+      buckets.Printf(" <2^%d:", i);
+      buckets.Print(m_buckets[i]);
+      if (++onLine == PER_LINE)
+      {
+        LOG.Log(level, "  %s", buckets.GetZString());
+        buckets.Reset();
+        onLine = 0;
+      }
+    }
+    if (onLine > 0)
+    {
+      LOG.Log(level, "  %s", buckets.GetZString());
+    }
+  }
+}
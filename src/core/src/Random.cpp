@@ -2,6 +2,104 @@
 
 
 namespace MFM {
-} /* namespace MFM */
 
+  u64 Random::Log2Fixed(u64 x)
+  {
+    if (x == 0)
+    {
+      FAIL(ILLEGAL_ARGUMENT);
+    }
+
+    u32 whole = 0;
+    while ((x >> whole) > 1)
+    {
+      ++whole;
+    }
+
+    // Normalize x into [1,2) as 1.31 fixed point
+    u64 m = whole <= 31 ? x << (31 - whole) : x >> (whole - 31);
+
+    // Then square repeatedly, peeling off one fraction bit per step
+    const u64 TWO = ((u64) 1) << 32;
+    u32 frac = 0;
+    for (u32 bit = 1u << 31; bit != 0; bit >>= 1)
+    {
+      m = (m * m) >> 31;
+      if (m >= TWO)
+      {
+        m >>= 1;
+        frac |= bit;
+      }
+    }
+
+    return (((u64) whole) << 32) | frac;
+  }
+
+  void Random::Fill(u32 * out, u32 count)
+  {
+    if (_backend == RANDOM_BACKEND_PHILOX)
+    {
+      _philox.Fill(out, count);
+      return;
+    }
+    for (u32 i = 0; i < count; ++i)
+    {
+      out[i] = _generator.randomMT();
+    }
+  }
+
+  void Random::Fill(u32 * out, u32 count, u32 max)
+  {
+    if (max == 0)
+    {
+      FAIL(ILLEGAL_ARGUMENT);
+    }
+    if (_backend == RANDOM_BACKEND_MT)
+    {
+      for (u32 i = 0; i < count; ++i)
+      {
+        out[i] = Create(max);
+      }
+      return;
+    }
+
+    // Rejections are rare, so draw the whole batch, then map it,
+    // drawing more only for the occasional rejected word
+    Fill(out, count);
+    for (u32 i = 0; i < count; ++i)
+    {
+      out[i] = CreateLemire(max, out[i]);
+    }
+  }
+
+  u32 Random::CreateGeometric(u32 odds)
+  {
+    if (odds == 0)
+    {
+      FAIL(ILLEGAL_ARGUMENT);
+    }
+    if (odds == 1)
+    {
+      return 0;
+    }
+
+    if (odds != _geometricOdds)
+    {
+      _geometricScale = Log2Fixed(odds) - Log2Fixed(odds - 1);
+      if (_geometricScale == 0)   // Beyond our precision; as rare as we can say
+      {
+        _geometricScale = 1;
+      }
+      _geometricOdds = odds;
+    }
+
+    // Inverse CDF: floor(log(u) / log(1 - 1/odds)), u uniform in (0,1]
+    u64 draw = ((u64) Create()) + 1;
+    u64 negLog2U = (((u64) 32) << 32) - Log2Fixed(draw);
+    u64 skips = negLog2U / _geometricScale;
+
+    return skips > (u64) S32_MAX ? (u32) S32_MAX : (u32) skips;
+  }
+
+} /* namespace MFM */
 
@@ -0,0 +1,82 @@
+#include "ThreadBarrier.h"
+
+namespace MFM
+{
+  ThreadBarrier::ThreadBarrier() :
+    m_generation(0),
+    m_completedGeneration(0),
+    m_expected(0),
+    m_arrived(0),
+    m_generationIsComplete(*this)
+  {
+  }
+
+  ThreadBarrier::~ThreadBarrier()
+  {
+  }
+
+  u32 ThreadBarrier::Begin(u32 expected)
+  {
+    Mutex::ScopeLock lock(m_mutex);  // Hold the lock during this block
+
+    if (m_completedGeneration != m_generation)
+    {
+      FAIL(ILLEGAL_STATE);
+    }
+
+    m_expected = expected;
+    m_arrived = 0;
+    ++m_generation;
+
+    if (m_expected == 0)
+    {
+      m_completedGeneration = m_generation;
+    }
+
+    return m_generation;
+  }
+
+  void ThreadBarrier::Arrive()
+  {
+    Mutex::ScopeLock lock(m_mutex);  // Hold the lock during this block
+
+    if (m_arrived >= m_expected)
+    {
+      FAIL(ILLEGAL_STATE);
+    }
+
+    if (++m_arrived == m_expected)
+    {
+      m_completedGeneration = m_generation;
+      m_generationIsComplete.SignalCondition();
+    }
+  }
+
+  bool ThreadBarrier::Wait(u32 generation, u32 timeoutMillis)
+  {
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += timeoutMillis / 1000;
+    deadline.tv_nsec += (timeoutMillis % 1000) * 1000000L;
+    if (deadline.tv_nsec >= 1000000000L)
+    {
+      deadline.tv_nsec -= 1000000000L;
+      ++deadline.tv_sec;
+    }
+
+    Mutex::ScopeLock lock(m_mutex);  // Hold the lock during this block
+
+    if (generation != m_generation)
+    {
+      FAIL(ILLEGAL_ARGUMENT);
+    }
+
+    return m_generationIsComplete.WaitForConditionUntil(deadline);
+  }
+
+  u32 ThreadBarrier::GetArrivals()
+  {
+    Mutex::ScopeLock lock(m_mutex);  // Hold the lock during this block
+    return m_arrived;
+  }
+}
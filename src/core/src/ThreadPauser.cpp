@@ -4,10 +4,11 @@
 namespace MFM
 {
   ThreadPauser::ThreadPauser() :
+    m_threadState((u32) THREADSTATE_PAUSED),
+    m_barrier(NULL),
     m_stateIsRunRequested(*this),
     m_stateIsRunning(*this)
   {
-    m_threadState = THREADSTATE_PAUSED;
   }
 
   ThreadPauser::~ThreadPauser()
@@ -18,18 +19,19 @@ namespace MFM
   {
     Mutex::ScopeLock lock(m_mutex);  // Hold the lock during this block
 
-    assert(m_threadState == fromState);
+    ThreadState state = LoadState(MEMORY_ORDER_RELAXED);
+    assert(state == fromState);
 
-    switch (m_threadState)
+    switch (state)
     {
 
     case THREADSTATE_RUN_READY:
-      m_threadState = THREADSTATE_RUNNING;
+      StoreState(THREADSTATE_RUNNING);
       m_stateIsRunning.SignalCondition();
       break;
 
     case THREADSTATE_RUNNING:
-      m_threadState = THREADSTATE_PAUSE_REQUESTED;
+      StoreState(THREADSTATE_PAUSE_REQUESTED);
       break;
 
     case THREADSTATE_PAUSE_REQUESTED:
@@ -37,11 +39,11 @@ namespace MFM
       break;
 
     case THREADSTATE_PAUSE_READY:
-      m_threadState = THREADSTATE_PAUSED;
+      StoreState(THREADSTATE_PAUSED);
       break;
 
     case THREADSTATE_PAUSED:
-      m_threadState = THREADSTATE_RUN_REQUESTED;
+      StoreState(THREADSTATE_RUN_REQUESTED);
       m_stateIsRunRequested.SignalCondition();
       break;
 
@@ -53,20 +55,14 @@ namespace MFM
       assert(false);
     }
 
-    return m_threadState; // Return (new) current state and release lock
-  }
-
-  ThreadState ThreadPauser::GetStateNonblocking()
-  {
-    Mutex::ScopeLock lock(m_mutex);  // Hold the lock during this block
-    return m_threadState;
+    return LoadState(MEMORY_ORDER_RELAXED); // Return (new) current state and release lock
   }
 
   ThreadState ThreadPauser::GetAdvanceStateInner(bool innerReadyToAdvance)
   {
     Mutex::ScopeLock lock(m_mutex);  // Hold the lock during this block
 
-    switch (m_threadState)
+    switch (LoadState(MEMORY_ORDER_RELAXED))
     {
 
     case THREADSTATE_RUN_READY:
@@ -83,7 +79,11 @@ namespace MFM
       // Inner finishes current event, including getting ACKs from any
       // neighbors it has locked, then sets innerReadyToAdvance
       if (innerReadyToAdvance)
-        m_threadState = THREADSTATE_PAUSE_READY;
+      {
+        StoreState(THREADSTATE_PAUSE_READY);
+        if (m_barrier)
+          m_barrier->Arrive();
+      }
       break;
 
     case THREADSTATE_PAUSE_READY:
@@ -99,14 +99,18 @@ namespace MFM
     case THREADSTATE_RUN_REQUESTED:
       // Inner acks the run request by setting innerReadyToAdvance here
       if (innerReadyToAdvance)
-        m_threadState = THREADSTATE_RUN_READY;
+      {
+        StoreState(THREADSTATE_RUN_READY);
+        if (m_barrier)
+          m_barrier->Arrive();
+      }
       break;
 
     default:
       assert(false);
     }
 
-    return m_threadState; // Return current state and release lock
+    return LoadState(MEMORY_ORDER_RELAXED); // Return current state and release lock
   }
 
   const char * ThreadPauser::GetThreadStateName(ThreadState ts)
@@ -126,8 +130,9 @@ namespace MFM
   void ThreadPauser::ReportThreadPauserStatus(Logger::Level level)
   {
     LOG.Log(level,"   =ThreadPauser %p=", (void*) this);
+    ThreadState state = GetStateNonblocking();
     LOG.Log(level,"   =ThreadState: %d (%s)",
-            (int) m_threadState, GetThreadStateName(m_threadState));
+            (int) state, GetThreadStateName(state));
     m_mutex.ReportMutexStatus(level);
   }
 
@@ -1,5 +1,6 @@
 /* -*- C++ -*- */
 #include <stdlib.h>
+#include <string.h>
 #include "ThreadQueue.h"
 #include "Fail.h"
 #include "Logger.h"
@@ -9,9 +10,15 @@
 
 namespace MFM
 {
-  ThreadQueue::ThreadQueue()
+  ThreadQueue::ThreadQueue() :
+    m_writeHead(0),
+    m_producerReadHead(0),
+    m_readHead(0),
+    m_consumerWriteHead(0),
+    m_readerWaiting(0)
   {
-    m_readHead = m_writeHead = m_heldBytes = 0;
+    // Free-running heads only work if the capacity is a power of two
+    COMPILATION_REQUIREMENT<(THREADQUEUE_MAX_BYTES & INDEX_MASK) == 0>();
 
     if(pthread_mutex_init(&m_lock, NULL))
     {
@@ -33,117 +40,136 @@ namespace MFM
 
   void ThreadQueue::Write(u8* bytes, u32 length)
   {
-    pthread_mutex_lock(&m_lock);
+    u32 writeHead = m_writeHead.Load(MEMORY_ORDER_RELAXED);
+
+    if(writeHead - m_producerReadHead + length > THREADQUEUE_MAX_BYTES)
     {
-      if(length + m_heldBytes > THREADQUEUE_MAX_BYTES)
+      // Our idea of the reader's position is stale; go look
+      m_producerReadHead = m_readHead.Load(MEMORY_ORDER_ACQUIRE);
+      if(writeHead - m_producerReadHead + length > THREADQUEUE_MAX_BYTES)
       {
         LOG.Error("ERROR: THREADQUEUE OVERLOAD!\n");
         FAIL(OUT_OF_RESOURCES);
       }
+    }
 
-      for(u32 i = 0; i < length; i++)
-      {
-        m_queueData[m_writeHead++] = *(bytes++);
-        if(m_writeHead >= THREADQUEUE_MAX_BYTES)
-        {
-          m_writeHead %= THREADQUEUE_MAX_BYTES;
-        }
-      }
-      m_heldBytes += length;
+    u32 start = writeHead & INDEX_MASK;
+    u32 first = MIN(length, THREADQUEUE_MAX_BYTES - start);
+    memcpy(m_queueData + start, bytes, first);
+    memcpy(m_queueData, bytes + first, length - first);
+
+    /* Publish everything at once.  The fence orders this store
+       before our read of m_readerWaiting, pairing with the one in
+       WaitForBytes, so a sleeping reader cannot miss the bytes. */
+    m_writeHead.Store(writeHead + length, MEMORY_ORDER_RELEASE);
+    AtomicThreadFence(MEMORY_ORDER_SEQ_CST);
+
+    if(m_readerWaiting.Load(MEMORY_ORDER_RELAXED))
+    {
+      pthread_mutex_lock(&m_lock);
+      pthread_cond_signal(&m_cond); /* Reading is available! */
+      pthread_mutex_unlock(&m_lock);
     }
-    pthread_cond_signal(&m_cond); /* Reading is available! */
-    pthread_mutex_unlock(&m_lock);
   }
 
-  u32 ThreadQueue::UnsafeRead(u8* bytes, u32 length)
+  void ThreadQueue::CopyOut(u8* toBuffer, u32 from, u32 length) const
+  {
+    u32 start = from & INDEX_MASK;
+    u32 first = MIN(length, THREADQUEUE_MAX_BYTES - start);
+    memcpy(toBuffer, m_queueData + start, first);
+    memcpy(toBuffer + first, m_queueData, length - first);
+  }
+
+  u32 ThreadQueue::ReadAvailable(u8* bytes, u32 length)
   {
-    u32 bytesAvailable = MIN(length, m_heldBytes);
-    for(u32 i = 0; i < bytesAvailable; i++)
+    u32 readHead = m_readHead.Load(MEMORY_ORDER_RELAXED);
+
+    if(m_consumerWriteHead - readHead < length)
     {
-      *(bytes++) = m_queueData[m_readHead];
-      m_queueData[m_readHead++] = 0xdb; // Mark as a dead byte
-      if(m_readHead >= THREADQUEUE_MAX_BYTES)
-      {
-        m_readHead %= THREADQUEUE_MAX_BYTES;
-      }
+      m_consumerWriteHead = m_writeHead.Load(MEMORY_ORDER_ACQUIRE);
+    }
+
+    u32 bytesAvailable = MIN(length, m_consumerWriteHead - readHead);
+    if(bytesAvailable > 0)
+    {
+      CopyOut(bytes, readHead, bytesAvailable);
+      m_readHead.Store(readHead + bytesAvailable, MEMORY_ORDER_RELEASE);
     }
-    m_heldBytes -= bytesAvailable;
     return bytesAvailable;
   }
 
+  void ThreadQueue::WaitForBytes()
+  {
+    pthread_mutex_lock(&m_lock);
+    m_readerWaiting.Store(1, MEMORY_ORDER_RELAXED);
+    AtomicThreadFence(MEMORY_ORDER_SEQ_CST);
+
+    while(m_writeHead.Load(MEMORY_ORDER_ACQUIRE) ==
+          m_readHead.Load(MEMORY_ORDER_RELAXED))
+    {
+      pthread_cond_wait(&m_cond, &m_lock);
+    }
+
+    m_readerWaiting.Store(0, MEMORY_ORDER_RELAXED);
+    pthread_mutex_unlock(&m_lock);
+  }
+
   void ThreadQueue::ReadBlocking(u8* bytes, u32 length)
   {
     u32 readBytes = 0;
-    pthread_mutex_lock(&m_lock);
     while(readBytes < length)
     {
-      readBytes += UnsafeRead(bytes + readBytes, length - readBytes);
+      readBytes += ReadAvailable(bytes + readBytes, length - readBytes);
       if(readBytes < length)
       {
-        pthread_cond_wait(&m_cond, &m_lock);
+        WaitForBytes();
       }
     }
-    pthread_mutex_unlock(&m_lock);
   }
 
   u32 ThreadQueue::Read(u8* bytes, u32 length)
   {
-    u32 readBytes = 0;
-    /* Bail if there aren't enough bytes to read. */
-    /* We are checking m_heldBytes without holding the lock because
-       writing to the queue can only make m_heldBytes larger, so if
-       there's enough held bytes now, there still will be even if a
-       write intervenes before we get the lock. */
-    if(m_heldBytes >= length)
+    /* Bail if there aren't enough bytes to read.  Only the writer
+       can change m_writeHead, and only by making it larger, so if
+       there are enough bytes now there still will be when we copy. */
+    u32 readHead = m_readHead.Load(MEMORY_ORDER_RELAXED);
+    if(m_consumerWriteHead - readHead < length)
     {
-      pthread_mutex_lock(&m_lock);
+      m_consumerWriteHead = m_writeHead.Load(MEMORY_ORDER_ACQUIRE);
+      if(m_consumerWriteHead - readHead < length)
       {
-        readBytes = UnsafeRead(bytes, length);
+        return 0;
       }
-      pthread_mutex_unlock(&m_lock);
     }
-    return readBytes;
+
+    CopyOut(bytes, readHead, length);
+    m_readHead.Store(readHead + length, MEMORY_ORDER_RELEASE);
+    return length;
   }
 
   void ThreadQueue::PeekRead(u8* toBuffer, u32 index, u32 length)
   {
-    pthread_mutex_lock(&m_lock);
-    {
-      if(m_heldBytes < length + index)
-      {
-        FAIL(ARRAY_INDEX_OUT_OF_BOUNDS);
-      }
+    u32 readHead = m_readHead.Load(MEMORY_ORDER_ACQUIRE);
+    u32 writeHead = m_writeHead.Load(MEMORY_ORDER_ACQUIRE);
 
-      u32 readHead = index + m_readHead;
-      for(u32 i = 0; i < length; i++)
-      {
-        *(toBuffer++) = m_queueData[readHead++];
-        if(readHead >= THREADQUEUE_MAX_BYTES)
-        {
-          readHead %= THREADQUEUE_MAX_BYTES;
-        }
-      }
+    if(writeHead - readHead < length + index)
+    {
+      FAIL(ARRAY_INDEX_OUT_OF_BOUNDS);
     }
-    pthread_mutex_unlock(&m_lock);
+
+    CopyOut(toBuffer, readHead + index, length);
   }
 
   u32 ThreadQueue::BytesAvailable()
   {
-    u32 ret;
-    pthread_mutex_lock(&m_lock);
-    {
-      ret = m_heldBytes;
-    }
-    pthread_mutex_unlock(&m_lock);
-    return ret;
+    u32 readHead = m_readHead.Load(MEMORY_ORDER_ACQUIRE);
+    return m_writeHead.Load(MEMORY_ORDER_ACQUIRE) - readHead;
   }
 
   void ThreadQueue::Flush()
   {
-    pthread_mutex_lock(&m_lock);
-    {
-      m_readHead = m_writeHead = m_heldBytes = 0;
-    }
-    pthread_mutex_unlock(&m_lock);
+    u32 writeHead = m_writeHead.Load(MEMORY_ORDER_ACQUIRE);
+    m_consumerWriteHead = writeHead;
+    m_readHead.Store(writeHead, MEMORY_ORDER_RELEASE);
   }
 }
@@ -7,7 +7,7 @@ namespace MFM {
   //DEPRECATED: typedef P1Atom<OurParamConfig> OurAtom;
   typedef P3Atom<OurParamConfig> OurAtom;
   typedef CoreConfig<OurAtom,OurParamConfig> OurCoreConfig;
-  typedef GridConfig<OurCoreConfig,2,1> OurGridConfig;
+  typedef GridConfig<OurCoreConfig> OurGridConfig;
   typedef StatsRenderer<OurGridConfig> OurStatsRenderer;
   struct MFMSimDHSDemo : public AbstractGUIDriver<OurGridConfig>
   {
@@ -109,6 +109,7 @@ int main(int argc, const char** argv)
 {
   MFM::MFMSimDHSDemo sim;
 
+  sim.SetGridDimensions(2, 1);
   sim.Init(argc, argv);
 
   sim.Reinit();
@@ -8,7 +8,7 @@ namespace MFM
   typedef ParamConfig<96,4,8,40> OurParamConfigStd;
   typedef P3Atom<OurParamConfigStd> OurAtomStd;
   typedef CoreConfig<OurAtomStd, OurParamConfigStd> OurCoreConfigStd;
-  typedef GridConfig<OurCoreConfigStd, 5, 3> OurGridConfigStd;
+  typedef GridConfig<OurCoreConfigStd> OurGridConfigStd;
 
   /////
   // Tiny model
@@ -16,7 +16,7 @@ namespace MFM
   typedef ParamConfig<96,4,8,32> OurParamConfigTiny;
   typedef P3Atom<OurParamConfigTiny> OurAtomTiny;
   typedef CoreConfig<OurAtomTiny, OurParamConfigTiny> OurCoreConfigTiny;
-  typedef GridConfig<OurCoreConfigTiny, 2, 2> OurGridConfigTiny;
+  typedef GridConfig<OurCoreConfigTiny> OurGridConfigTiny;
 
   /////
   // Larger model
@@ -24,7 +24,7 @@ namespace MFM
   typedef ParamConfig<96,4,8,48> OurParamConfigBig;
   typedef P3Atom<OurParamConfigBig> OurAtomBig;
   typedef CoreConfig<OurAtomBig, OurParamConfigBig> OurCoreConfigBig;
-  typedef GridConfig<OurCoreConfigBig, 8, 5> OurGridConfigBig;
+  typedef GridConfig<OurCoreConfigBig> OurGridConfigBig;
 
   template <class GC>
   struct MFMCDriver : public AbstractDualDriver<GC>
@@ -82,27 +82,15 @@ namespace MFM
     { }
   };
 
-  static int RunSmall(int argc, const char** argv)
-  {
-    MFMCDriver<OurGridConfigTiny> sim;
-    sim.Init(argc, argv);
-    sim.Reinit();
-    sim.Run();
-    return 0;
-  }
-
-  static int RunMedium(int argc, const char** argv)
-  {
-    MFMCDriver<OurGridConfigStd> sim;
-    sim.Init(argc, argv);
-    sim.Reinit();
-    sim.Run();
-    return 0;
-  }
-
-  static int RunBig(int argc, const char** argv)
+  /**
+   * Runs an MFMCDriver whose grid is \c gridWidth by \c gridHeight
+   * tiles unless the command line (-g) says otherwise.
+   */
+  template <class GC>
+  static int RunDriver(int argc, const char** argv, u32 gridWidth, u32 gridHeight)
   {
-    MFMCDriver<OurGridConfigBig> sim;
+    MFMCDriver<GC> sim;
+    sim.SetGridDimensions(gridWidth, gridHeight);
     sim.Init(argc, argv);
     sim.Reinit();
     sim.Run();
@@ -126,13 +114,13 @@ int main(int argc, const char** argv)
 
   if (EndsWith(argv[0],"_s"))
   {
-    return MFM::RunSmall(argc, argv);
+    return MFM::RunDriver<MFM::OurGridConfigTiny>(argc, argv, 2, 2);
   }
 
   if (EndsWith(argv[0],"_l"))
   {
-    return MFM::RunBig(argc, argv);
+    return MFM::RunDriver<MFM::OurGridConfigBig>(argc, argv, 8, 5);
   }
 
-  return MFM::RunMedium(argc, argv);
+  return MFM::RunDriver<MFM::OurGridConfigStd>(argc, argv, 5, 3);
 }
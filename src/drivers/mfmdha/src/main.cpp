@@ -12,10 +12,7 @@ extern "C" typedef void * (*MFM_Element_Plugin_Get_Static_Pointer)();
 
 namespace MFM {
 
-  typedef GridConfig<OurCoreConfig,3,2> OurSmallGridConfig;
-  typedef GridConfig<OurCoreConfig,5,3> OurBigGridConfig;
-  //  typedef GridConfig<OurCoreConfig,5,3> OurBigGridConfig;
-  typedef OurBigGridConfig OurGridConfig;
+  typedef GridConfig<OurCoreConfig> OurGridConfig;
 
   typedef StatsRenderer<OurGridConfig> OurStatsRenderer;
 
@@ -128,9 +125,9 @@ namespace MFM {
       SPoint aloc(20, 30);
       SPoint sloc(20, 10);
       SPoint e1loc(20+2,20+2);
-      SPoint e2loc(GRID_WIDTH*realWidth-2-20, GRID_HEIGHT*realWidth-2-20);
-      SPoint cloc(GRID_WIDTH*realWidth, GRID_HEIGHT*realWidth/2);
-      SPoint seedAtomPlace(3*GRID_WIDTH*realWidth/4,QBAR_SIZE.GetY()/4*3/2+15);
+      SPoint e2loc(mainGrid.GetWidth()*realWidth-2-20, mainGrid.GetHeight()*realWidth-2-20);
+      SPoint cloc(mainGrid.GetWidth()*realWidth, mainGrid.GetHeight()*realWidth/2);
+      SPoint seedAtomPlace(3*mainGrid.GetWidth()*realWidth/4,QBAR_SIZE.GetY()/4*3/2+15);
 
       u32 wid = mainGrid.GetWidth()*realWidth;
       u32 hei = mainGrid.GetHeight()*realWidth;
@@ -267,8 +264,8 @@ namespace MFM {
       SPoint aloc(20, 30);
       SPoint sloc(20, 10);
       SPoint e1loc(20+2,20+2);
-      SPoint e2loc(GRID_WIDTH*realWidth-2-20, GRID_HEIGHT*realWidth-2-20);
-      SPoint cloc(GRID_WIDTH*realWidth/2, GRID_HEIGHT*realWidth/2);
+      SPoint e2loc(mainGrid.GetWidth()*realWidth-2-20, mainGrid.GetHeight()*realWidth-2-20);
+      SPoint cloc(mainGrid.GetWidth()*realWidth/2, mainGrid.GetHeight()*realWidth/2);
 
       u32 wid = mainGrid.GetWidth()*realWidth;
       u32 hei = mainGrid.GetHeight()*realWidth;
@@ -5,7 +5,7 @@ namespace MFM
   typedef ParamConfig<64,4,8,40> OurParamConfig;
   typedef P3Atom<OurParamConfig> OurAtom;
   typedef CoreConfig<OurAtom, OurParamConfig> OurCoreConfig;
-  typedef GridConfig<OurCoreConfig, 5, 3> OurGridConfig;
+  typedef GridConfig<OurCoreConfig> OurGridConfig;
 
   struct MFMSimHeadlessDemo : public AbstractDualDriver<OurGridConfig>
   {
@@ -12,7 +12,7 @@ namespace MFM {
   //typedef P1Atom<OurParamConfig> OurAtom;
   typedef P3Atom<OurParamConfig> OurAtom;
   typedef CoreConfig<OurAtom,OurParamConfig> OurCoreConfig;
-  typedef GridConfig<OurCoreConfig,5,3> OurGridConfig;
+  typedef GridConfig<OurCoreConfig> OurGridConfig;
   typedef StatsRenderer<OurGridConfig> OurStatsRenderer;
   struct MFMSimDHSDemo : public AbstractGUIDriver<OurGridConfig>
   {
@@ -100,8 +100,8 @@ namespace MFM {
 
       SPoint aloc(20, 30);
       SPoint sloc(20, 10);
-      SPoint eloc(GRID_WIDTH*realWidth-2, GRID_HEIGHT*realWidth/2);
-      SPoint cloc(0, GRID_HEIGHT*realWidth/2);
+      SPoint eloc(mainGrid.GetWidth()*realWidth-2, mainGrid.GetHeight()*realWidth/2);
+      SPoint cloc(0, mainGrid.GetHeight()*realWidth/2);
 
       for(u32 x = 0; x < mainGrid.GetWidth(); x++)
         {
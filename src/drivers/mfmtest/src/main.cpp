@@ -26,6 +26,10 @@ int main(int argc, char** argv)
   ColorMap_Test::Test_RunTests();
   Random_Test::Test_RunTests();
   BitVector_Test::Test_RunTests();
+  ThreadQueue_Test::Test_RunTests();
+  WorkStealingDeque_Test::Test_RunTests();
+  ThreadBarrier_Test::Test_RunTests();
+  Profile_Test::Test_RunTests();
 
   Point_Test::Test_pointAdd();
   Point_Test::Test_pointMultiply();
@@ -41,11 +45,25 @@ int main(int argc, char** argv)
 #endif
 
   Tile_Test::Test_tilePlaceAtom();
+  Tile_Test::Test_tileIncrementalCounts();
+  Tile_Test::Test_tilePublishedStats();
+  Tile_Test::Test_tileAckWindow();
+  Tile_Test::Test_tileBatchedEventBudget();
+#ifdef MFM_EVENT_ROLLBACK
+  Tile_Test::Test_tileRollBack();
+#endif
 
   Grid_Test::Test_gridPlaceAtom();
+  Grid_Test::Test_gridDimensions();
+  Grid_Test::Test_gridLockEvents();
+  Grid_Test::Test_gridWorkerThreads();
+  Grid_Test::Test_gridDeterministicRadiation();
+  Grid_Test::Test_gridCheckerboard();
 
   EventWindow_Test::Test_eventwindowConstruction();
   EventWindow_Test::Test_eventwindowWrite();
+  EventWindow_Test::Test_eventwindowDirtySites();
+  EventWindow_Test::Test_eventwindowSymmetries();
 
   ExternalConfig_Test::Test_RunTests();
 
@@ -58,6 +58,7 @@ namespace MFM
 
     AbstractElement_ForkBomb(const UUID & uuid) : Element<CC>(uuid)
     {
+      Element<CC>::AddTraits(ELEMENT_TRAIT_FORKBOMB);
     }
 
     virtual u32 PercentMovable(const T& you,
@@ -74,14 +75,13 @@ namespace MFM
 
     virtual void Behavior(EventWindow<CC>& window) const
     {
-      const MDist<R> md = MDist<R>::get();
+      const MDist<R> & md = MDist<R>::get();
       u32 range = GetBombRange();
       if (range > R)
         range = R;
       for (u32 idx = md.GetFirstIndex(1); idx <= md.GetLastIndex(range); ++idx)
       {
-        const SPoint rel = md.GetPoint(idx);
-        window.SetRelativeAtom(rel, window.GetCenterAtom());
+        window.SetRelativeAtom(idx, window.GetCenterAtom());
       }
     }
   };
@@ -60,7 +60,7 @@ namespace MFM
 
     static u32 GetIndex(const SPoint coord)
     {
-      const MDist<R> md = MDist<R>::get();
+      const MDist<R> & md = MDist<R>::get();
       s32 idx = md.FromPoint(coord, R);
       if (idx < 0)
       {
@@ -98,6 +98,7 @@ namespace MFM
 
     AbstractElement_Xtal(const UUID & uuid) : Element<CC>(uuid)
     {
+      Element<CC>::AddTraits(ELEMENT_TRAIT_XTAL);
     }
 
     /**
@@ -115,8 +116,7 @@ namespace MFM
 
     bool IsAbstractXtalType(EventWindow<CC>& window, u32 type) const
     {
-      const Element<CC> * elt = window.GetTile().GetElement(type);
-      return dynamic_cast<const AbstractElement_Xtal<CC>*>(elt) != 0;
+      return window.GetTile().GetElementTable().HasTraits(type, ELEMENT_TRAIT_XTAL);
     }
 
     struct SiteSampler {
@@ -138,7 +138,7 @@ namespace MFM
     {
       Random & random = window.GetRandom();
       const u32 ourType = this->GetType();
-      const MDist<R> md = MDist<R>::get();
+      const MDist<R> & md = MDist<R>::get();
 
       T self = window.GetCenterAtom();
 
@@ -174,13 +174,13 @@ namespace MFM
         const SPoint sp = md.GetPoint(idx);
 
         // First question: Is this a live site?
-        if (!window.IsLiveSite(sp))
+        if (!window.IsLiveSite(idx))
           continue;
 
         // Second question: Is this a point site or a field site?
         bool isPoint = xtalSites.ReadBit(idx) !=0 ;
 
-        const T other = window.GetRelativeAtom(sp);
+        const T other = window.GetRelativeAtom(idx);
         const u32 otherType = other.GetType();
 
         if (isPoint) {
@@ -134,7 +134,7 @@ namespace MFM
 
     virtual void Behavior(EventWindow<CC>& window) const
     {
-//	const MDist<R> md = MDist<R>::get();
+//	const MDist<R> & md = MDist<R>::get();
 	const T& thisAtom = window.GetCenterAtom();
 	s32 myLength = GetAntennaLength(thisAtom);
 	//TODO: Get this using the slider value!
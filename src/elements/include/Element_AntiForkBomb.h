@@ -100,7 +100,7 @@ namespace MFM
     {
       Random & random = window.GetRandom();
       const u32 ourType = THE_INSTANCE.GetType();
-      const MDist<R> md = MDist<R>::get();
+      const MDist<R> & md = MDist<R>::get();
 
       T self = window.GetCenterAtom();
       u32 myInflammationLevel = AFInflammationLevel::Read(self);
@@ -114,6 +114,7 @@ namespace MFM
       SPoint randomEmpty;
       SPoint randomSelf;
 
+      const ElementTable<CC> & elements = window.GetTile().GetElementTable();
       for (u32 i = loIdx; i <= hiIdx; ++i)
       {
         const SPoint rel = md.GetPoint(i);
@@ -123,8 +124,7 @@ namespace MFM
         }
         const T & atom = window.GetRelativeAtom(rel);
         const u32 type = atom.GetType();
-        const Element<CC> * elt = window.GetTile().GetElement(type);
-        if (elt == &Element_Empty<CC>::THE_INSTANCE)
+        if (type == Element_Empty<CC>::THE_INSTANCE.GetType())
         {
           if (random.OneIn(++emptyCount))
           {
@@ -141,7 +141,7 @@ namespace MFM
           {
             randomSelf = rel;
           }
-        } else if (dynamic_cast<const AbstractElement_ForkBomb<CC>*>(elt))
+        } else if (elements.HasTraits(type, ELEMENT_TRAIT_FORKBOMB))
         {
           // We see a pathogen!  Danger danger!  Red alert!
           maxInflammation = 4;
@@ -134,7 +134,6 @@ namespace MFM
 	//Let's try to get it to move up to the top-right corner.
     virtual void Behavior(EventWindow<CC>& window) const
     {
-	const MDist<R> md = MDist<R>::get();
 	//We'll try to move there if it's a good spot and we're not 'done' (define that later!)
 	//It looks like we can instead use window.IsLiveSite(rel)!
 	T us = window.GetCenterAtom();
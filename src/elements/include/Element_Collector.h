@@ -89,17 +89,17 @@ namespace MFM
       SPoint empty;
       u32 emptyCount = 0;
 
-      const MDist<R> md = MDist<R>::get();
+      const MDist<R> & md = MDist<R>::get();
 
       // Scan near me for mytypes, res, or other object
       for (u32 idx = md.GetFirstIndex(1); idx <= md.GetLastIndex(2); ++idx) {
         const SPoint sp = md.GetPoint(idx);
 
-        if (!window.IsLiveSite(sp))
+        if (!window.IsLiveSite(idx))
           continue;
 
         // Empty or occupied?
-        const T other = window.GetRelativeAtom(sp);
+        const T other = window.GetRelativeAtom(idx);
         const u32 otherType = other.GetType();
         bool isEmpty = Element_Empty<CC>::THE_INSTANCE.IsType(otherType);
 
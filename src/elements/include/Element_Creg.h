@@ -86,7 +86,7 @@ namespace MFM
 
     virtual void Behavior(EventWindow<CC>& window) const
     {
-      const MDist<R> md = MDist<R>::get();
+      const MDist<R> & md = MDist<R>::get();
       Random& rand = window.GetRandom();
 
       SPoint cregAtom;
@@ -97,7 +97,7 @@ namespace MFM
       for(u32 i = md.GetFirstIndex(0); i <= md.GetLastIndex(R); i++)
       {
         const SPoint& rel = md.GetPoint(i);
-        const T& atom = window.GetRelativeAtom(rel);
+        const T& atom = window.GetRelativeAtom(i);
 
         if(Atom<CC>::IsType(atom, Element_Wall<CC>::THE_INSTANCE.GetType()))
         {
@@ -112,7 +112,7 @@ namespace MFM
     virtual void Behavior(EventWindow<CC>& window) const
     {
       Random & random = window.GetRandom();
-      const MDist<R> md = MDist<R>::get();
+      const MDist<R> & md = MDist<R>::get();
 
       SPoint emptyRel;
       u32 emptyCount = 0;
@@ -125,11 +125,11 @@ namespace MFM
            ++idx)
       {
         const SPoint rel = md.GetPoint(idx);
-        if (!window.IsLiveSite(rel))
+        if (!window.IsLiveSite(idx))
         {
           continue;
         }
-        T other = window.GetRelativeAtom(rel);
+        T other = window.GetRelativeAtom(idx);
         u32 otherType = other.GetType();
 
         bool isOtherEmpty = Element_Empty<CC>::THE_INSTANCE.IsType(otherType);
@@ -110,7 +110,7 @@ namespace MFM
         ++datap[DATUMS_EMITTED_SLOT];                  // Count emission attempts
 
         // Pick random nearest empty, if any
-        const MDist<R> md = MDist<R>::get();
+        const MDist<R> & md = MDist<R>::get();
         for (u32 ring = 1; ring <= 2; ++ring)
         {
           u32 emptiesFound = 0;
@@ -118,11 +118,11 @@ namespace MFM
           for (u32 idx = md.GetFirstIndex(ring); idx <= md.GetLastIndex(ring); ++idx)
           {
             const SPoint sp = md.GetPoint(idx);
-            if (!window.IsLiveSite(sp))
+            if (!window.IsLiveSite(idx))
             {
               continue;
             }
-            const T other = window.GetRelativeAtom(sp);
+            const T other = window.GetRelativeAtom(idx);
             const u32 otherType = other.GetType();
             bool isEmpty = otherType == Element_Empty<CC>::THE_INSTANCE.GetType();
             if (isEmpty && random.OneIn(++emptiesFound))
@@ -108,7 +108,7 @@ namespace MFM
     {
       Random & random = window.GetRandom();
       T self = window.GetCenterAtom();
-      const MDist<R> md = MDist<R>::get();
+      const MDist<R> & md = MDist<R>::get();
       SPoint emptyRel;
       u32 emptyCount = 0;
       u32 age = this->GetCurrentAge(self);
@@ -124,11 +124,11 @@ namespace MFM
       for (u32 idx = md.GetFirstIndex(1); idx <= md.GetLastIndex(1); ++idx)
       {
         const SPoint rel = md.GetPoint(idx);
-        if (!window.IsLiveSite(rel))
+        if (!window.IsLiveSite(idx))
         {
           continue;
         }
-        T other = window.GetRelativeAtom(rel);
+        T other = window.GetRelativeAtom(idx);
         u32 type = other.GetType();
         if(type == Element_Empty<CC>::THE_INSTANCE.GetType())
         {
@@ -48,11 +48,17 @@ namespace MFM
     typedef typename CC::ATOM_TYPE T;
     typedef typename CC::PARAM_CONFIG P;
 
+    /**
+     * Limits Behavior's per-event debug message
+     */
+    mutable LogRateLimiter m_behaviorLog;
+
   public:
     typedef BitVector<P::BITS_PER_ATOM> BVA;
     enum {
       ELT_VERSION = 1,
-      BITS_IN_INDEX = 24
+      BITS_IN_INDEX = 24,
+      BEHAVIOR_LOGS_PER_SECOND = 10
     };
     typedef BitField<BVA, BITS_IN_INDEX, (P3Atom<P>::P3_STATE_BITS_POS+7)/8*8> AFIndex;
 
@@ -61,7 +67,9 @@ namespace MFM
       return THE_INSTANCE.GetType();
     }
 
-    Element_Indexed() : Element<CC>(MFM_UUID_FOR("Indexed", ELT_VERSION))
+    Element_Indexed() :
+      Element<CC>(MFM_UUID_FOR("Indexed", ELT_VERSION)),
+      m_behaviorLog(BEHAVIOR_LOGS_PER_SECOND)
     {
       Element<CC>::SetAtomicSymbol("Ix");
       Element<CC>::SetName("Indexed");
@@ -106,11 +114,11 @@ namespace MFM
     {
       T self = window.GetCenterAtom();
 
-      LOG.Debug("IDX#%3d@%p(%2d,%2d)",
-                AFIndex::Read(this->GetBits(self)),
-                (void*) &window.GetTile(),
-                window.GetCenterInTile().GetX(),
-                window.GetCenterInTile().GetY());
+      MFM_LOG_DBG_LIMITED(m_behaviorLog)("IDX#%3d@%p(%2d,%2d)",
+                                         AFIndex::Read(this->GetBits(self)),
+                                         (void*) &window.GetTile(),
+                                         window.GetCenterInTile().GetX(),
+                                         window.GetCenterInTile().GetY());
 
       this->Diffuse(window);
     }
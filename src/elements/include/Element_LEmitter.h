@@ -124,7 +124,7 @@ namespace MFM
 
     virtual void Behavior(EventWindow<CC>& window) const
     {
-//	const MDist<R> md = MDist<R>::get();
+//	const MDist<R> & md = MDist<R>::get();
 	const T& thisAtom = window.GetCenterAtom(); 
         int dir = 0;
 	
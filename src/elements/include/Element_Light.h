@@ -123,7 +123,7 @@ namespace MFM
 
     virtual void Behavior(EventWindow<CC>& window) const
     {
-//	const MDist<R> md = MDist<R>::get();
+//	const MDist<R> & md = MDist<R>::get();
 	const T& thisAtom = window.GetCenterAtom(); 
       int dir = 0; // a stand-in for the s32 so we can switch on it's value.
 	
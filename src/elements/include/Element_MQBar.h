@@ -266,7 +266,7 @@ namespace MFM
       SPoint barMax = this->GetMax(self);
       SPoint myPos = this->GetPos(self);
 
-      const MDist<R> md = MDist<R>::get();
+      const MDist<R> & md = MDist<R>::get();
 
       SPoint anInconsistent;
       u32 inconsistentCount = 0;
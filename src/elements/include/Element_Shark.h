@@ -132,7 +132,7 @@ namespace MFM
     {
       Random & random = window.GetRandom();
       T self = window.GetCenterAtom();
-      const MDist<R> md = MDist<R>::get();
+      const MDist<R> & md = MDist<R>::get();
 
       SPoint fishRel;
       u32 fishCount = 0;
@@ -164,11 +164,11 @@ namespace MFM
       for (u32 idx = md.GetFirstIndex(1); idx <= md.GetLastIndex(1); ++idx)
       {
         const SPoint rel = md.GetPoint(idx);
-        if (!window.IsLiveSite(rel))
+        if (!window.IsLiveSite(idx))
         {
           continue;
         }
-        T other = window.GetRelativeAtom(rel);
+        T other = window.GetRelativeAtom(idx);
         u32 type = other.GetType();
         if(type == Element_Fish<CC>::THE_INSTANCE.GetType())
         {
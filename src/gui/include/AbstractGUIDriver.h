@@ -88,8 +88,6 @@ namespace MFM
    protected:
     typedef typename Super::OurGrid OurGrid;
     typedef typename Super::CC CC;
-    enum { W = GC::GRID_WIDTH};
-    enum { H = GC::GRID_HEIGHT};
 
     bool m_startPaused;
     bool m_thisUpdateIsEpoch;
@@ -197,8 +195,7 @@ namespace MFM
         GridRenderer & grend = AbstractGridButton::m_driver->GetGridRenderer();
 
         const SPoint selTile = grend.GetSelectedTile();
-        if(selTile.GetX() >= 0 && selTile.GetX() < W &&
-           selTile.GetY() >= 0 && selTile.GetY() < H)
+        if(grid.IsLegalTileIndex(selTile))
         {
           grid.EmptyTile(grend.GetSelectedTile());
         }
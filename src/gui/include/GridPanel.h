@@ -53,18 +53,11 @@ namespace MFM
     typedef typename GC::CORE_CONFIG CC;
     typedef typename CC::PARAM_CONFIG P;
     typedef typename CC::ATOM_TYPE T;
-    enum { W = GC::GRID_WIDTH};
-    enum { H = GC::GRID_HEIGHT};
     enum { R = P::EVENT_WINDOW_RADIUS};
     enum { TILE_SIDE_CACHE_SITES = P::TILE_WIDTH};
     enum { TILE_SIDE_LIVE_SITES = TILE_SIDE_CACHE_SITES - 2*R};
 
     static const u32 EVENT_WINDOW_RADIUS = R;
-    static const u32 GRID_WIDTH_TILES = W;
-    static const u32 GRID_HEIGHT_TILES = H;
-
-    static const u32 GRID_WIDTH_LIVE_SITES = W * TILE_SIDE_LIVE_SITES;
-    static const u32 GRID_HEIGHT_LIVE_TILES = H * TILE_SIDE_LIVE_SITES;
 
     typedef Grid<GC> OurGrid;
 
@@ -379,8 +372,8 @@ namespace MFM
           }
         }
         else if(cp.GetX() >= 0 && cp.GetY() >= 0 &&
-                cp.GetX() < TILE_SIDE_LIVE_SITES * W &&
-                cp.GetY() < TILE_SIDE_LIVE_SITES * H)
+                cp.GetX() < (s32) grid.GetWidthSites() &&
+                cp.GetY() < (s32) grid.GetHeightSites())
         {
           if(tool == TOOL_BUCKET)
           {
@@ -433,7 +426,7 @@ namespace MFM
 
     void BucketFill(Grid<GC>& grid, const T& atom, SPoint& pt)
     {
-      MDist<1> md = MDist<1>::get();
+      const MDist<1> & md = MDist<1>::get();
 
       grid.PlaceAtom(atom, pt);
 
@@ -443,8 +436,8 @@ namespace MFM
         npt.Add(pt.GetX(), pt.GetY());
 
         if(npt.GetX() >= 0 && npt.GetY() >= 0 &&
-           npt.GetX() < TILE_SIDE_LIVE_SITES * W &&
-           npt.GetY() < TILE_SIDE_LIVE_SITES * H)
+           npt.GetX() < (s32) grid.GetWidthSites() &&
+           npt.GetY() < (s32) grid.GetHeightSites())
         {
           if(Atom<CC>::IsType(*grid.GetAtom(npt),
                               m_bucketFillStartType))
@@ -204,16 +204,27 @@ namespace MFM {
         {
           Tile<CC> * t = *i;
           ElementTable<CC> & et = t->GetElementTable();
-          u64 * eds = et.GetElementDataSlotsFromType(m_elementType,m_outOfSlots);
-          if (!eds)
+          if (endOfEpoch && m_resetOnRead)
           {
+            // Resetting writes the live slots, so this relies on the
+            // grid being paused at the end of an epoch
+            u64 * eds = et.GetElementDataSlotsFromType(m_elementType,m_outOfSlots);
+            if (!eds)
+            {
+              continue;
+            }
+            sum += eds[m_slot];
+            eds[m_slot] = 0;
+            t->PublishStats();
             continue;
           }
-          sum += eds[m_slot];
-          if (endOfEpoch && m_resetOnRead)
+
+          s32 start = et.GetElementDataStartFromType(m_elementType,m_outOfSlots);
+          if (start < 0)
           {
-            eds[m_slot] = 0;
+            continue;
           }
+          sum += t->GetPublishedElementData(start + m_slot);
         }
 
         return (double) sum;
@@ -32,6 +32,7 @@
 #include <sys/time.h>  /* for gettimeofday */
 #include <sys/types.h> /* for mkdir */
 #include <errno.h>     /* for errno */
+#include <string.h>    /* for strcmp */
 #include "Util.h"
 #include "Utils.h"     /* for GetDateTimeNow, Sleep */
 #include "ExternalConfig.h"
@@ -85,18 +86,6 @@ namespace MFM
      */
     typedef typename CC::ATOM_TYPE T;
 
-    /**
-     * Exported from the GridConfiguration, the enumerated width of
-     * the Grid used by this simulation.
-     */
-    enum { W = GC::GRID_WIDTH};
-
-    /**
-     * Exported from the GridConfiguration, the enumerated height of
-     * the Grid used by this simulation.
-     */
-    enum { H = GC::GRID_HEIGHT};
-
     /**
      * Exported from the GridConfiguration, the enumerated size of
      * every EventWindow used by this simulation.
@@ -109,14 +98,16 @@ namespace MFM
     static const u32 EVENT_WINDOW_RADIUS = R;
 
     /**
-     * The width of the Grid used by this simulation.
+     * The width, in Tiles, of the Grid used by this simulation unless
+     * the driver or the command line says otherwise.
      */
-    static const u32 GRID_WIDTH = W;
+    static const u32 DEFAULT_GRID_WIDTH = 5;
 
     /**
-     * The height of the Grid used by this simulation.
+     * The height, in Tiles, of the Grid used by this simulation
+     * unless the driver or the command line says otherwise.
      */
-    static const u32 GRID_HEIGHT = H;
+    static const u32 DEFAULT_GRID_HEIGHT = 3;
 
     /**
      * Template shortcut for an ElementRegistry with the correct
@@ -168,6 +159,12 @@ namespace MFM
       const s32 ONE_THOUSAND = 1000;
       const s32 ONE_MILLION = ONE_THOUSAND*ONE_THOUSAND;
 
+      if (grid.IsDeterministic())
+      {
+        // A round is one AEPS, so this frame's work is exact
+        grid.GrantDeterministicRounds(m_aepsPerFrame);
+      }
+
       grid.Unpause();  // pausing and unpausing should be overhead!
 
       u32 startMS = GetTicks();  // So get the ticks after unpausing
@@ -176,8 +173,15 @@ namespace MFM
       else
         m_msSpentOverhead = 0;
 
-      Sleep(m_microsSleepPerFrame/ONE_MILLION,
-            (u64) (m_microsSleepPerFrame%ONE_MILLION)*ONE_THOUSAND);
+      if (grid.IsDeterministic())
+      {
+        grid.WaitForDeterministicRounds();
+      }
+      else
+      {
+        Sleep(m_microsSleepPerFrame/ONE_MILLION,
+              (u64) (m_microsSleepPerFrame%ONE_MILLION)*ONE_THOUSAND);
+      }
 
       m_ticksLastStopped = GetTicks(); // and before pausing
 
@@ -392,6 +396,12 @@ namespace MFM
     u32 m_ticksLastStopped;
     u32 m_haltAfterAEPS;
 
+    /**
+     * If true, LOG stays synchronous rather than writing from a
+     * background thread
+     */
+    bool m_syncLogging;
+
     u64 m_startTimeMS;
     u64 m_msSpentRunning;
     u64 m_msSpentOverhead;
@@ -470,6 +480,16 @@ namespace MFM
       LOG.SetLevel(atoi(level));
     }
 
+    static void SetSyncLogging(const char* not_needed, void* driverptr)
+    {
+      ((AbstractDriver*)driverptr)->m_syncLogging = true;
+    }
+
+    static void StopAsyncLogging()
+    {
+      LOG.StopAsync();
+    }
+
     static void SetSeedFromArgs(const char* seedstr, void* driver)
     {
       u32 seed = atoi(seedstr);
@@ -480,6 +500,69 @@ namespace MFM
       ((AbstractDriver*)driver)->SetSeed(seed);
     }
 
+    static void SetRandomBackendFromArgs(const char* name, void* driverptr)
+    {
+      AbstractDriver& driver = *((AbstractDriver*)driverptr);
+      VArguments& args = driver.m_varguments;
+
+      if (!strcmp(name, "mt"))
+      {
+        driver.GetGrid().SetRandomBackend(RANDOM_BACKEND_MT);
+      }
+      else if (!strcmp(name, "philox"))
+      {
+        driver.GetGrid().SetRandomBackend(RANDOM_BACKEND_PHILOX);
+      }
+      else
+      {
+        args.Die("PRNG must be 'mt' or 'philox', not '%s'", name);
+      }
+    }
+
+    static void SetWorkerThreadsFromArgs(const char* workersStr, void* driverptr)
+    {
+      AbstractDriver& driver = *((AbstractDriver*)driverptr);
+      VArguments& args = driver.m_varguments;
+
+      s32 workers = atoi(workersStr);
+      if (workers < 0 || workers > (s32) TileExecutor<CC>::MAX_WORKERS)
+      {
+        args.Die("Worker threads must be 0..%d, not %d",
+                 TileExecutor<CC>::MAX_WORKERS, workers);
+      }
+      driver.GetGrid().SetWorkerThreads(workers);
+    }
+
+    static void SetGridDimensionsFromArgs(const char* dimStr, void* driverptr)
+    {
+      AbstractDriver& driver = *((AbstractDriver*)driverptr);
+      VArguments& args = driver.m_varguments;
+
+      u32 width, height;
+      char extra;
+      if (sscanf(dimStr, "%ux%u%c", &width, &height, &extra) != 2 ||
+          width == 0 || height == 0)
+      {
+        args.Die("Grid size must be WIDTHxHEIGHT in tiles, like 5x3, not '%s'", dimStr);
+      }
+      driver.SetGridDimensions(width, height);
+    }
+
+    static void SetDeterministic(const char* not_needed, void* driverptr)
+    {
+      ((AbstractDriver*)driverptr)->GetGrid().SetEventSchedule(SCHEDULE_DETERMINISTIC);
+    }
+
+    static void SetCheckerboard(const char* not_needed, void* driverptr)
+    {
+      ((AbstractDriver*)driverptr)->GetGrid().SetEventSchedule(SCHEDULE_CHECKERBOARD);
+    }
+
+    static void SetBatched(const char* not_needed, void* driverptr)
+    {
+      ((AbstractDriver*)driverptr)->GetGrid().SetEventSchedule(SCHEDULE_BATCHED);
+    }
+
     static void SetAEPSPerEpochFromArgs(const char* aepsStr, void* driverptr)
     {
       AbstractDriver& driver = *((AbstractDriver*)driverptr);
@@ -703,18 +786,28 @@ namespace MFM
 
 
     /**
-     * Method to do end-of-epoch processing.  Base class recounts the
-     * grid and handles --gridImage and --tileImage processing here,
-     * so all subclasses should override this method and do
-     * Super::DoEpochEvents to ensure all methods are called.
+     * Method to do end-of-epoch processing.  Base class repairs
+     * corrupted atoms, checks the caches, and handles --gridImage
+     * and --tileImage processing here, so all subclasses should
+     * override this method and do Super::DoEpochEvents to ensure
+     * all methods are called.
      */
     virtual void DoEpochEvents(OurGrid& grid, u32 epochs, u32 epochAEPS)
     {
       LOG.Debug("Epoch %d: %d AEPS", epochs, epochAEPS);
 
+      u32 repaired, erased;
+      grid.CheckAndRepairAtoms(repaired, erased);
+      if (repaired + erased > 0)
+      {
+        LOG.Message("Epoch %d: %d atoms repaired, %d erased", epochs, repaired, erased);
+      }
+
       grid.CheckCaches();
 
-      grid.RecountAtoms();
+#ifdef MFM_DEBUG
+      grid.AssertValidAtomCounts();
+#endif
 
       if (m_gridImages)
       {
@@ -757,9 +850,10 @@ namespace MFM
 
     AbstractDriver() :
       m_neededElementCount(0),
-      m_grid(m_elementRegistry),
+      m_grid(m_elementRegistry, DEFAULT_GRID_WIDTH, DEFAULT_GRID_HEIGHT),
       m_ticksLastStopped(0),
       m_haltAfterAEPS(0),
+      m_syncLogging(false),
       m_startTimeMS(0),
       m_msSpentRunning(0),
       m_msSpentOverhead(0),
@@ -790,6 +884,12 @@ namespace MFM
 
       m_varguments.ProcessArguments(argc, argv);
 
+      if (!m_syncLogging)
+      {
+        LOG.StartAsync();
+        atexit(StopAsyncLogging);  // Flush before the sinks go away
+      }
+
       m_startTimeMS = GetTicks();
 
       OnceOnly(m_varguments);
@@ -832,6 +932,9 @@ namespace MFM
       RegisterArgument("Amount of logging output is ARG (0 -> none, 8 -> max)",
                        "-l|--log", &SetLoggingLevel, NULL, true);
 
+      RegisterArgument("Write log messages as they happen, instead of from a background thread",
+                       "--synclog", &SetSyncLogging, this, false);
+
       RegisterArgument("Print the brief version number, then exit.",
                        "-v|--version", &PrintVersion, NULL, false);
 
@@ -841,6 +944,24 @@ namespace MFM
       RegisterArgument("Set master PRNG seed to ARG (u32)",
                        "-s|--seed", &SetSeedFromArgs, this, true);
 
+      RegisterArgument("Use PRNG ARG: 'mt' (default; Mersenne Twister) or 'philox' (faster)",
+                       "--rng", &SetRandomBackendFromArgs, this, true);
+
+      RegisterArgument("Make the grid ARG tiles in size, as WIDTHxHEIGHT (e.g., 5x3)",
+                       "-g|--grid", &SetGridDimensionsFromArgs, this, true);
+
+      RegisterArgument("Run tiles on ARG worker threads (default 0: one thread per tile)",
+                       "-w|--workers", &SetWorkerThreadsFromArgs, this, true);
+
+      RegisterArgument("Run reproducibly: events depend only on the seed, not on thread timing",
+                       "--deterministic", &SetDeterministic, this, false);
+
+      RegisterArgument("Take turns at tile boundaries by checkerboard color, instead of locking",
+                       "--checkerboard", &SetCheckerboard, this, false);
+
+      RegisterArgument("Execute interior events in batches grouped by element type",
+                       "--batched", &SetBatched, this, false);
+
       RegisterArgument("Set epoch length to ARG AEPS",
                        "-e|--epoch", &SetAEPSPerEpochFromArgs, this, true);
 
@@ -923,6 +1044,17 @@ namespace MFM
       return m_grid;
     }
 
+    /**
+     * Sets the size of the Grid, in Tiles.  Drivers that want a size
+     * other than DEFAULT_GRID_WIDTH by DEFAULT_GRID_HEIGHT should
+     * call this before Init, so the command line can still override
+     * it.
+     */
+    void SetGridDimensions(u32 width, u32 height)
+    {
+      m_grid.SetDimensions(width, height);
+    }
+
     void SetSeed(u32 seed)
     {
       if(!seed)
@@ -955,6 +1087,7 @@ namespace MFM
     {
       unwind_protect
       ({
+        LOG.StopAsync();
         MFMPrintErrorEnvironment(stderr, &unwindProtect_errorEnvironment);
         fprintf(stderr, "Failure reached top-level! Aborting\n");
         abort();
@@ -962,6 +1095,13 @@ namespace MFM
        {
          RunHelper();
        });
+
+#ifdef MFM_INSTRUMENT
+      m_grid.ReportProfile(Logger::MESSAGE);  // RunHelper left it paused
+#endif
+
+      // Flush while the caller's sink and time stamper still exist
+      LOG.StopAsync();
     }
   };
 }
@@ -30,6 +30,7 @@
 
 #include "itype.h"
 #include "Tile.h"
+#include "TileExecutor.h"
 #include "ElementTable.h"
 #include "Random.h"
 #include "GridConfig.h"
@@ -50,8 +51,6 @@ namespace MFM {
     typedef typename GC::CORE_CONFIG CC;
     typedef typename CC::ATOM_TYPE T;
     typedef typename CC::PARAM_CONFIG P;
-    enum { W = GC::GRID_WIDTH};
-    enum { H = GC::GRID_HEIGHT};
     enum { R = P::EVENT_WINDOW_RADIUS};
 
   private:
@@ -59,13 +58,39 @@ namespace MFM {
 
     u32 m_seed;
 
+    /**
+     * The generator that ReinitSeed selects for this Grid and its
+     * Tiles
+     */
+    RandomBackend m_randomBackend;
+
     void ReinitSeed();
 
-    const u32 m_width, m_height;
+    /**
+     * The size of this Grid, in Tiles
+     */
+    u32 m_width, m_height;
 
     SPoint m_lastEventTile;
 
-    Tile<CC> m_tiles[W][H];
+    /**
+     * The m_width * m_height Tiles of this Grid, column by column;
+     * see GetTile(u32, u32).
+     */
+    Tile<CC> * m_tiles;
+
+    /**
+     * Allocates and constructs \c count Tiles at the alignment Tile
+     * declares (its Connections keep each ThreadQueue index on a
+     * cache line of its own), which new[] does not honor before
+     * C++17.
+     */
+    static Tile<CC> * NewTiles(u32 count) ;
+
+    /**
+     * Destroys and frees \c count Tiles from NewTiles.
+     */
+    static void DeleteTiles(Tile<CC> * tiles, u32 count) ;
 
     bool m_backgroundRadiationEnabled;
 
@@ -75,6 +100,50 @@ namespace MFM {
 
     u8 m_gridGeneration;
 
+    /**
+     * The number of worker threads to run the tiles on, or 0 to give
+     * each tile its own thread.
+     */
+    u32 m_workerThreads;
+
+    /**
+     * Runs the tiles when m_workerThreads is nonzero.
+     */
+    TileExecutor<CC> m_executor;
+
+    /**
+     * Every tile arrives here as it becomes ready to pause or to run,
+     * so DoTileControl can sleep until the last one does.
+     */
+    ThreadBarrier m_tileControlBarrier;
+
+    /**
+     * How long DoTileControl waits for all tiles to become ready
+     * before deciding the grid is wedged.
+     */
+    static const u32 TILE_CONTROL_TIMEOUT_MILLIS = 10000;
+
+    /**
+     * How the tiles decide when to execute their events.
+     */
+    EventSchedule m_eventSchedule;
+
+    /**
+     * Paces the tiles in the phased EventSchedules.
+     */
+    PhaseClock m_phaseClock;
+
+    /**
+     * Resets m_phaseClock and hands it, with m_eventSchedule, to
+     * every tile, along with its checkerboard color.
+     */
+    void ConfigurePhaseClocks();
+
+    /**
+     * Makes every tile threadless and hands them all to m_executor .
+     */
+    void StartExecutor();
+
     /**
      * A synchronized command sequence to the grid
      */
@@ -144,6 +213,24 @@ namespace MFM {
   public:
     void ReportGridStatus(Logger::Level level) ;
 
+#ifdef MFM_INSTRUMENT
+    /**
+     * Adds the Profiles of all Tiles into \c total .  Element times
+     * are combined by element table index, which is the same in every
+     * Tile since all get the same Elements in the same order.  Only
+     * call this while the grid is paused.
+     */
+    void GetProfile(typename Tile<CC>::Profile & total) const ;
+
+    /**
+     * Logs the combined Profile of all Tiles.  Only call this while
+     * the grid is paused.
+     */
+    void ReportProfile(Logger::Level level) const ;
+
+    void ResetProfiles() ;
+#endif
+
     Random& GetRandom() { return m_random; }
 
     bool* GetBackgroundRadiationEnabledPointer()
@@ -155,23 +242,57 @@ namespace MFM {
 
     void SetSeed(u32 seed);
 
-    Grid(ElementRegistry<CC>& elts) :
+    /**
+     * Selects the PRNG used by this Grid and its Tiles.  Takes effect,
+     * along with the seed, at the next Reinit.
+     */
+    void SetRandomBackend(RandomBackend backend)
+    {
+      if (backend >= RANDOM_BACKEND_COUNT)
+      {
+        FAIL(ILLEGAL_ARGUMENT);
+      }
+      m_randomBackend = backend;
+    }
+
+    RandomBackend GetRandomBackend() const
+    {
+      return m_randomBackend;
+    }
+
+    /**
+     * Constructs a new Grid of \c width by \c height Tiles.
+     *
+     * @sa SetDimensions
+     */
+    Grid(ElementRegistry<CC>& elts, u32 width, u32 height) :
       m_seed(0),
-      m_width(W),
-      m_height(H),
+      m_randomBackend(RANDOM_BACKEND_MT),
+      m_width(0),
+      m_height(0),
+      m_tiles(0),
       m_er(elts),
       m_xraySiteOdds(1000),
-      m_gridGeneration(0)
+      m_gridGeneration(0),
+      m_workerThreads(0),
+      m_eventSchedule(SCHEDULE_LOCKING)
     {
-      for (u32 y = 0; y < H; ++y)
-      {
-        for (u32 x = 0; x < W; ++x)
-        {
-          LOG.Debug("Tile[%d][%d] @ %p", x, y, &m_tiles[x][y]);
-        }
-      }
+      SetDimensions(width, height);
     }
 
+    /**
+     * Discards all of this Grid's Tiles, and replaces them with \c
+     * width by \c height new ones.  Must be called before the first
+     * Unpause, and followed by Reinit.  FAILs with ILLEGAL_ARGUMENT
+     * if either dimension is zero, or with ILLEGAL_STATE if the Grid
+     * has already been run on worker threads.
+     *
+     * @param width The new number of columns of Tiles
+     *
+     * @param height The new number of rows of Tiles
+     */
+    void SetDimensions(u32 width, u32 height);
+
     s32* GetXraySiteOddsPtr()
     {
       return &m_xraySiteOdds;
@@ -181,7 +302,7 @@ namespace MFM {
 
     const Element<CC> * LookupElement(u32 elementType) const
     {
-      return m_tiles[0][0].GetElementTable().Lookup(elementType);
+      return GetTile(0, 0).GetElementTable().Lookup(elementType);
     }
 
     ElementRegistry<CC>& GetElementRegistry()
@@ -194,11 +315,11 @@ namespace MFM {
       anElement.AllocateType();         // Force a type now
       m_er.RegisterElement(anElement);  // Make sure we're in here (How could we not?)
 
-      for(u32 i = 0; i < W; i++)
+      for(u32 i = 0; i < m_width; i++)
       {
-        for(u32 j = 0; j < H; j++)
+        for(u32 j = 0; j < m_height; j++)
         {
-          m_tiles[i][j].RegisterElement(anElement);
+          GetTile(i, j).RegisterElement(anElement);
         }
       }
       LOG.Message("Assigned type 0x%04x for %@",anElement.GetType(),&anElement.GetUUID());
@@ -218,10 +339,10 @@ namespace MFM {
       bool operator!=(const MyIterator &m) const { return i != m.i || j != m.j; }
       void operator++()
       {
-        if (j < g.H)
+        if (j < (s32) g.m_height)
         {
           i++;
-          if (i >= g.W)
+          if (i >= (s32) g.m_width)
           {
             i = 0;
             j++;
@@ -232,12 +353,12 @@ namespace MFM {
       {
         s32 rows = j-m.j;
         s32 cols = i-m.i;
-        return rows*g.W + cols;
+        return rows*g.m_width + cols;
       }
 
       PointerType operator*() const
       {
-        return &g.m_tiles[i][j];
+        return &g.GetTile(i, j);
       }
     };
 
@@ -248,12 +369,15 @@ namespace MFM {
 
     const_iterator_type begin() const { return iterator_type(*this); }
 
-    iterator_type end() { return iterator_type(*this,0,H); }
+    iterator_type end() { return iterator_type(*this,0,m_height); }
 
-    const_iterator_type end() const { return const_iterator_type(*this, 0,H); }
+    const_iterator_type end() const { return const_iterator_type(*this, 0,m_height); }
 
     ~Grid()
-    { }
+    {
+      m_executor.Stop();
+      DeleteTiles(m_tiles, m_width * m_height);
+    }
 
     /**
      * Used to tell this Tile whether or not to actually execute any
@@ -286,6 +410,7 @@ namespace MFM {
     {
       Tile<CC> & tile = GetTile(tileLoc);
       tile.ClearAtoms();
+      tile.PublishStats();  // So the clear shows up while paused
       tile.SetGeneration(m_gridGeneration);
     }
 
@@ -334,17 +459,17 @@ namespace MFM {
     /**
      * Return the Grid height in Tiles
      */
-    static u32 GetHeight() { return H; }
+    u32 GetHeight() const { return m_height; }
 
     /**
      * Return the Grid width in Tiles
      */
-    static u32 GetWidth() { return W; }
+    u32 GetWidth() const { return m_width; }
 
     /**
      * Return the Grid height in (non-cache) sites
      */
-    static u32 GetHeightSites()
+    u32 GetHeightSites() const
     {
       return GetHeight() * Tile<CC>::OWNED_SIDE;
     }
@@ -352,7 +477,7 @@ namespace MFM {
     /**
      * Return the Grid width in (non-cache) sites
      */
-    static u32 GetWidthSites()
+    u32 GetWidthSites() const
     {
       return GetWidth() * Tile<CC>::OWNED_SIDE;
     }
@@ -366,11 +491,90 @@ namespace MFM {
       DoTileControl(pc);
     }
 
+    /**
+     * Sets how many worker threads will run this Grid's tiles.  Must
+     * be called before the first Unpause.  FAILs with
+     * ILLEGAL_ARGUMENT if \c count exceeds the executor's maximum.
+     *
+     * @param count The number of worker threads, or 0 (the default)
+     *              to give each tile its own thread.
+     */
+    void SetWorkerThreads(u32 count)
+    {
+      if (count > TileExecutor<CC>::MAX_WORKERS)
+      {
+        FAIL(ILLEGAL_ARGUMENT);
+      }
+      m_workerThreads = count;
+    }
+
+    u32 GetWorkerThreads() const
+    {
+      return m_workerThreads;
+    }
+
+    /**
+     * Sets how this Grid's tiles decide when to execute their events.
+     * Must be called while paused.
+     *
+     * In SCHEDULE_DETERMINISTIC, the grid's evolution depends only on
+     * the master seed and not on thread scheduling.  Events then
+     * happen in rounds, each one AEPS, and only as many rounds as
+     * have been granted by GrantDeterministicRounds.
+     *
+     * In SCHEDULE_CHECKERBOARD, tiles take turns, by checkerboard
+     * color, executing the events that could conflict with their
+     * neighbors', so no events need Connection locks.
+     *
+     * In SCHEDULE_BATCHED, events lock as usual, but tiles execute
+     * their interior events in small batches grouped by element type.
+     *
+     * @sa Tile::SetEventSchedule
+     */
+    void SetEventSchedule(EventSchedule schedule)
+    {
+      m_eventSchedule = schedule;
+      ConfigurePhaseClocks();
+    }
+
+    EventSchedule GetEventSchedule() const
+    {
+      return m_eventSchedule;
+    }
+
+    bool IsDeterministic() const
+    {
+      return m_eventSchedule == SCHEDULE_DETERMINISTIC;
+    }
+
+    /**
+     * In deterministic mode, allows \c rounds more rounds of events
+     * to happen while the grid is unpaused.
+     */
+    void GrantDeterministicRounds(u32 rounds)
+    {
+      m_phaseClock.Grant(rounds * Tile<CC>::DETERMINISTIC_PHASES_PER_ROUND);
+    }
+
+    /**
+     * In deterministic mode, blocks until every round granted so far
+     * has completed.  The grid must be unpaused.
+     */
+    void WaitForDeterministicRounds()
+    {
+      m_phaseClock.WaitForLimit();
+    }
+
     /**
      * Synchronize and unpause the entire grid
      */
     void Unpause()
     {
+      if (m_workerThreads > 0 && !m_executor.IsStarted())
+      {
+        StartExecutor();
+      }
+
       RunControl rc;
       DoTileControl(rc);
     }
@@ -381,6 +585,24 @@ namespace MFM {
      */
     void RecountAtoms();
 
+    /**
+     * FAILs unless the incrementally-kept atom counts of every tile
+     * match a full count.  Slow; for debugging.  Should only be
+     * called while the Grid is paused.
+     */
+    void AssertValidAtomCounts() const;
+
+    /**
+     * Checks the ECC of every site of every tile in this Grid,
+     * repairing what can be repaired and emptying the rest.  Should
+     * only be called while the Grid is paused.
+     *
+     * @param repaired Set to the number of atoms repaired.
+     *
+     * @param erased Set to the number of unrepairable atoms emptied.
+     */
+    void CheckAndRepairAtoms(u32 & repaired, u32 & erased);
+
     void PlaceAtom(const T& atom, const SPoint& location);
 
     void XRayAtom(const SPoint& location);
@@ -420,13 +642,13 @@ namespace MFM {
     {return GetTile(pt.GetX(), pt.GetY());}
 
     inline Tile<CC> & GetTile(u32 x, u32 y)
-    { return m_tiles[x][y]; }
+    { return m_tiles[x * m_height + y]; }
 
     inline const Tile<CC> & GetTile(u32 x, u32 y) const
-    { return m_tiles[x][y]; }
+    { return m_tiles[x * m_height + y]; }
 
     /* Don't count caches! */
-    static inline const u32 GetTotalSites()
+    inline u32 GetTotalSites() const
     { return GetWidthSites() * GetHeightSites(); }
 
     u64 GetTotalEventsExecuted() const;
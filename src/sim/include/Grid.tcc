@@ -3,6 +3,8 @@
 #include "Grid.h"
 #include "Utils.h"   /* For Sleep */
 #include "FileByteSink.h"
+#include <stdlib.h>  /* For posix_memalign, free */
+#include <new>       /* For placement new */
 
 #define XRAY_BIT_ODDS 100
 
@@ -32,6 +34,7 @@ namespace MFM {
         tbs.Printf("[%d,%d]", x, y);
 
         ctile.Reinit();
+        ctile.SetControlBarrier(&m_tileControlBarrier);
 
         neighbors = 0;
         if(x > 0)
@@ -76,6 +79,83 @@ namespace MFM {
         }
       }
     }
+
+    ConfigurePhaseClocks();
+  }
+
+  template <class GC>
+  void Grid<GC>::ConfigurePhaseClocks()
+  {
+    m_phaseClock.Reset(m_width * m_height);
+    for(u32 x = 0; x < m_width; x++)
+    {
+      for(u32 y = 0; y < m_height; y++)
+      {
+        // Neighbors differ in x or y parity, so never share a color
+        u32 color = (x & 1) | ((y & 1) << 1);
+        GetTile(x, y).SetEventSchedule(m_eventSchedule, &m_phaseClock, color);
+      }
+    }
+  }
+
+  template <class GC>
+  void Grid<GC>::SetDimensions(u32 width, u32 height)
+  {
+    if (width == 0 || height == 0)
+    {
+      FAIL(ILLEGAL_ARGUMENT);
+    }
+    if (m_executor.IsStarted())
+    {
+      FAIL(ILLEGAL_STATE);
+    }
+
+    if (width != m_width || height != m_height)
+    {
+      DeleteTiles(m_tiles, m_width * m_height);
+      m_tiles = NewTiles(width * height);
+      m_width = width;
+      m_height = height;
+
+      for (u32 y = 0; y < m_height; ++y)
+      {
+        for (u32 x = 0; x < m_width; ++x)
+        {
+          LOG.Debug("Tile[%d][%d] @ %p", x, y, &GetTile(x, y));
+        }
+      }
+    }
+  }
+
+  template <class GC>
+  Tile<typename GC::CORE_CONFIG> * Grid<GC>::NewTiles(u32 count)
+  {
+    void * mem = 0;
+    if (posix_memalign(&mem, __alignof__(Tile<CC>), count * sizeof(Tile<CC>)))
+    {
+      FAIL(OUT_OF_ROOM);
+    }
+
+    Tile<CC> * tiles = (Tile<CC> *) mem;
+    for (u32 i = 0; i < count; ++i)
+    {
+      new (&tiles[i]) Tile<CC>();
+    }
+    return tiles;
+  }
+
+  template <class GC>
+  void Grid<GC>::DeleteTiles(Tile<CC> * tiles, u32 count)
+  {
+    if (!tiles)
+    {
+      return;
+    }
+    for (u32 i = count; i-- > 0; )
+    {
+      tiles[i].~Tile<CC>();
+    }
+    free(tiles);
   }
 
   template <class GC>
@@ -92,12 +172,14 @@ namespace MFM {
       FAIL(ILLEGAL_STATE);
     }
 
+    m_random.SetBackend(m_randomBackend);
     m_random.SetSeed(m_seed);
-    for(u32 i = 0; i < W; i++)
+    for(u32 i = 0; i < m_width; i++)
     {
-      for(u32 j = 0; j < H; j++)
+      for(u32 j = 0; j < m_height; j++)
         {
-          m_tiles[i][j].GetRandom().SetSeed(m_random.Create());
+          GetTile(i, j).GetRandom().SetBackend(m_randomBackend);
+          GetTile(i, j).GetRandom().SetSeed(m_random.Create());
         }
     }
   }
@@ -106,7 +188,7 @@ namespace MFM {
   void Grid<GC>::SetTileToExecuteOnly(const SPoint& tileLoc, bool value)
   {
     if(tileLoc.GetX() >= 0 && tileLoc.GetY() >= 0 &&
-       tileLoc.GetX() < W  && tileLoc.GetY() < H)
+       tileLoc.GetX() < (s32) m_width && tileLoc.GetY() < (s32) m_height)
     {
       GetTile(tileLoc).SetExecuteOwnEvents(value);
     }
@@ -123,7 +205,7 @@ namespace MFM {
   {
     if (tileInGrid.GetX() < 0 || tileInGrid.GetY() < 0)
       return false;
-    if (tileInGrid.GetX() >= (s32) W || tileInGrid.GetY() >= (s32) H)
+    if (tileInGrid.GetX() >= (s32) m_width || tileInGrid.GetY() >= (s32) m_height)
       return false;
     return true;
   }
@@ -159,9 +241,34 @@ namespace MFM {
   template <class GC>
   void Grid<GC>::RecountAtoms()
   {
-    for(u32 i = 0; i < W; i++)
-      for(u32 j = 0; j < H; j++)
-        m_tiles[i][j].RecountAtoms();
+    for(u32 i = 0; i < m_width; i++)
+      for(u32 j = 0; j < m_height; j++)
+      {
+        Tile<CC> & tile = GetTile(i, j);
+        tile.RecountAtoms();
+        tile.PublishStats();
+      }
+  }
+
+  template <class GC>
+  void Grid<GC>::AssertValidAtomCounts() const
+  {
+    for(u32 i = 0; i < m_width; i++)
+      for(u32 j = 0; j < m_height; j++)
+        GetTile(i, j).AssertValidAtomCounts();
+  }
+
+  template <class GC>
+  void Grid<GC>::CheckAndRepairAtoms(u32 & repaired, u32 & erased)
+  {
+    repaired = erased = 0;
+    for(u32 i = 0; i < m_width; i++)
+      for(u32 j = 0; j < m_height; j++)
+      {
+        Tile<CC> & tile = GetTile(i, j);
+        tile.CheckAndRepairAtoms(repaired, erased);
+        tile.PublishStats();
+      }
   }
 
   template <class GC>
@@ -176,6 +283,7 @@ namespace MFM {
 
     Tile<CC> & owner = GetTile(tileInGrid);
     owner.PlaceAtom(atom, siteInTile);
+    owner.PublishStats();  // Only owned sites are counted
 
     Dir startDir = owner.SharedAt(siteInTile);
 
@@ -231,6 +339,7 @@ namespace MFM {
 
     Tile<CC> & owner = GetTile(tileInGrid);
     owner.SingleXRay(siteInTile.GetX(), siteInTile.GetY());
+    owner.PublishStats();
 
     /* This doesn't focus on xraying across caches, which I suppose is
      * the correct behavior. */
@@ -247,9 +356,9 @@ namespace MFM {
     LOG.Log(level," Background radiation: %s", m_backgroundRadiationEnabled?"true":"false");
     LOG.Log(level," Xray odds: %d", m_xraySiteOdds);
 
-    for(u32 x = 0; x < W; x++)
+    for(u32 x = 0; x < m_width; x++)
     {
-      for(u32 y = 0; y < H; y++)
+      for(u32 y = 0; y < m_height; y++)
       {
         Tile<CC> & tile = GetTile(x,y);
         LOG.Log(level,"--Grid(%d,%d)=Tile %s (%p)--",
@@ -259,68 +368,133 @@ namespace MFM {
     }
   }
 
+#ifdef MFM_INSTRUMENT
   template <class GC>
-  void Grid<GC>::DoTileControl(TileControl & tc)
+  void Grid<GC>::GetProfile(typename Tile<CC>::Profile & total) const
   {
-    // Issue request to all
-    for(u32 x = 0; x < W; x++)
+    total.Clear();
+    for(u32 x = 0; x < m_width; x++)
     {
-      for(u32 y = 0; y < H; y++)
+      for(u32 y = 0; y < m_height; y++)
       {
-        tc.MakeRequest(GetTile(x, y));
+        total.Add(GetTile(x, y).GetProfile());
       }
     }
+  }
 
-    // Wait until all acknowledge
-    u32 loops = 0;
-    u32 notReady = 0;
-    s32 sleepTimer = 0;
-    do
+  template <class GC>
+  void Grid<GC>::ReportProfile(Logger::Level level) const
+  {
+    typename Tile<CC>::Profile profile;
+    GetProfile(profile);
+
+    LOG.Log(level,"===GRID PROFILE (times in %s)===", ProfileClock::GetUnits());
+    LOG.Log(level," Most events awaiting acknowledgment: %d",
+            profile.m_pendingEventsHighWater);
+    for(Dir dir = Dirs::NORTH; dir < Dirs::DIR_COUNT; ++dir)
     {
-      if (++loops >= 100000)
-      {
-        LOG.Error("%s control looped %d times, but %d still not ready, killing",
-                  tc.GetName(), loops, notReady);
-        ReportGridStatus(Logger::ERROR);
-        FAIL(ILLEGAL_STATE);
+      OString128 line;
+      line.Printf(" %s: lock busy ", Dirs::GetName(dir));
+      line.Print(profile.m_lockBusy[dir]);
+      line.Print(", ack window full ");
+      line.Print(profile.m_lockWindowFull[dir]);
+      line.Printf(", most input %d bytes", profile.m_inputHighWater[dir]);
+      LOG.Log(level, "%s", line.GetZString());
+    }
+
+    profile.m_flushWait.Report(level, " Flush and wait");
+
+    for (u32 r = 0; r < REGION_COUNT; ++r)
+    {
+      const char * lab = "";
+      switch (r) {
+      case REGION_CACHE: lab = " Events (Cache)"; break;
+      case REGION_SHARED: lab = " Events (Shared)"; break;
+      case REGION_VISIBLE: lab = " Events (Visible)"; break;
+      case REGION_HIDDEN: lab = " Events (Hidden)"; break;
       }
+      profile.m_regionEventTime[r].Report(level, lab);
+    }
 
-      if (--sleepTimer < 0)
+    const ElementTable<CC> & et = GetTile(0, 0).GetElementTable();
+    for (u32 i = 0; i < ElementTable<CC>::SIZE; ++i)
+    {
+      const Element<CC> * elt = et.GetElementAtIndex(i);
+      if (elt)
       {
-        Sleep(0, loops);  // Actually sleeping seems to avoid rare livelock?
-        sleepTimer = m_random.Create(1000);
+        OString64 lab;
+        lab.Printf(" Events (%s)", elt->GetName());
+        profile.m_elementEventTime[i].Report(level, lab.GetZString());
       }
-      else
+    }
+  }
+
+  template <class GC>
+  void Grid<GC>::ResetProfiles()
+  {
+    for(u32 x = 0; x < m_width; x++)
+    {
+      for(u32 y = 0; y < m_height; y++)
       {
-        pthread_yield();
+        GetTile(x, y).ResetProfile();
       }
+    }
+  }
+#endif
 
-      notReady = 0;
+  template <class GC>
+  void Grid<GC>::StartExecutor()
+  {
+    const u32 count = m_width * m_height;
+    Tile<CC> ** tiles = new Tile<CC> * [count];
+    for(u32 i = 0; i < count; i++)
+    {
+      m_tiles[i].SetThreadless(true);
+      tiles[i] = &m_tiles[i];
+    }
+    m_executor.Start(m_workerThreads, tiles, count);
+    delete [] tiles;
+  }
 
-      for(u32 x = 0; x < W; x++)
+  template <class GC>
+  void Grid<GC>::DoTileControl(TileControl & tc)
+  {
+    // Open the barrier before anyone can arrive at it
+    u32 generation = m_tileControlBarrier.Begin(m_width * m_height);
+
+    // Issue request to all
+    for(u32 x = 0; x < m_width; x++)
+    {
+      for(u32 y = 0; y < m_height; y++)
       {
-        for(u32 y = 0; y < H; y++)
+        tc.MakeRequest(GetTile(x, y));
+      }
+    }
+
+    // Sleep until the last tile acknowledges
+    if (!m_tileControlBarrier.Wait(generation, TILE_CONTROL_TIMEOUT_MILLIS))
+    {
+      u32 notReady = 0;
+      for(u32 x = 0; x < m_width; x++)
+      {
+        for(u32 y = 0; y < m_height; y++)
         {
           if (!tc.CheckIfReady(GetTile(x, y)))
           {
             ++notReady;
-            pthread_yield();
           }
         }
       }
-
-    } while (notReady > 0);
-
-    if (loops > 1000)
-    {
-      LOG.Debug("%s control looped %d times",
-                tc.GetName(), loops);
+      LOG.Error("%s control waited %dms, but %d still not ready, killing",
+                tc.GetName(), TILE_CONTROL_TIMEOUT_MILLIS, notReady);
+      ReportGridStatus(Logger::ERROR);
+      FAIL(ILLEGAL_STATE);
     }
 
     // Release the hounds
-    for(u32 x = 0; x < W; x++)
+    for(u32 x = 0; x < m_width; x++)
     {
-      for(u32 y = 0; y < H; y++)
+      for(u32 y = 0; y < m_height; y++)
       {
         tc.Execute(GetTile(x, y));
       }
@@ -338,11 +512,11 @@ namespace MFM {
   u64 Grid<GC>::GetTotalEventsExecuted() const
   {
     u64 total = 0;
-    for(u32 x = 0; x < W; x++)
+    for(u32 x = 0; x < m_width; x++)
     {
-      for(u32 y = 0; y < H; y++)
+      for(u32 y = 0; y < m_height; y++)
       {
-        total += m_tiles[x][y].GetEventsExecuted();
+        total += GetTile(x, y).GetPublishedEventsExecuted();
       }
     }
     return total;
@@ -422,9 +596,9 @@ namespace MFM {
   u32 Grid<GC>::GetAtomCount(ElementType atomType) const
   {
     u32 total = 0;
-    for(u32 i = 0; i < W; i++)
-      for(u32 j = 0; j < H; j++)
-        total += m_tiles[i][j].GetAtomCount(atomType);
+    for(u32 i = 0; i < m_width; i++)
+      for(u32 j = 0; j < m_height; j++)
+        total += GetTile(i, j).GetPublishedAtomCount(atomType);
 
     return total;
   }
@@ -469,8 +643,8 @@ namespace MFM {
   {
     Random& rand = m_random;
 
-    SPoint center(rand.Create(W * CC::PARAM_CONFIG::TILE_WIDTH),
-		  rand.Create(H * CC::PARAM_CONFIG::TILE_WIDTH));
+    SPoint center(rand.Create(m_width * CC::PARAM_CONFIG::TILE_WIDTH),
+		  rand.Create(m_height * CC::PARAM_CONFIG::TILE_WIDTH));
 
     u32 radius = rand.Between(5, CC::PARAM_CONFIG::TILE_WIDTH);
     T atom(Element_Empty<CC>::THE_INSTANCE.GetDefaultAtom());
@@ -496,9 +670,9 @@ namespace MFM {
   void Grid<GC>::Clear()
   {
     ++m_gridGeneration;
-    for(u32 x = 0; x < W; x++)
+    for(u32 x = 0; x < m_width; x++)
     {
-      for(u32 y = 0; y < H; y++)
+      for(u32 y = 0; y < m_height; y++)
       {
 	EmptyTile(SPoint(x, y));
 
@@ -509,9 +683,9 @@ namespace MFM {
   template <class GC>
   void Grid<GC>::CheckCaches()
   {
-    for(u32 x = 0; x < W; x++)
+    for(u32 x = 0; x < m_width; x++)
     {
-      for(u32 y = 0; y < H; y++)
+      for(u32 y = 0; y < m_height; y++)
       {
         const SPoint usp(x,y);
 
@@ -533,9 +707,9 @@ namespace MFM {
   template <class GC>
   void Grid<GC>::SetBackgroundRadiation(bool value)
   {
-    for(u32 x = 0; x < W; x++)
+    for(u32 x = 0; x < m_width; x++)
     {
-      for(u32 y = 0; y < H; y++)
+      for(u32 y = 0; y < m_height; y++)
       {
 	GetTile(x, y).SetBackgroundRadiation(value);
       }
@@ -546,12 +720,13 @@ namespace MFM {
   template <class GC>
   void Grid<GC>::XRay()
   {
-    for(u32 x = 0; x < W; x++)
+    for(u32 x = 0; x < m_width; x++)
     {
-      for(u32 y = 0; y < H; y++)
+      for(u32 y = 0; y < m_height; y++)
       {
 	GetTile(x,y).XRay(m_xraySiteOdds,
 			  XRAY_BIT_ODDS);
+	GetTile(x,y).PublishStats();
       }
     }
   }
@@ -562,9 +737,9 @@ namespace MFM {
     u32 acc   = 0,
         sides = GetTile(0,0).GetSites();
 
-    for(u32 x = 0; x < W; x++)
+    for(u32 x = 0; x < m_width; x++)
     {
-      for(u32 y = 0; y < H; y++)
+      for(u32 y = 0; y < m_height; y++)
       {
 	acc += GetTile(x,y).GetExecutingOwnEvents() ? sides : 0;
       }
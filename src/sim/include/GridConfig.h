@@ -41,10 +41,12 @@ namespace MFM {
    * having to add it to thousands of template declarations throughout
    * the codebase, we just add it here, and then modify only the
    * template classes that need to use the new parameter.
+   *
+   * The Grid's width and height in tiles are not compile-time
+   * parameters; they are chosen at runtime, with
+   * Grid::SetDimensions .
    */
-  template <class CC,      // CoreConfig
-            u32 W = 5,     // Grid width in tiles
-            u32 H = 3>     // Grid height in tiles
+  template <class CC>      // CoreConfig
   struct GridConfig {
 
     /**
@@ -52,18 +54,6 @@ namespace MFM {
      */
     typedef CC CORE_CONFIG;
 
-    /**
-     * GRID_WIDTH is the number of columns of tiles in this Grid
-     * Configuration.
-     */
-    enum { GRID_WIDTH = W };
-
-    /**
-     * GRID_HEIGHT is the number of rows of tiles in this Grid
-     * Configuration.
-     */
-    enum { GRID_HEIGHT = H };
-
   };
 
 } /* namespace MFM */
@@ -0,0 +1,184 @@
+/*                                              -*- mode:C++ -*-
+  TileExecutor.h Runs Tiles on a fixed pool of worker threads
+  Copyright (C) 2014 The Regents of the University of New Mexico.  All rights reserved.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301
+  USA
+*/
+
+/**
+  \file TileExecutor.h Runs Tiles on a fixed pool of worker threads
+  \author David H. Ackley.
+  \date (C) 2014 All rights reserved.
+  \lgpl
+ */
+#ifndef TILEEXECUTOR_H
+#define TILEEXECUTOR_H
+
+#include <pthread.h>
+#include "itype.h"
+#include "Atomic.h"
+#include "Random.h"
+#include "Tile.h"
+#include "WorkStealingDeque.h"
+
+namespace MFM {
+
+  /**
+   * Runs a fixed set of threadless Tiles on a pool of worker
+   * threads, instead of giving each Tile a thread of its own.  Each
+   * worker repeatedly takes a Tile from its own deque, runs a
+   * quantum of that Tile's events with Tile::ExecuteQuantum, and
+   * sets it aside until its deque is empty, whereupon it steals from
+   * other workers' deques, or failing that starts a new round with
+   * the Tiles it set aside.  Tiles therefore migrate from busy workers
+   * to idle ones.
+   *
+   * Tiles hand each other atoms and acknowledgments exactly as they
+   * do when threaded; since Tile::ExecuteQuantum never waits on a
+   * neighbor, no worker can deadlock waiting for a Tile that is not
+   * currently scheduled.
+   *
+   * @param CC The CoreConfig of the Tiles run.
+   */
+  template <class CC>
+  class TileExecutor
+  {
+  public:
+
+    /**
+     * The most worker threads a TileExecutor can run.
+     */
+    static const u32 MAX_WORKERS = 32;
+
+    /**
+     * The default number of Tile event loop iterations a worker
+     * performs before moving on to another Tile.
+     */
+    static const u32 DEFAULT_STEPS_PER_QUANTUM = 100;
+
+  private:
+    /**
+     * How long a worker sleeps after finding nothing runnable.
+     */
+    enum { IDLE_SLEEP_NANOS = 100000 };
+
+    struct Worker
+    {
+      TileExecutor * m_executor;
+
+      u32 m_index;
+
+      pthread_t m_thread;
+
+      /** Used to choose which other workers to steal from. */
+      Random m_random;
+
+      /** The Tiles awaiting a quantum this round. */
+      WorkStealingDeque<Tile<CC> > m_deque;
+
+      /** The Tiles that have had their quantum this round. */
+      Tile<CC> ** m_finished;
+
+      u32 m_finishedCount;
+
+      Worker() : m_finished(0), m_finishedCount(0) { }
+
+      ~Worker()
+      {
+        delete [] m_finished;
+      }
+    };
+
+    Worker m_workers[MAX_WORKERS];
+
+    u32 m_workerCount;
+
+    u32 m_stepsPerQuantum;
+
+    Atomic<u32> m_running;
+
+    /**
+     * The body of each worker thread.
+     */
+    void RunWorker(Worker & worker);
+
+    /**
+     * Takes a Tile from some other worker's deque, if any has one.
+     *
+     * @returns The stolen Tile, or NULL if none was found.
+     */
+    Tile<CC> * StealFor(Worker & thief);
+
+    static void * WorkerThreadHelper(void * arg);
+
+    // Declare away copy ctor; worker threads point back at us
+    TileExecutor(const TileExecutor &);
+
+  public:
+
+    TileExecutor() :
+      m_workerCount(0),
+      m_stepsPerQuantum(DEFAULT_STEPS_PER_QUANTUM),
+      m_running(0)
+    { }
+
+    ~TileExecutor()
+    {
+      Stop();
+    }
+
+    /**
+     * Checks whether worker threads are currently running.
+     */
+    bool IsStarted() const
+    {
+      return m_workerCount > 0;
+    }
+
+    /**
+     * Sets how many Tile event loop iterations a worker performs
+     * before moving on to another Tile.  Must be called before Start.
+     */
+    void SetStepsPerQuantum(u32 steps);
+
+    /**
+     * Distributes \c tileCount Tiles among \c workers new worker
+     * threads and starts them running.  Each Tile must already have
+     * been made threadless (see Tile::SetThreadless); they will
+     * execute events once they are started and unpaused as usual.
+     * FAILs with ILLEGAL_STATE if already started, or with
+     * ILLEGAL_ARGUMENT if \c workers is out of range.
+     *
+     * @param workers The number of worker threads, at least 1 and at
+     *                most MAX_WORKERS .
+     *
+     * @param tiles The Tiles to run.
+     *
+     * @param tileCount The number of Tiles in \c tiles .
+     */
+    void Start(u32 workers, Tile<CC> ** tiles, u32 tileCount);
+
+    /**
+     * Stops and joins all worker threads, if any are running.  The
+     * Tiles should be paused first.
+     */
+    void Stop();
+  };
+} /* namespace MFM */
+
+#include "TileExecutor.tcc"
+
+#endif /*TILEEXECUTOR_H*/
@@ -0,0 +1,159 @@
+/* -*- C++ -*- */
+#include "TileExecutor.h"
+#include "Util.h"     /* For Sleep */
+#include "Logger.h"
+
+namespace MFM {
+
+  template <class CC>
+  void TileExecutor<CC>::SetStepsPerQuantum(u32 steps)
+  {
+    if (IsStarted())
+    {
+      FAIL(ILLEGAL_STATE);
+    }
+    if (steps == 0)
+    {
+      FAIL(ILLEGAL_ARGUMENT);
+    }
+    m_stepsPerQuantum = steps;
+  }
+
+  template <class CC>
+  void TileExecutor<CC>::Start(u32 workers, Tile<CC> ** tiles, u32 tileCount)
+  {
+    if (IsStarted())
+    {
+      FAIL(ILLEGAL_STATE);
+    }
+    if (workers == 0 || workers > MAX_WORKERS)
+    {
+      FAIL(ILLEGAL_ARGUMENT);
+    }
+
+    // Tiles migrate, so any one worker may end up holding them all
+    u32 capacity = 1;
+    while (capacity < tileCount)
+    {
+      capacity <<= 1;
+    }
+
+    for (u32 i = 0; i < workers; ++i)
+    {
+      Worker & w = m_workers[i];
+      w.m_executor = this;
+      w.m_index = i;
+      w.m_random.SetSeed(i + 1);
+      w.m_deque.SetCapacity(capacity);
+      delete [] w.m_finished;
+      w.m_finished = new Tile<CC> * [tileCount];
+      w.m_finishedCount = 0;
+    }
+
+    // Deal the tiles out like cards
+    for (u32 i = 0; i < tileCount; ++i)
+    {
+      m_workers[i % workers].m_deque.Push(tiles[i]);
+    }
+
+    m_workerCount = workers;
+    m_running.Store(1);
+
+    for (u32 i = 0; i < workers; ++i)
+    {
+      if (pthread_create(&m_workers[i].m_thread, NULL, WorkerThreadHelper, &m_workers[i]))
+      {
+        FAIL(ILLEGAL_STATE);
+      }
+    }
+    LOG.Debug("Running %d tiles on %d worker threads", tileCount, workers);
+  }
+
+  template <class CC>
+  void TileExecutor<CC>::Stop()
+  {
+    if (!IsStarted())
+    {
+      return;
+    }
+
+    m_running.Store(0);
+    for (u32 i = 0; i < m_workerCount; ++i)
+    {
+      pthread_join(m_workers[i].m_thread, NULL);
+    }
+    m_workerCount = 0;
+  }
+
+  template <class CC>
+  void * TileExecutor<CC>::WorkerThreadHelper(void * arg)
+  {
+    Worker * worker = (Worker *) arg;
+    worker->m_executor->RunWorker(*worker);
+    return NULL;
+  }
+
+  template <class CC>
+  Tile<CC> * TileExecutor<CC>::StealFor(Worker & thief)
+  {
+    u32 start = thief.m_random.Create(m_workerCount);
+    for (u32 i = 0; i < m_workerCount; ++i)
+    {
+      Worker & victim = m_workers[(start + i) % m_workerCount];
+      if (&victim == &thief)
+      {
+        continue;
+      }
+      Tile<CC> * tile = victim.m_deque.Steal();
+      if (tile)
+      {
+        return tile;
+      }
+    }
+    return 0;
+  }
+
+  template <class CC>
+  void TileExecutor<CC>::RunWorker(Worker & worker)
+  {
+    bool busy = false;  // Did any quantum this round do anything?
+
+    while (m_running.Load(MEMORY_ORDER_ACQUIRE))
+    {
+      Tile<CC> * tile = worker.m_deque.Take();
+      if (!tile)
+      {
+        tile = StealFor(worker);
+      }
+
+      if (!tile)
+      {
+        if (worker.m_finishedCount > 0)
+        {
+          // Nothing left anywhere this round; start our next one
+          for (u32 i = worker.m_finishedCount; i-- > 0; )
+          {
+            worker.m_deque.Push(worker.m_finished[i]);
+          }
+          worker.m_finishedCount = 0;
+        }
+
+        if (!busy)
+        {
+          // Everything we touched was paused, or there was nothing
+          // to touch at all.  Don't spin.
+          Sleep(0, IDLE_SLEEP_NANOS);
+        }
+        busy = false;
+        continue;
+      }
+
+      if (tile->ExecuteQuantum(m_stepsPerQuantum))
+      {
+        busy = true;
+      }
+      worker.m_finished[worker.m_finishedCount++] = tile;
+    }
+  }
+
+} /* namespace MFM */
@@ -0,0 +1,206 @@
+/*                                              -*- mode:C++ -*-
+  WorkStealingDeque.h Fixed-capacity Chase-Lev work-stealing deque
+  Copyright (C) 2014 The Regents of the University of New Mexico.  All rights reserved.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301
+  USA
+*/
+
+/**
+  \file WorkStealingDeque.h Fixed-capacity Chase-Lev work-stealing deque
+  \author David H. Ackley.
+  \date (C) 2014 All rights reserved.
+  \lgpl
+ */
+#ifndef WORKSTEALINGDEQUE_H
+#define WORKSTEALINGDEQUE_H
+
+#include "itype.h"
+#include "Atomic.h"
+#include "Fail.h"
+
+namespace MFM
+{
+  /**
+   * A deque of pointers that one owning thread pushes and takes at
+   * the bottom, while any number of other threads may steal from the
+   * top, without locks (after Chase & Lev, as reformulated by Le et
+   * al. for weak memory models).  The capacity is set once, by
+   * SetCapacity, before first use; pushing onto a full deque FAILs
+   * with OUT_OF_ROOM.
+   *
+   * @param T The pointed-to type of the items held.
+   */
+  template <class T>
+  class WorkStealingDeque
+  {
+  private:
+    /**
+     * The maximum number of items held; a power of two.
+     */
+    u32 m_capacity;
+
+    /**
+     * m_capacity - 1, for wrapping indices into m_items
+     */
+    u32 m_mask;
+
+    /**
+     * The index of the oldest item; advanced by thieves and by the
+     * owner taking the last item.
+     */
+    Atomic<s32> m_top;
+
+    /**
+     * One past the index of the newest item; changed only by the
+     * owner.
+     */
+    Atomic<s32> m_bottom;
+
+    Atomic<T*> * m_items;
+
+    // Declare away copy ctor and assignment; we own m_items
+    WorkStealingDeque(const WorkStealingDeque &);
+    WorkStealingDeque & operator=(const WorkStealingDeque &);
+
+  public:
+
+    WorkStealingDeque() :
+      m_capacity(0),
+      m_mask(0),
+      m_top(0),
+      m_bottom(0),
+      m_items(0)
+    { }
+
+    ~WorkStealingDeque()
+    {
+      delete [] m_items;
+    }
+
+    /**
+     * Makes room for \c capacity items.  Owner only, and only while
+     * no other thread is using this deque.  FAILs with
+     * ILLEGAL_ARGUMENT unless \c capacity is a power of two, or with
+     * ILLEGAL_STATE if this deque is not empty.
+     */
+    void SetCapacity(u32 capacity)
+    {
+      if (capacity == 0 || (capacity & (capacity - 1)) != 0)
+      {
+        FAIL(ILLEGAL_ARGUMENT);
+      }
+      if (GetSize() != 0)
+      {
+        FAIL(ILLEGAL_STATE);
+      }
+      if (capacity != m_capacity)
+      {
+        delete [] m_items;
+        m_items = new Atomic<T*>[capacity];
+        m_capacity = capacity;
+        m_mask = capacity - 1;
+      }
+      m_top.Store(0);
+      m_bottom.Store(0);
+    }
+
+    /**
+     * Adds \a item at the bottom of this deque.  Owner only.
+     */
+    void Push(T* item)
+    {
+      s32 b = m_bottom.Load(MEMORY_ORDER_RELAXED);
+      s32 t = m_top.Load(MEMORY_ORDER_ACQUIRE);
+      if (b - t >= (s32) m_capacity)
+      {
+        FAIL(OUT_OF_ROOM);
+      }
+      m_items[b & m_mask].Store(item, MEMORY_ORDER_RELAXED);
+      AtomicThreadFence(MEMORY_ORDER_RELEASE);
+      m_bottom.Store(b + 1, MEMORY_ORDER_RELAXED);
+    }
+
+    /**
+     * Removes the newest item from the bottom of this deque.  Owner
+     * only.
+     *
+     * @returns The item, or NULL if this deque was empty.
+     */
+    T* Take()
+    {
+      s32 b = m_bottom.Load(MEMORY_ORDER_RELAXED) - 1;
+      m_bottom.Store(b, MEMORY_ORDER_RELAXED);
+      AtomicThreadFence(MEMORY_ORDER_SEQ_CST);
+      s32 t = m_top.Load(MEMORY_ORDER_RELAXED);
+
+      if (t > b)
+      {
+        // Empty
+        m_bottom.Store(b + 1, MEMORY_ORDER_RELAXED);
+        return 0;
+      }
+
+      T* item = m_items[b & m_mask].Load(MEMORY_ORDER_RELAXED);
+      if (t == b)
+      {
+        // Last item; race any thieves for it
+        if (!m_top.CompareExchange(t, t + 1, MEMORY_ORDER_SEQ_CST))
+        {
+          item = 0;
+        }
+        m_bottom.Store(b + 1, MEMORY_ORDER_RELAXED);
+      }
+      return item;
+    }
+
+    /**
+     * Removes the oldest item from the top of this deque.  Any thread
+     * may call this.
+     *
+     * @returns The item, or NULL if this deque was empty or another
+     *          thread won the race for the item.
+     */
+    T* Steal()
+    {
+      s32 t = m_top.Load(MEMORY_ORDER_ACQUIRE);
+      AtomicThreadFence(MEMORY_ORDER_SEQ_CST);
+      s32 b = m_bottom.Load(MEMORY_ORDER_ACQUIRE);
+
+      if (t >= b)
+      {
+        return 0;
+      }
+
+      T* item = m_items[t & m_mask].Load(MEMORY_ORDER_RELAXED);
+      if (!m_top.CompareExchange(t, t + 1, MEMORY_ORDER_SEQ_CST))
+      {
+        return 0;
+      }
+      return item;
+    }
+
+    /**
+     * Gets an approximate count of the items in this deque.
+     */
+    u32 GetSize() const
+    {
+      s32 size = m_bottom.Load(MEMORY_ORDER_RELAXED) - m_top.Load(MEMORY_ORDER_RELAXED);
+      return size > 0 ? (u32) size : 0;
+    }
+  };
+}
+
+#endif /* WORKSTEALINGDEQUE_H */
@@ -27,6 +27,10 @@ namespace MFM {
 
     static void Test_bitVectorStoreBits();
 
+    static void Test_bitVectorLongReadWrite();
+
+    static void Test_bitVectorBulkOps();
+
   };
 } /* namespace MFM */
 #endif /*BITVECTOR_TEST_H*/
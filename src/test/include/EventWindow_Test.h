@@ -13,6 +13,10 @@ public:
   static void Test_eventwindowConstruction();
 
   static void Test_eventwindowWrite();
+
+  static void Test_eventwindowDirtySites();
+
+  static void Test_eventwindowSymmetries();
 };
 } /* namespace MFM */
 #endif /*EVENTWINDOW_TEST_H*/
@@ -15,6 +15,16 @@ namespace MFM {
   {
   public:
     static void Test_gridPlaceAtom();
+
+    static void Test_gridDimensions();
+
+    static void Test_gridLockEvents();
+
+    static void Test_gridWorkerThreads();
+
+    static void Test_gridDeterministicRadiation();
+
+    static void Test_gridCheckerboard();
   };
 } /* namespace MFM */
 #endif /*GRID_TEST_H*/
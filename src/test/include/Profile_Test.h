@@ -0,0 +1,19 @@
+#ifndef PROFILE_TEST_H      /* -*- C++ -*- */
+#define PROFILE_TEST_H
+
+#include "Profile.h"
+
+namespace MFM {
+
+  class Profile_Test
+  {
+  private:
+    static void Test_histogramBuckets();
+    static void Test_histogramAdd();
+    static void Test_histogramPercentile();
+
+  public:
+    static void Test_RunTests();
+  };
+} /* namespace MFM */
+#endif /*PROFILE_TEST_H*/
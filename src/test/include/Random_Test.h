@@ -10,6 +10,8 @@ namespace MFM {
     static Random & setup();
     static void Test_randomSetSeed();
     static void Test_randomDeterministics();
+    static void Test_randomGeometric();
+    static void Test_randomPhilox();
 
   public:
     static void Test_RunTests();
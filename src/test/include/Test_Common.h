@@ -17,7 +17,7 @@ namespace MFM {
   typedef P0Atom<TestParamConfig> TestAtom;
   typedef CoreConfig<TestAtom, TestParamConfig> TestCoreConfig;
 
-  typedef GridConfig<TestCoreConfig,4,3> TestGridConfig;
+  typedef GridConfig<TestCoreConfig> TestGridConfig;
   typedef Grid<TestGridConfig> TestGrid;
   typedef ElementTable<TestCoreConfig> TestElementTable;
   typedef EventWindow<TestCoreConfig> TestEventWindow;
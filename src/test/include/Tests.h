@@ -26,5 +26,9 @@
 #include "ColorMap_Test.h"
 #include "FXP_Test.h"
 #include "ExternalConfig_Test.h"
+#include "ThreadQueue_Test.h"
+#include "WorkStealingDeque_Test.h"
+#include "ThreadBarrier_Test.h"
+#include "Profile_Test.h"
 
 #endif /*TESTS_H*/
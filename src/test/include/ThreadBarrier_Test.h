@@ -0,0 +1,18 @@
+#ifndef THREADBARRIER_TEST_H      /* -*- C++ -*- */
+#define THREADBARRIER_TEST_H
+
+#include "ThreadBarrier.h"
+
+namespace MFM {
+
+  class ThreadBarrier_Test
+  {
+  private:
+    static void Test_threadbarrierGenerations();
+    static void Test_threadbarrierTimeout();
+
+  public:
+    static void Test_RunTests();
+  };
+} /* namespace MFM */
+#endif /*THREADBARRIER_TEST_H*/
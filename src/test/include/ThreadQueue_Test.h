@@ -0,0 +1,20 @@
+#ifndef THREADQUEUE_TEST_H      /* -*- C++ -*- */
+#define THREADQUEUE_TEST_H
+
+#include "ThreadQueue.h"
+
+namespace MFM {
+
+  class ThreadQueue_Test
+  {
+  private:
+    static void Test_threadqueueReadWrite();
+    static void Test_threadqueueWrapAround();
+    static void Test_threadqueuePeekAndFlush();
+    static void Test_threadqueueTwoThreads();
+
+  public:
+    static void Test_RunTests();
+  };
+} /* namespace MFM */
+#endif /*THREADQUEUE_TEST_H*/
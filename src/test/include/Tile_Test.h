@@ -13,6 +13,18 @@ namespace MFM {
   public:
 
     static void Test_tilePlaceAtom();
+
+    static void Test_tileIncrementalCounts();
+
+    static void Test_tilePublishedStats();
+
+    static void Test_tileAckWindow();
+
+    static void Test_tileBatchedEventBudget();
+
+#ifdef MFM_EVENT_ROLLBACK
+    static void Test_tileRollBack();
+#endif
   };
 } /* namespace MFM */
 
@@ -0,0 +1,20 @@
+#ifndef WORKSTEALINGDEQUE_TEST_H      /* -*- C++ -*- */
+#define WORKSTEALINGDEQUE_TEST_H
+
+#include "WorkStealingDeque.h"
+
+namespace MFM {
+
+  class WorkStealingDeque_Test
+  {
+  private:
+    static void Test_workstealingdequeTakeOrder();
+    static void Test_workstealingdequeEmpty();
+    static void Test_workstealingdequeFull();
+    static void Test_workstealingdequeRace();
+
+  public:
+    static void Test_RunTests();
+  };
+} /* namespace MFM */
+#endif /*WORKSTEALINGDEQUE_TEST_H*/
@@ -24,6 +24,8 @@ namespace MFM {
     Test_bitVectorSplitWrites();
     Test_bitVectorSetAndClearBits();
     Test_bitVectorStoreBits();
+    Test_bitVectorLongReadWrite();
+    Test_bitVectorBulkOps();
   }
 
   static BitVector<256> bits;
@@ -237,6 +239,63 @@ namespace MFM {
     assertUnchanged(4,7);
   }
 
+  void BitVector_Test::Test_bitVectorLongReadWrite()
+  {
+    BitVector<256>* bits = setup();
+
+    // Aligned and unaligned 64 bit reads, within one unit and across two
+    assert(bits->ReadLong(0, 64) == ((((u64) vals[0]) << 32) | vals[1]));
+    assert(bits->ReadLong(32, 64) == ((((u64) vals[1]) << 32) | vals[2]));
+    assert(bits->ReadLong(60, 8) == 0x41);
+
+    const u64 value = (((u64) 0xcafef00d) << 32) | 0x0badbeef;
+    bits->WriteLong(40, 64, value);
+    assert(bits->ReadLong(40, 64) == value);
+    assert(bits->Read(0, 32) == vals[0]);
+    assert(bits->Read(32, 8) == 0x11);
+    assert(bits->Read(104, 24) == (vals[3] & 0xffffff));
+
+    // The 32 bit API sees the same bits
+    assert(bits->Read(40, 32) == 0xcafef00d);
+    assert(bits->Read(72, 32) == 0x0badbeef);
+  }
+
+  void BitVector_Test::Test_bitVectorBulkOps()
+  {
+    BitVector<256> a(vals);
+    BitVector<256> b;
+
+    u32 expected = 0;
+    for (u32 i = 0; i < 8; ++i)
+    {
+      for (u32 v = vals[i]; v; v &= v - 1)
+      {
+        ++expected;
+      }
+    }
+    assert(a.PopCount() == expected);
+    assert(b.PopCount() == 0);
+
+    b.SetBits(0, 256);
+    assert(b.PopCount() == 256);
+
+    b ^= a;
+    for (u32 i = 0; i < 8; ++i)
+    {
+      assert(b.Read(i * 32, 32) == ~vals[i]);
+    }
+
+    b &= a;
+    assert(b.PopCount() == 0);
+
+    b |= a;
+    assert(b == a);
+
+    b.ToggleBit(255);
+    assert(b != a);
+    assert(b.PopCount() == expected - 1);
+  }
+
 
 } /* namespace MFM */
 
@@ -75,4 +75,98 @@ void EventWindow_Test::Test_eventwindowWrite()
 
 }
 
+void EventWindow_Test::Test_eventwindowDirtySites()
+{
+  TestTile tile;
+
+  Element_Dreg<TestCoreConfig>::THE_INSTANCE.AllocateType();
+  tile.RegisterElement(Element_Dreg<TestCoreConfig>::THE_INSTANCE);
+
+  SPoint center(8, 8);
+  SPoint west(-1, 0);
+  SPoint zero(0, 0);
+
+  const u32 DREG_TYPE = Element_Dreg<TestCoreConfig>::THE_INSTANCE.GetType();
+  const TestAtom empty = Element_Empty<TestCoreConfig>::THE_INSTANCE.GetDefaultAtom();
+
+  TestEventWindow ew(tile);
+  ew.SetCenterInTile(center);
+  assert(ew.GetDirtySiteCount() == 0);
+
+  // Rewriting what is already there changes nothing
+  ew.SetRelativeAtom(west, empty);
+  ew.SwapAtoms(zero, west);
+  assert(ew.GetDirtySiteCount() == 0);
+
+  // A real change is recorded once, however often it is written
+  ew.SetRelativeAtom(west, TestAtom(DREG_TYPE,0,0,0));
+  ew.SetRelativeAtom(west, TestAtom(DREG_TYPE,0,0,0));
+  assert(ew.GetDirtySiteCount() == 1);
+  assert(ew.GetDirtySite(0) == (u32) MDist<4>::get().FromPoint(west, 4));
+
+  // Swapping moves the Dreg to the center, dirtying it as well
+  ew.SwapAtoms(zero, west);
+  assert(ew.GetDirtySiteCount() == 2);
+  assert(ew.GetDirtySite(1) == (u32) MDist<4>::get().FromPoint(zero, 4));
+
+  // Moving the window forgets everything
+  ew.SetCenterInTile(center);
+  assert(ew.GetDirtySiteCount() == 0);
+}
+
+void EventWindow_Test::Test_eventwindowSymmetries()
+{
+  TestTile tile;
+
+  Element_Dreg<TestCoreConfig>::THE_INSTANCE.AllocateType();
+  tile.RegisterElement(Element_Dreg<TestCoreConfig>::THE_INSTANCE);
+
+  const u32 DREG_TYPE = Element_Dreg<TestCoreConfig>::THE_INSTANCE.GetType();
+  const u32 EMPTY_TYPE = Element_Empty<TestCoreConfig>::THE_INSTANCE.GetType();
+  const TestAtom dreg(DREG_TYPE,0,0,0);
+  const TestAtom empty = Element_Empty<TestCoreConfig>::THE_INSTANCE.GetDefaultAtom();
+
+  // Far enough from the cache that every window site is writable
+  const SPoint center(TestTile::TILE_WIDTH / 2, TestTile::TILE_WIDTH / 2);
+  const MDist<4> & md = MDist<4>::get();
+
+  TestEventWindow ew(tile);
+  ew.SetCenterInTile(center);
+
+  for (u32 s = 0; s < PSYM_SYMMETRY_COUNT; ++s)
+  {
+    const PointSymmetry psym = (PointSymmetry) s;
+    ew.SetSymmetry(psym);
+
+    for (u32 i = 0; i < EVENT_WINDOW_SITES(4); ++i)
+    {
+      // Where the SPoint path says site i is
+      const SPoint offset = md.GetPoint(i);
+      const SPoint site = Map(offset, psym, offset) + center;
+
+      // The index path reaches the very same atom
+      assert(&ew.GetRelativeAtom(i) == tile.GetAtom(site));
+      assert(&ew.GetRelativeAtom(offset) == tile.GetAtom(site));
+      assert(ew.MapToTileValid(offset) == site);
+      assert(ew.IsLiveSite(i) == tile.IsLiveSite(site));
+
+      // And writes through it land there too
+      assert(ew.SetRelativeAtom(i, dreg));
+      assert(tile.GetAtom(site)->GetType() == DREG_TYPE);
+      assert(ew.SetRelativeAtom(i, empty));
+      assert(tile.GetAtom(site)->GetType() == EMPTY_TYPE);
+    }
+  }
+
+  // The named flips mirror the axis they say they do
+  const SPoint east(1, 0);
+  const SPoint south(0, 1);
+  ew.SetSymmetry(PSYM_FLIPX);
+  assert(&ew.GetRelativeAtom(east) == tile.GetAtom(center + SPoint(-1, 0)));
+  assert(&ew.GetRelativeAtom(south) == tile.GetAtom(center + south));
+  ew.SetSymmetry(PSYM_FLIPY);
+  assert(&ew.GetRelativeAtom(east) == tile.GetAtom(center + east));
+  assert(&ew.GetRelativeAtom(south) == tile.GetAtom(center + SPoint(0, -1)));
+}
+
 } /* namespace MFM */
@@ -15,7 +15,7 @@ namespace MFM
     ElementRegistry<TestCoreConfig> ereg;
     ereg.RegisterElement(Element_Dreg<TestCoreConfig>::THE_INSTANCE);
 
-    Grid<TestGridConfig> grid(ereg);
+    Grid<TestGridConfig> grid(ereg, 4, 3);
     ExternalConfig<TestGridConfig> cfg(grid);
     RegisterExternalConfigFunctions<TestGridConfig>(cfg);
     OverflowableCharBufferByteSink<1024> errs;
@@ -35,8 +35,67 @@ namespace MFM
 
   }
 
+  static void TestSetElementParameter()
+  {
+    ElementRegistry<TestCoreConfig> ereg;
+    ereg.RegisterElement(Element_Dreg<TestCoreConfig>::THE_INSTANCE);
+
+    Grid<TestGridConfig> grid(ereg, 4, 3);
+    ExternalConfig<TestGridConfig> cfg(grid);
+    RegisterExternalConfigFunctions<TestGridConfig>(cfg);
+    OverflowableCharBufferByteSink<1024> errs;
+    cfg.SetErrorByteSink(errs);
+
+    Parameters & parms = Element_Dreg<TestCoreConfig>::THE_INSTANCE.GetElementParameters();
+    s32 index = parms.GetParameterNumberFromTag("res");
+    assert(index >= 0);
+    Parameters::S32 * res = Parameters::S32::Cast(parms.GetParameter((u32) index));
+    assert(res);
+
+    const s32 oldValue = res->GetValue();
+    assert(oldValue != 300);  // Else setting it would change nothing
+    const u32 oldVersion = parms.GetVersion();
+    const u32 valueCount = parms.GetValueCount();
+    s32 oldValues[Parameters::MAX_VALUES];
+    for (u32 i = 0; i < valueCount; ++i)
+    {
+      oldValues[i] = parms.GetValues()[i];
+    }
+
+    ZStringByteSource zbs("RegisterElement(Dreg-1174842840820140728585614, d)\n"
+                          "SetElementParameter(d,res,300)\n");
+    cfg.SetByteSource(zbs, "./configurations/ExternalConfig_Test.input");
+    assert(cfg.Read());
+
+    // The new value is published, in exactly one slot, and readers
+    // can tell it changed
+    assert(res->GetValue() == 300);
+    u32 changed = 0;
+    for (u32 i = 0; i < valueCount; ++i)
+    {
+      if (parms.GetValues()[i] != oldValues[i])
+      {
+        assert(parms.GetValues()[i] == 300);
+        ++changed;
+      }
+    }
+    assert(changed == 1);
+    const u32 newVersion = parms.GetVersion();
+    assert(newVersion != oldVersion);
+
+    // Putting it back restores every slot, as another new version
+    res->SetValue(oldValue);
+    assert(res->GetValue() == oldValue);
+    for (u32 i = 0; i < valueCount; ++i)
+    {
+      assert(parms.GetValues()[i] == oldValues[i]);
+    }
+    assert(parms.GetVersion() != newVersion);
+  }
+
   void ExternalConfig_Test::Test_RunTests()
   {
     TestBasic();
+    TestSetElementParameter();
   }
 }
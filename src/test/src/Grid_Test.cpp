@@ -3,6 +3,7 @@
 #include "P1Atom.h"
 #include "Grid_Test.h"
 #include "Element_Res.h"
+#include "Util.h"  /* For Sleep */
 
 namespace MFM {
 
@@ -10,7 +11,7 @@ namespace MFM {
   {
 
     ElementRegistry<TestCoreConfig> ereg;
-    TestGrid grid(ereg);
+    TestGrid grid(ereg, 4, 3);
 
     grid.SetSeed(1);
     grid.Reinit();
@@ -28,4 +29,250 @@ namespace MFM {
     assert(out->GetType() == atom.GetType());
 
   }
+
+  void Grid_Test::Test_gridDimensions()
+  {
+    ElementRegistry<TestCoreConfig> ereg;
+    TestGrid grid(ereg, 4, 3);
+
+    assert(grid.GetWidth() == 4);
+    assert(grid.GetHeight() == 3);
+    assert(grid.GetWidthSites() == 4 * Tile<TestCoreConfig>::OWNED_SIDE);
+    assert(!grid.IsLegalTileIndex(SPoint(4, 0)));
+
+    grid.SetDimensions(2, 5);
+    grid.SetSeed(1);
+    grid.Reinit();
+
+    grid.Needed(Element_Res<TestCoreConfig>::THE_INSTANCE);
+
+    assert(grid.GetWidth() == 2);
+    assert(grid.GetHeight() == 5);
+    assert(grid.IsLegalTileIndex(SPoint(1, 4)));
+    assert(!grid.IsLegalTileIndex(SPoint(2, 0)));
+
+    TestAtom atom(Element_Res<TestCoreConfig>::THE_INSTANCE.GetDefaultAtom());
+
+    // The last owned site of the last tile
+    SPoint gloc(grid.GetWidthSites() - 1, grid.GetHeightSites() - 1);
+
+    grid.PlaceAtom(atom, gloc);
+
+    assert(grid.GetAtom(gloc)->GetType() == atom.GetType());
+    assert(grid.GetAtomCount(atom.GetType()) == 1);
+
+    // A paused grid's clear shows up in the published counts
+    grid.Clear();
+    assert(grid.GetAtomCount(atom.GetType()) == 0);
+    assert(grid.GetAtomCount(Element_Empty<TestCoreConfig>::THE_INSTANCE.GetType()) ==
+           grid.GetWidthSites() * grid.GetHeightSites());
+  }
+
+  void Grid_Test::Test_gridLockEvents()
+  {
+    ElementRegistry<TestCoreConfig> ereg;
+    TestGrid grid(ereg, 2, 2);
+
+    grid.SetSeed(1);
+    grid.Reinit();
+
+    grid.Needed(Element_Res<TestCoreConfig>::THE_INSTANCE);
+
+    TestAtom atom(Element_Res<TestCoreConfig>::THE_INSTANCE.GetDefaultAtom());
+    for (u32 i = 0; i < grid.GetWidthSites(); i += 3)
+    {
+      grid.PlaceAtom(atom, SPoint(i, i % grid.GetHeightSites()));
+    }
+
+    grid.Unpause();
+    Sleep(0, 100000000);  // 100ms
+    grid.Pause();
+
+    // Every event counts once by the region of its center, and once
+    // by the locks it took -- never a lock type as a region
+    u64 events = 0, regionEvents = 0, lockEvents = 0, lockedEvents = 0;
+    for (u32 x = 0; x < grid.GetWidth(); ++x)
+    {
+      for (u32 y = 0; y < grid.GetHeight(); ++y)
+      {
+        TestTile::Stats stats;
+        grid.GetTile(x, y).GetStats(stats);
+        events += stats.m_eventsExecuted;
+        for (u32 r = 0; r < REGION_COUNT; ++r)
+        {
+          regionEvents += stats.m_regionEvents[r];
+        }
+        for (u32 l = 0; l < LOCKTYPE_COUNT; ++l)
+        {
+          lockEvents += stats.m_lockEvents[l];
+        }
+        lockedEvents += stats.m_lockEvents[LOCKTYPE_SINGLE] + stats.m_lockEvents[LOCKTYPE_TRIPLE];
+      }
+    }
+    assert(events > 0);
+    assert(regionEvents == events);
+    assert(lockEvents == events);
+    assert(lockedEvents > 0);
+  }
+
+  void Grid_Test::Test_gridWorkerThreads()
+  {
+    ElementRegistry<TestCoreConfig> ereg;
+    TestGrid grid(ereg, 3, 3);
+
+    grid.SetSeed(1);
+    grid.Reinit();
+    grid.SetWorkerThreads(2);  // Each worker must share itself among several tiles
+
+    grid.Needed(Element_Res<TestCoreConfig>::THE_INSTANCE);
+
+    TestAtom atom(Element_Res<TestCoreConfig>::THE_INSTANCE.GetDefaultAtom());
+    for (u32 i = 0; i < grid.GetWidthSites(); i += 3)
+    {
+      grid.PlaceAtom(atom, SPoint(i, i % grid.GetHeightSites()));
+    }
+
+    // Run a few times, since tiles migrate between workers as they go
+    for (u32 run = 0; run < 3; ++run)
+    {
+      u64 before[3][3];
+      for (u32 x = 0; x < grid.GetWidth(); ++x)
+      {
+        for (u32 y = 0; y < grid.GetHeight(); ++y)
+        {
+          before[x][y] = grid.GetTile(x, y).GetEventsExecuted();
+        }
+      }
+
+      grid.Unpause();
+      Sleep(0, 100000000);  // 100ms
+      grid.Pause();
+
+      // No tile starved
+      for (u32 x = 0; x < grid.GetWidth(); ++x)
+      {
+        for (u32 y = 0; y < grid.GetHeight(); ++y)
+        {
+          assert(grid.GetTile(x, y).GetEventsExecuted() > before[x][y]);
+        }
+      }
+    }
+    assert(grid.GetWorkerThreads() == 2);
+  }
+
+  /**
+   * Runs \c rounds deterministic rounds, with background radiation,
+   * of a 3x2 grid seeded with \c seed , on \c workers worker threads
+   */
+  static void RunIrradiatedDeterministic(TestGrid & grid, u32 seed, u32 workers, u32 rounds)
+  {
+    grid.SetSeed(seed);
+    grid.Reinit();
+    grid.SetWorkerThreads(workers);
+    grid.SetEventSchedule(SCHEDULE_DETERMINISTIC);
+    grid.SetBackgroundRadiation(true);
+
+    grid.Needed(Element_Res<TestCoreConfig>::THE_INSTANCE);
+
+    TestAtom atom(Element_Res<TestCoreConfig>::THE_INSTANCE.GetDefaultAtom());
+    for (u32 x = 0; x < grid.GetWidthSites(); x += 2)
+    {
+      for (u32 y = 0; y < grid.GetHeightSites(); y += 2)
+      {
+        grid.PlaceAtom(atom, SPoint(x, y));
+      }
+    }
+
+    for (u32 r = 0; r < rounds; ++r)
+    {
+      grid.GrantDeterministicRounds(1);
+      grid.Unpause();
+      grid.WaitForDeterministicRounds();
+      grid.Pause();
+    }
+  }
+
+  void Grid_Test::Test_gridDeterministicRadiation()
+  {
+    const u32 SEED = 7;
+    const u32 ROUNDS = 4;
+
+    ElementRegistry<TestCoreConfig> ereg;
+    TestGrid threaded(ereg, 3, 2);
+    RunIrradiatedDeterministic(threaded, SEED, 0, ROUNDS);
+
+    TestGrid pooled(ereg, 3, 2);
+    RunIrradiatedDeterministic(pooled, SEED, 4, ROUNDS);
+
+    // However the tiles were run, the grids came out the same
+    for (u32 x = 0; x < threaded.GetWidthSites(); ++x)
+    {
+      for (u32 y = 0; y < threaded.GetHeightSites(); ++y)
+      {
+        SPoint site(x, y);
+        assert(*threaded.GetAtom(site) == *pooled.GetAtom(site));
+      }
+    }
+    assert(threaded.GetTotalEventsExecuted() == pooled.GetTotalEventsExecuted());
+  }
+
+  void Grid_Test::Test_gridCheckerboard()
+  {
+    ElementRegistry<TestCoreConfig> ereg;
+    TestGrid grid(ereg, 3, 3);
+
+    grid.SetSeed(3);
+    grid.Reinit();
+    grid.SetEventSchedule(SCHEDULE_CHECKERBOARD);
+
+    grid.Needed(Element_Res<TestCoreConfig>::THE_INSTANCE);
+
+    TestAtom atom(Element_Res<TestCoreConfig>::THE_INSTANCE.GetDefaultAtom());
+    const u32 type = atom.GetType();
+    for (u32 x = 0; x < grid.GetWidthSites(); x += 2)
+    {
+      for (u32 y = 0; y < grid.GetHeightSites(); y += 2)
+      {
+        grid.PlaceAtom(atom, SPoint(x, y));
+      }
+    }
+    const u32 placed = grid.GetAtomCount(type);
+    assert(placed > 0);
+
+    u64 lastEvents = 0;
+    for (u32 run = 0; run < 5; ++run)
+    {
+      grid.Unpause();
+      Sleep(0, 50000000);  // 50ms
+      grid.Pause();
+
+      u64 events = 0;
+      for (u32 x = 0; x < grid.GetWidth(); ++x)
+      {
+        for (u32 y = 0; y < grid.GetHeight(); ++y)
+        {
+          TestTile::Stats stats;
+          grid.GetTile(x, y).GetStats(stats);
+          events += stats.m_eventsExecuted;
+
+          // Taking turns means never locking
+          assert(stats.m_lockAttempts == 0);
+          assert(stats.m_lockEvents[LOCKTYPE_SINGLE] == 0);
+          assert(stats.m_lockEvents[LOCKTYPE_TRIPLE] == 0);
+        }
+      }
+      assert(events > lastEvents);
+      lastEvents = events;
+
+      // Res only moves, so no unlocked event lost or cloned one
+      grid.AssertValidAtomCounts();
+      assert(grid.GetAtomCount(type) == placed);
+
+      // And every atom is still intact
+      u32 repaired = 0, erased = 0;
+      grid.CheckAndRepairAtoms(repaired, erased);
+      assert(repaired == 0);
+      assert(erased == 0);
+    }
+  }
 } /* namespace MFM */
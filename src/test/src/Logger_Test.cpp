@@ -79,9 +79,84 @@ namespace MFM {
     }
   }
 
+  static void Test_Async() {
+    {
+      tbuf.Reset();
+      Logger log(tbuf,Logger::MESSAGE);
+      log.SetTimeStamper(&NullSerializable);
+      log.StartAsync();
+      assert(log.IsAsync());
+
+      log.Debug("%d captains: %s vs %s", 2, "Scarlet", "Kirk");
+      log.Message("This is %s", "Captain Black");
+      log.Warning("%d%% sure you can %s us, %04x",100,"hear",0xea);
+      log.Error("Must %s%@", "sterilize", &NullSerializable);
+
+      log.StopAsync();
+      assert(!log.IsAsync());
+      assert(!strcmp("MSG: This is Captain Black\n"
+                     "WRN: 100% sure you can hear us, 00EA\n"
+                     "ERR: Must sterilize\n",
+                     tbuf.GetZString()));
+      assert(log.GetDroppedRecords(Logger::DEBUG) == 0);
+    }
+    {
+      tbuf.Reset();
+      Logger log(tbuf,Logger::MESSAGE);
+      log.SetTimeStamper(&NullSerializable);
+      log.StartAsync();
+
+      // Too much text for one record: written in full, synchronously
+      const char * longText =
+        "0123456789012345678901234567890123456789012345678901234567890123456789"
+        "0123456789012345678901234567890123456789012345678901234567890123456789";
+      log.Message("%s", longText);
+
+      // Only one Logger may be async at a time
+      Logger other(tbuf,Logger::MESSAGE);
+      bool failed = false;
+      unwind_protect({ failed = true; },{ other.StartAsync(); });
+      assert(failed);
+      assert(!other.IsAsync());
+
+      log.StopAsync();
+      CharBufferByteSink<256> expected;
+      expected.Printf("MSG: %s\n", longText);
+      assert(!strcmp(expected.GetZString(), tbuf.GetZString()));
+    }
+  }
+
+  static void Test_RateLimit() {
+    // Keep our own time, so a second can't roll over mid-test
+    LogRateLimiter limiter(2);
+    assert(limiter.Allow(Logger::DEBUG, 1));
+    assert(limiter.Allow(Logger::DEBUG, 1));
+    assert(!limiter.Allow(Logger::DEBUG, 1));
+    assert(!limiter.Allow(Logger::DEBUG, 1));
+    assert(limiter.GetRefused() == 2);
+
+    // A new second allows more, and reports the refusals
+    assert(limiter.Allow(Logger::DEBUG, 2));
+    assert(limiter.GetRefused() == 0);
+    assert(limiter.Allow(Logger::DEBUG, 2));
+    assert(!limiter.Allow(Logger::DEBUG, 2));
+    assert(limiter.GetRefused() == 1);
+
+    // Arguments of filtered-out messages are never evaluated
+    u32 evaluated = 0;
+    Logger::Level old = LOG.SetLevel(Logger::MESSAGE);
+    MFM_LOG_DBG("%d", ++evaluated);
+    MFM_LOG_DBG_LIMITED(limiter)("%d", ++evaluated);
+    LOG.SetLevel(old);
+    assert(evaluated == 0);
+    assert(limiter.GetRefused() == 1);
+  }
+
   void Logger_Test::Test_RunTests() {
     Test_Basic();
     Test_IfLog();
+    Test_Async();
+    Test_RateLimit();
   }
 
 } /* namespace MFM */
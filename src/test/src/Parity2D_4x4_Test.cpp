@@ -55,6 +55,22 @@ namespace MFM {
       // Let's say 'most' means 'more than 70%'
       assert(tripleFailures * 100 > tripleCases * 70);
     }
+
+    // Table-driven correction must agree with the slow path on every
+    // possible error pattern in the ECC bits, on several data values
+    for (u32 i = 0; i < 1<<9; i += 37) {
+      u32 wpar = Parity2D_4x4::Add2DParity(i);
+      for (u32 e = 0; e < 1<<Parity2D_4x4::ECC_BITS; ++e) {
+        u32 bad = wpar^(e<<Parity2D_4x4::DATA_BITS);
+        assert(Parity2D_4x4::CheckAndCorrect2DParity(bad) ==
+               Parity2D_4x4::Correct2DParitySlow(bad));
+        for (u32 j = 0; j < Parity2D_4x4::DATA_BITS; ++j) {
+          u32 worse = bad^(1<<j);
+          assert(Parity2D_4x4::CheckAndCorrect2DParity(worse) ==
+                 Parity2D_4x4::Correct2DParitySlow(worse));
+        }
+      }
+    }
   }
 
 } /* namespace MFM */
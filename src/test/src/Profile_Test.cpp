@@ -0,0 +1,84 @@
+#include "assert.h"
+#include "Profile_Test.h"
+#include "itype.h"
+
+namespace MFM {
+
+  void Profile_Test::Test_histogramBuckets()
+  {
+    assert(Log2Histogram::BucketOf(0) == 0);
+    assert(Log2Histogram::BucketOf(1) == 1);
+    assert(Log2Histogram::BucketOf(2) == 2);
+    assert(Log2Histogram::BucketOf(3) == 2);
+    assert(Log2Histogram::BucketOf(4) == 3);
+    assert(Log2Histogram::BucketOf(1023) == 10);
+    assert(Log2Histogram::BucketOf(1024) == 11);
+
+    // Everything from 2^30 up lands in the catch-all
+    const u32 LAST = Log2Histogram::BUCKETS - 1;
+    assert(Log2Histogram::BucketOf((((u64) 1) << 30) - 1) == LAST - 1);
+    assert(Log2Histogram::BucketOf(((u64) 1) << 30) == LAST);
+    assert(Log2Histogram::BucketOf(((u64) 1) << 40) == LAST);
+    assert(Log2Histogram::BucketOf(~((u64) 0)) == LAST);
+  }
+
+  void Profile_Test::Test_histogramAdd()
+  {
+    Log2Histogram a, b;
+    assert(a.GetCount() == 0);
+    assert(a.GetTotal() == 0);
+
+    a.Add(0);
+    a.Add(5);
+    a.Add(6);
+    assert(a.GetCount() == 3);
+    assert(a.GetTotal() == 11);
+    assert(a.GetBucket(0) == 1);
+    assert(a.GetBucket(3) == 2);
+
+    b.Add(7);
+    b.Add(100);
+    a.Add(b);
+    assert(a.GetCount() == 5);
+    assert(a.GetTotal() == 118);
+    assert(a.GetBucket(3) == 3);
+    assert(a.GetBucket(7) == 1);
+    assert(b.GetCount() == 2);  // Untouched
+
+    a.Clear();
+    assert(a.GetCount() == 0);
+    assert(a.GetTotal() == 0);
+    assert(a.GetBucket(3) == 0);
+  }
+
+  void Profile_Test::Test_histogramPercentile()
+  {
+    Log2Histogram h;
+    assert(h.GetPercentile(50) == 0);
+
+    for (u32 i = 0; i < 90; ++i)
+    {
+      h.Add(10);     // Bucket 4: up to 15
+    }
+    for (u32 i = 0; i < 10; ++i)
+    {
+      h.Add(1000);   // Bucket 10: up to 1023
+    }
+    assert(h.GetPercentile(50) == 15);
+    assert(h.GetPercentile(90) == 15);
+    assert(h.GetPercentile(91) == 1023);
+    assert(h.GetPercentile(100) == 1023);
+
+    // The catch-all bucket has no upper bound to report
+    h.Add(((u64) 1) << 31);
+    assert(h.GetPercentile(100) == Log2Histogram::UNBOUNDED);
+    assert(h.GetPercentile(50) == 15);
+  }
+
+  void Profile_Test::Test_RunTests()
+  {
+    Test_histogramBuckets();
+    Test_histogramAdd();
+    Test_histogramPercentile();
+  }
+} /* namespace MFM */
@@ -1,4 +1,5 @@
 #include "assert.h"
+#include <math.h>  /* For sqrt, fabs */
 #include "Random_Test.h"
 #include "itype.h"
 
@@ -6,6 +7,8 @@ namespace MFM {
 
   void Random_Test::Test_RunTests() {
     Test_randomSetSeed();
+    Test_randomGeometric();
+    Test_randomPhilox();
   }
 
   Random & Random_Test::setup()
@@ -69,4 +72,80 @@ namespace MFM {
     }
   }
 
+
+  void Random_Test::Test_randomGeometric()
+  {
+    Random & random = setup();
+    const u32 TRIES = 100000;
+
+    for (u32 i = 0; i < 100; ++i) {
+      assert(random.CreateGeometric(1) == 0);
+    }
+
+    // Failures before success average odds-1, with variance
+    // (odds-1)*odds, and a success comes first 1-in-odds of the time.
+    // Allow SIGMAS standard deviations either way, so no seed should
+    // fail a correct sampler.
+    const double SIGMAS = 6;
+    for (u32 odds = 2; odds <= 1000; odds *= 10) {
+      u64 total = 0;
+      u32 zeros = 0;
+      for (u32 i = 0; i < TRIES; ++i) {
+        u32 skip = random.CreateGeometric(odds);
+        total += skip;
+        if (skip == 0) ++zeros;
+      }
+
+      double expectTotal = (double) TRIES * (odds - 1);
+      double sigmaTotal = sqrt((double) TRIES * (odds - 1) * odds);
+      assert(fabs(total - expectTotal) < SIGMAS * sigmaTotal);
+
+      double p = 1.0 / odds;
+      double expectZeros = TRIES * p;
+      double sigmaZeros = sqrt(TRIES * p * (1 - p));
+      assert(fabs(zeros - expectZeros) < SIGMAS * sigmaZeros);
+    }
+  }
+
+  void Random_Test::Test_randomPhilox()
+  {
+    // Known answers from the Random123 distribution
+    Philox4x32 philox;
+    assert(philox.Next() == 0x6627e8d5);
+    assert(philox.Next() == 0xe169c58d);
+    assert(philox.Next() == 0xbc57ac4c);
+    assert(philox.Next() == 0x9b00dbd8);
+
+    Random r1(1), r2(1);
+    r1.SetBackend(RANDOM_BACKEND_PHILOX);
+    r2.SetBackend(RANDOM_BACKEND_PHILOX);
+
+    // Fill matches repeated Create, across block boundaries
+    const u32 NUMS = 23;
+    u32 nums[NUMS];
+    r1.Create();
+    r2.Create();
+    r1.Fill(nums, NUMS);
+    for (u32 i = 0; i < NUMS; ++i) {
+      assert(nums[i] == r2.Create());
+    }
+
+    // Bounded draws stay in bounds
+    for (u32 max = 1; max < 100000; max *= 3) {
+      r1.Fill(nums, NUMS, max);
+      for (u32 i = 0; i < NUMS; ++i) {
+        assert(nums[i] < max);
+        assert(r1.Create(max) < max);
+      }
+    }
+
+    // Streams replay regardless of what came before
+    r1.SetStream(3, 7);
+    u32 first = r1.Create();
+    r1.Create(1000);
+    r1.SetStream(3, 7);
+    assert(r1.Create() == first);
+    r1.SetStream(3, 8);
+    assert(r1.Create() != first);
+  }
 } /* namespace MFM */
@@ -0,0 +1,102 @@
+#include "assert.h"
+#include <pthread.h>
+#include <sched.h>  /* For sched_yield */
+#include "ThreadBarrier_Test.h"
+#include "Atomic.h"
+#include "itype.h"
+
+namespace MFM {
+
+  void ThreadBarrier_Test::Test_RunTests()
+  {
+    Test_threadbarrierGenerations();
+    Test_threadbarrierTimeout();
+  }
+
+  static const u32 BARRIER_THREADS = 4;
+  static const u32 BARRIER_GENERATIONS = 50;
+
+  struct BarrierShared
+  {
+    ThreadBarrier m_barrier;
+    Atomic<u32> m_open;  // The generation the inner threads may arrive in
+  };
+
+  struct BarrierInner
+  {
+    BarrierShared * m_shared;
+    Atomic<u32> m_lastArrived;
+  };
+
+  static void * BarrierInnerLoop(void * arg)
+  {
+    BarrierInner & inner = *(BarrierInner *) arg;
+    for (u32 g = 1; g <= BARRIER_GENERATIONS; ++g)
+    {
+      while (inner.m_shared->m_open.Load(MEMORY_ORDER_ACQUIRE) < g)
+      {
+        sched_yield();
+      }
+      inner.m_lastArrived.Store(g);
+      inner.m_shared->m_barrier.Arrive();
+    }
+    return 0;
+  }
+
+  void ThreadBarrier_Test::Test_threadbarrierGenerations()
+  {
+    BarrierShared shared;
+    BarrierInner inners[BARRIER_THREADS];
+    pthread_t threads[BARRIER_THREADS];
+    for (u32 t = 0; t < BARRIER_THREADS; ++t)
+    {
+      inners[t].m_shared = &shared;
+      assert(pthread_create(&threads[t], NULL, BarrierInnerLoop, &inners[t]) == 0);
+    }
+
+    // The same barrier, reused for every generation
+    for (u32 g = 1; g <= BARRIER_GENERATIONS; ++g)
+    {
+      u32 generation = shared.m_barrier.Begin(BARRIER_THREADS);
+      assert(generation == g);
+      shared.m_open.Store(g, MEMORY_ORDER_RELEASE);
+
+      assert(shared.m_barrier.Wait(generation, 10000));
+      assert(shared.m_barrier.GetArrivals() == BARRIER_THREADS);
+      for (u32 t = 0; t < BARRIER_THREADS; ++t)
+      {
+        assert(inners[t].m_lastArrived.Load() == g);
+      }
+    }
+
+    for (u32 t = 0; t < BARRIER_THREADS; ++t)
+    {
+      assert(pthread_join(threads[t], NULL) == 0);
+    }
+
+    // Nobody to wait for completes at once
+    u32 generation = shared.m_barrier.Begin(0);
+    assert(shared.m_barrier.Wait(generation, 0));
+  }
+
+  void ThreadBarrier_Test::Test_threadbarrierTimeout()
+  {
+    ThreadBarrier barrier;
+    u32 generation = barrier.Begin(2);
+    barrier.Arrive();
+
+    // One arrival short, so this must give up
+    assert(!barrier.Wait(generation, 50));
+    assert(barrier.GetArrivals() == 1);
+
+    // A late arrival still completes the generation
+    barrier.Arrive();
+    assert(barrier.Wait(generation, 50));
+
+    // And the barrier is usable again afterwards
+    generation = barrier.Begin(1);
+    barrier.Arrive();
+    assert(barrier.Wait(generation, 50));
+  }
+
+} /* namespace MFM */
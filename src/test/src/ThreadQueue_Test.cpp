@@ -0,0 +1,163 @@
+#include "assert.h"
+#include <pthread.h>
+#include <sched.h>  /* For sched_yield */
+#include "ThreadQueue_Test.h"
+#include "itype.h"
+
+namespace MFM {
+
+  void ThreadQueue_Test::Test_RunTests()
+  {
+    Test_threadqueueReadWrite();
+    Test_threadqueueWrapAround();
+    Test_threadqueuePeekAndFlush();
+    Test_threadqueueTwoThreads();
+  }
+
+  void ThreadQueue_Test::Test_threadqueueReadWrite()
+  {
+    ThreadQueue queue;
+    u8 out[10] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+    u8 in[10];
+
+    assert(queue.BytesAvailable() == 0);
+    assert(queue.Read(in, 1) == 0);
+
+    queue.Write(out, 10);
+    assert(queue.BytesAvailable() == 10);
+
+    // Read is all-or-nothing
+    assert(queue.Read(in, 11) == 0);
+    assert(queue.BytesAvailable() == 10);
+
+    assert(queue.Read(in, 4) == 4);
+    for (u32 i = 0; i < 4; ++i)
+    {
+      assert(in[i] == i);
+    }
+    assert(queue.BytesAvailable() == 6);
+
+    queue.ReadBlocking(in, 6);
+    for (u32 i = 0; i < 6; ++i)
+    {
+      assert(in[i] == i + 4);
+    }
+    assert(queue.BytesAvailable() == 0);
+  }
+
+  void ThreadQueue_Test::Test_threadqueueWrapAround()
+  {
+    ThreadQueue queue;
+    const u32 CHUNK = 300;  // Deliberately not a divisor of the capacity
+    u8 out[CHUNK];
+    u8 in[CHUNK];
+    u8 next = 0;
+    u8 expect = 0;
+
+    for (u32 round = 0; round < 100; ++round)
+    {
+      for (u32 i = 0; i < CHUNK; ++i)
+      {
+        out[i] = next++;
+      }
+      queue.Write(out, CHUNK);
+      if (round > 2)  // Keep some bytes in flight across the wrap
+      {
+        assert(queue.Read(in, CHUNK) == CHUNK);
+        for (u32 i = 0; i < CHUNK; ++i)
+        {
+          assert(in[i] == expect++);
+        }
+      }
+    }
+    assert(queue.BytesAvailable() == 3 * CHUNK);
+  }
+
+  void ThreadQueue_Test::Test_threadqueuePeekAndFlush()
+  {
+    ThreadQueue queue;
+    u8 out[THREADQUEUE_MAX_BYTES];
+    u8 in[4];
+
+    // Move the heads near the end of the buffer so the peek wraps
+    queue.Write(out, THREADQUEUE_MAX_BYTES - 2);
+    queue.Flush();
+    assert(queue.BytesAvailable() == 0);
+
+    for (u32 i = 0; i < 8; ++i)
+    {
+      out[i] = 100 + i;
+    }
+    queue.Write(out, 8);
+
+    queue.PeekRead(in, 1, 4);
+    for (u32 i = 0; i < 4; ++i)
+    {
+      assert(in[i] == 101 + i);
+    }
+    assert(queue.BytesAvailable() == 8);
+
+    // The whole capacity is usable
+    queue.Flush();
+    queue.Write(out, THREADQUEUE_MAX_BYTES);
+    assert(queue.BytesAvailable() == THREADQUEUE_MAX_BYTES);
+  }
+
+  static const u32 TWO_THREAD_BYTES = 1000000;
+
+  static void * ThreadQueueProducer(void * arg)
+  {
+    ThreadQueue & queue = *(ThreadQueue *) arg;
+    u8 buffer[97];
+    u32 sent = 0;
+    while (sent < TWO_THREAD_BYTES)
+    {
+      u32 len = sizeof(buffer);
+      if (sent + len > TWO_THREAD_BYTES)
+      {
+        len = TWO_THREAD_BYTES - sent;
+      }
+      for (u32 i = 0; i < len; ++i)
+      {
+        buffer[i] = (u8) (sent + i);
+      }
+
+      // Don't overload the queue; spin until there's room
+      while (queue.BytesAvailable() + len > THREADQUEUE_MAX_BYTES)
+      {
+        sched_yield();
+      }
+      queue.Write(buffer, len);
+      sent += len;
+    }
+    return 0;
+  }
+
+  void ThreadQueue_Test::Test_threadqueueTwoThreads()
+  {
+    ThreadQueue queue;
+    pthread_t producer;
+    assert(pthread_create(&producer, NULL, ThreadQueueProducer, &queue) == 0);
+
+    u8 buffer[61];
+    u32 received = 0;
+    while (received < TWO_THREAD_BYTES)
+    {
+      u32 len = sizeof(buffer);
+      if (received + len > TWO_THREAD_BYTES)
+      {
+        len = TWO_THREAD_BYTES - received;
+      }
+      queue.ReadBlocking(buffer, len);
+      for (u32 i = 0; i < len; ++i)
+      {
+        assert(buffer[i] == (u8) (received + i));
+      }
+      received += len;
+    }
+
+    assert(pthread_join(producer, NULL) == 0);
+    assert(queue.BytesAvailable() == 0);
+  }
+
+} /* namespace MFM */
@@ -7,6 +7,51 @@
 
 namespace MFM {
 
+#ifdef MFM_EVENT_ROLLBACK
+  /**
+   * An Element that fills its four nearest neighbors with Res and
+   * then fails, so every one of its events must be rolled back.
+   */
+  template <class CC>
+  class Element_FailAfterWrites : public Element<CC>
+  {
+    typedef typename CC::ATOM_TYPE T;
+
+  public:
+    static Element_FailAfterWrites THE_INSTANCE;
+
+    Element_FailAfterWrites() : Element<CC>(MFM_UUID_FOR("FailAfterWrites", 1))
+    {
+      Element<CC>::SetAtomicSymbol("Fw");
+      Element<CC>::SetName("FailAfterWrites");
+    }
+
+    virtual u32 PercentMovable(const T& you,
+                               const T& me, const SPoint& offset) const
+    {
+      return 0;
+    }
+
+    virtual u32 DefaultPhysicsColor() const
+    {
+      return 0xffff0000;
+    }
+
+    virtual void Behavior(EventWindow<CC>& window) const
+    {
+      const T res = Element_Res<CC>::THE_INSTANCE.GetDefaultAtom();
+      window.SetRelativeAtom(SPoint(1, 0), res);
+      window.SetRelativeAtom(SPoint(-1, 0), res);
+      window.SetRelativeAtom(SPoint(0, 1), res);
+      window.SetRelativeAtom(SPoint(0, -1), res);
+      FAIL(ILLEGAL_STATE);
+    }
+  };
+
+  template <class CC>
+  Element_FailAfterWrites<CC> Element_FailAfterWrites<CC>::THE_INSTANCE;
+#endif
+
   void Tile_Test::Test_tilePlaceAtom()
   {
     TestTile tile;
@@ -22,4 +67,253 @@ namespace MFM {
 
     assert(other.GetType() == atom.GetType());
   }
+
+  void Tile_Test::Test_tileIncrementalCounts()
+  {
+    TestTile tile;
+    Element_Res<TestCoreConfig>::THE_INSTANCE.AllocateType();
+    tile.RegisterElement(Element_Res<TestCoreConfig>::THE_INSTANCE);
+
+    TestAtom atom(Element_Res<TestCoreConfig>::THE_INSTANCE.GetDefaultAtom());
+    const u32 ownedSites = TestTile::OWNED_SIDE * TestTile::OWNED_SIDE;
+    u32 placed = 0;
+    for (u32 x = 0; x < TestTile::TILE_WIDTH; x += 2)
+    {
+      for (u32 y = 0; y < TestTile::TILE_WIDTH; y += 3)
+      {
+        tile.PlaceAtom(atom, SPoint(x, y));  // Caches too, which aren't counted
+        placed += TestTile::IsOwnedSite(SPoint(x, y)) ? 1 : 0;
+      }
+    }
+    assert(tile.GetAtomCount(atom.GetType()) == placed);
+    assert(tile.GetAtomCount(Element_Empty<TestCoreConfig>::THE_INSTANCE.GetType()) ==
+           ownedSites - placed);
+    tile.AssertValidAtomCounts();
+
+    // Radiation and repair keep the counts without a recount
+    tile.XRay(4, 8);
+    tile.SingleXRay(10, 10);
+    tile.AssertValidAtomCounts();
+
+    u32 repaired = 0, erased = 0;
+    tile.CheckAndRepairAtoms(repaired, erased);
+    tile.AssertValidAtomCounts();
+  }
+
+  void Tile_Test::Test_tilePublishedStats()
+  {
+    TestTile tile;
+    Element_Res<TestCoreConfig>::THE_INSTANCE.AllocateType();
+    tile.RegisterElement(Element_Res<TestCoreConfig>::THE_INSTANCE);
+    tile.PublishStats();
+
+    TestAtom atom(Element_Res<TestCoreConfig>::THE_INSTANCE.GetDefaultAtom());
+    const u32 type = atom.GetType();
+    const SPoint site(TestTile::TILE_WIDTH / 2, TestTile::TILE_WIDTH / 2);  // Owned
+    tile.PlaceAtom(atom, site);
+
+    // Readers see the snapshot, not the live count, until it's republished
+    assert(tile.GetAtomCount(type) == 1);
+    assert(tile.GetPublishedAtomCount(type) == 0);
+
+    tile.PublishStats();
+    assert(tile.GetPublishedAtomCount(type) == 1);
+
+    TestTile::Stats stats;
+    tile.GetStats(stats);
+    assert(stats.m_atomCount[tile.GetElementTable().GetIndex(type)] == 1);
+    assert(stats.m_eventsExecuted == tile.GetEventsExecuted());
+    assert(stats.m_illegalAtomCount == 0);
+
+    // Clearing doesn't publish; that's up to whoever cleared
+    tile.ClearAtoms();
+    assert(tile.GetPublishedAtomCount(type) == 1);
+    tile.PublishStats();
+    assert(tile.GetPublishedAtomCount(type) == 0);
+    assert(tile.GetPublishedAtomCount(Element_Empty<TestCoreConfig>::THE_INSTANCE.GetType()) ==
+           TestTile::OWNED_SIDE * TestTile::OWNED_SIDE);
+  }
+
+  void Tile_Test::Test_tileAckWindow()
+  {
+    TestTile west, east;
+    Element_Res<TestCoreConfig>::THE_INSTANCE.AllocateType();
+    west.RegisterElement(Element_Res<TestCoreConfig>::THE_INSTANCE);
+    east.RegisterElement(Element_Res<TestCoreConfig>::THE_INSTANCE);
+    east.Connect(west, Dirs::WEST);  // Which connects west to east too
+
+    Connection * link = west.GetConnection(Dirs::EAST);
+    assert(link != 0 && link == east.GetConnection(Dirs::WEST));
+
+    TestAtom atom(Element_Res<TestCoreConfig>::THE_INSTANCE.GetDefaultAtom());
+    for (u32 x = 0; x < TestTile::TILE_WIDTH; x += 2)
+    {
+      for (u32 y = 0; y < TestTile::TILE_WIDTH; y += 2)
+      {
+        west.PlaceAtom(atom, SPoint(x, y));  // With room to move
+      }
+    }
+
+    // East never reads, so west's events toward it go unacknowledged
+    const u32 STEPS = 20000;
+    for (u32 i = 0; i < STEPS; ++i)
+    {
+      west.ExecuteStep(THREADSTATE_RUNNING);
+      assert(west.GetOutstandingAcks(Dirs::EAST) <= TestTile::EVENT_ACK_WINDOW);
+    }
+    assert(west.GetOutstandingAcks(Dirs::EAST) == TestTile::EVENT_ACK_WINDOW);
+    assert(link->IsLocked());
+
+    // ...but west kept going away from east, rather than waiting
+    const u64 events = west.GetEventsExecuted();
+    assert(events > 2 * TestTile::EVENT_ACK_WINDOW);
+    for (u32 i = 0; i < STEPS; ++i)
+    {
+      west.ExecuteStep(THREADSTATE_RUNNING);
+    }
+    assert(west.GetEventsExecuted() > events);
+    assert(west.GetOutstandingAcks(Dirs::EAST) == TestTile::EVENT_ACK_WINDOW);
+
+    // East reads the updates and acknowledges them, but the lock
+    // stays held until west reads those acknowledgments
+    east.FlushAndWaitOnAllBuffers(0);
+    assert(west.GetOutstandingAcks(Dirs::EAST) == TestTile::EVENT_ACK_WINDOW);
+    assert(link->IsLocked());
+
+    west.FlushAndWaitOnAllBuffers(0);
+    assert(west.GetOutstandingAcks(Dirs::EAST) == 0);
+    assert(!link->IsLocked());
+  }
+
+  void Tile_Test::Test_tileBatchedEventBudget()
+  {
+    TestTile locking, batched;
+    Element_Res<TestCoreConfig>::THE_INSTANCE.AllocateType();
+    locking.RegisterElement(Element_Res<TestCoreConfig>::THE_INSTANCE);
+    batched.RegisterElement(Element_Res<TestCoreConfig>::THE_INSTANCE);
+    batched.SetEventSchedule(SCHEDULE_BATCHED, 0, 0);
+
+    TestAtom atom(Element_Res<TestCoreConfig>::THE_INSTANCE.GetDefaultAtom());
+    const u32 type = atom.GetType();
+    for (u32 x = 0; x < TestTile::TILE_WIDTH; x += 3)
+    {
+      for (u32 y = 0; y < TestTile::TILE_WIDTH; y += 2)
+      {
+        locking.PlaceAtom(atom, SPoint(x, y));
+        batched.PlaceAtom(atom, SPoint(x, y));
+      }
+    }
+    const u32 placed = locking.GetAtomCount(type);
+    assert(batched.GetAtomCount(type) == placed);
+
+    // One event per step when locking, a batch per step when batched
+    const u32 BUDGET = 100 * TestTile::BATCHED_EVENTS;
+    for (u32 i = 0; i < BUDGET; ++i)
+    {
+      locking.ExecuteStep(THREADSTATE_RUNNING);
+    }
+    for (u32 i = 0; i < BUDGET / TestTile::BATCHED_EVENTS; ++i)
+    {
+      batched.ExecuteStep(THREADSTATE_RUNNING);
+    }
+
+    // Grouping by type dropped no events, and ran none twice
+    assert(locking.GetEventsExecuted() == BUDGET);
+    assert(batched.GetEventsExecuted() == BUDGET);
+
+    TestTile::Stats stats;
+    batched.PublishStats();
+    batched.GetStats(stats);
+    assert(stats.m_eventsExecuted == BUDGET);
+    assert(stats.m_lockEvents[LOCKTYPE_NONE] == BUDGET);
+
+    // Res only moves, whatever order its events ran in
+    assert(locking.GetAtomCount(type) == placed);
+    assert(batched.GetAtomCount(type) == placed);
+    locking.AssertValidAtomCounts();
+    batched.AssertValidAtomCounts();
+  }
+
+#ifdef MFM_EVENT_ROLLBACK
+  void Tile_Test::Test_tileRollBack()
+  {
+    TestTile tile;
+    Element_Res<TestCoreConfig>::THE_INSTANCE.AllocateType();
+    Element_FailAfterWrites<TestCoreConfig>::THE_INSTANCE.AllocateType();
+    tile.RegisterElement(Element_Res<TestCoreConfig>::THE_INSTANCE);
+    tile.RegisterElement(Element_FailAfterWrites<TestCoreConfig>::THE_INSTANCE);
+
+    const TestAtom failer =
+      Element_FailAfterWrites<TestCoreConfig>::THE_INSTANCE.GetDefaultAtom();
+    const u32 FAIL_TYPE = failer.GetType();
+    const u32 RES_TYPE = Element_Res<TestCoreConfig>::THE_INSTANCE.GetDefaultAtom().GetType();
+
+    // Far enough apart that no event writes on another's center,
+    // and all within the owned sites
+    const u32 W = TestTile::TILE_WIDTH;
+    const u32 FIRST = TestTile::EVENT_WINDOW_RADIUS + 1;
+    const u32 SPACING = 3;
+    u32 placed = 0;
+    for (u32 x = FIRST; x < W - FIRST; x += SPACING)
+    {
+      for (u32 y = FIRST; y < W - FIRST; y += SPACING)
+      {
+        tile.PlaceAtom(failer, SPoint(x, y));
+        ++placed;
+      }
+    }
+
+    // Radiation on, so a restore that irradiates will soon show
+    tile.SetBackgroundRadiation(true);
+
+    TestAtom before[W][W];
+    u32 erased = 0;
+    const u32 STEPS = 100000;
+    for (u32 i = 0; i < STEPS; ++i)
+    {
+      for (u32 x = 0; x < W; ++x)
+      {
+        for (u32 y = 0; y < W; ++y)
+        {
+          before[x][y] = *tile.GetAtom(SPoint(x, y));
+        }
+      }
+
+      tile.ExecuteStep(THREADSTATE_RUNNING);
+
+      // A failed event erases its center (with an Empty that may
+      // itself be irradiated) and leaves the rest of the Tile
+      // exactly as it was
+      for (u32 x = 0; x < W; ++x)
+      {
+        for (u32 y = 0; y < W; ++y)
+        {
+          const SPoint pt(x, y);
+          const TestAtom & after = *tile.GetAtom(pt);
+          if (after != before[x][y])
+          {
+            assert(before[x][y].GetType() == FAIL_TYPE);
+            assert(after.GetType() != FAIL_TYPE);
+
+            // Put it back, unirradiated, for the next time
+            tile.SetBackgroundRadiation(false);
+            tile.PlaceAtom(failer, pt);
+            tile.SetBackgroundRadiation(true);
+            ++erased;
+          }
+        }
+      }
+      assert(tile.GetAtomCount(FAIL_TYPE) == placed);
+      assert(tile.GetAtomCount(RES_TYPE) == 0);
+    }
+
+    // Every failure was seen, and there were plenty of them
+    TestTile::Stats stats;
+    tile.PublishStats();
+    tile.GetStats(stats);
+    assert(stats.m_eventsFailed == erased);
+    assert(erased > STEPS / (SPACING * SPACING * 2));
+    tile.AssertValidAtomCounts();
+  }
+#endif
 } /* namespace MFM */
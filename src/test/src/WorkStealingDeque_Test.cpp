@@ -0,0 +1,209 @@
+#include "assert.h"
+#include <pthread.h>
+#include <sched.h>  /* For sched_yield */
+#include "WorkStealingDeque_Test.h"
+#include "Atomic.h"
+#include "Fail.h"
+#include "itype.h"
+
+namespace MFM {
+
+  void WorkStealingDeque_Test::Test_RunTests()
+  {
+    Test_workstealingdequeTakeOrder();
+    Test_workstealingdequeEmpty();
+    Test_workstealingdequeFull();
+    Test_workstealingdequeRace();
+  }
+
+  void WorkStealingDeque_Test::Test_workstealingdequeTakeOrder()
+  {
+    WorkStealingDeque<u32> deque;
+    deque.SetCapacity(8);
+
+    u32 items[8];
+    for (u32 i = 0; i < 8; ++i)
+    {
+      deque.Push(&items[i]);
+    }
+    assert(deque.GetSize() == 8);
+
+    // The owner takes newest first...
+    for (u32 i = 8; i-- > 4; )
+    {
+      assert(deque.Take() == &items[i]);
+    }
+
+    // ...while thieves steal oldest first
+    for (u32 i = 0; i < 4; ++i)
+    {
+      assert(deque.Steal() == &items[i]);
+    }
+    assert(deque.GetSize() == 0);
+
+    // Pushes after a wrap still come back in order
+    for (u32 round = 0; round < 3; ++round)
+    {
+      for (u32 i = 0; i < 6; ++i)
+      {
+        deque.Push(&items[i]);
+      }
+      for (u32 i = 6; i-- > 0; )
+      {
+        assert(deque.Take() == &items[i]);
+      }
+    }
+  }
+
+  void WorkStealingDeque_Test::Test_workstealingdequeEmpty()
+  {
+    WorkStealingDeque<u32> deque;
+    deque.SetCapacity(4);
+
+    assert(deque.Take() == 0);
+    assert(deque.Steal() == 0);
+    assert(deque.GetSize() == 0);
+
+    u32 item;
+    deque.Push(&item);
+    assert(deque.Take() == &item);
+    assert(deque.Take() == 0);
+    assert(deque.Steal() == 0);
+
+    deque.Push(&item);
+    assert(deque.Steal() == &item);
+    assert(deque.Steal() == 0);
+    assert(deque.Take() == 0);
+    assert(deque.GetSize() == 0);
+  }
+
+  void WorkStealingDeque_Test::Test_workstealingdequeFull()
+  {
+    WorkStealingDeque<u32> deque;
+    deque.SetCapacity(2);
+
+    u32 items[3];
+    deque.Push(&items[0]);
+    deque.Push(&items[1]);
+
+    volatile bool failed = false;
+    unwind_protect({
+        failed = true;
+      },{
+        deque.Push(&items[2]);
+      });
+    assert(failed);
+    assert(deque.GetSize() == 2);
+    assert(deque.Take() == &items[1]);
+  }
+
+  static const u32 RACE_ITEMS = 100000;
+  static const u32 RACE_THIEVES = 3;
+
+  struct RaceState
+  {
+    WorkStealingDeque<u32> m_deque;
+    u32 m_items[RACE_ITEMS];
+    Atomic<u32> m_ownerDone;
+  };
+
+  struct RaceThief
+  {
+    RaceState * m_state;
+    u8 m_seen[RACE_ITEMS];
+    u32 m_stolen;
+  };
+
+  static void * RaceThiefLoop(void * arg)
+  {
+    RaceThief & thief = *(RaceThief *) arg;
+    RaceState & state = *thief.m_state;
+    while (true)
+    {
+      bool done = state.m_ownerDone.Load(MEMORY_ORDER_ACQUIRE) != 0;
+      u32 * item = state.m_deque.Steal();
+      if (item)
+      {
+        ++thief.m_seen[*item];
+        ++thief.m_stolen;
+      }
+      else if (done && state.m_deque.GetSize() == 0)
+      {
+        break;
+      }
+      else
+      {
+        sched_yield();
+      }
+    }
+    return 0;
+  }
+
+  void WorkStealingDeque_Test::Test_workstealingdequeRace()
+  {
+    RaceState * state = new RaceState;
+    state->m_deque.SetCapacity(1 << 17);  // Room for everything, if no one steals
+    state->m_ownerDone.Store(0);
+
+    RaceThief * thieves = new RaceThief[RACE_THIEVES];
+    pthread_t threads[RACE_THIEVES];
+    for (u32 t = 0; t < RACE_THIEVES; ++t)
+    {
+      thieves[t].m_state = state;
+      thieves[t].m_stolen = 0;
+      for (u32 i = 0; i < RACE_ITEMS; ++i)
+      {
+        thieves[t].m_seen[i] = 0;
+      }
+      assert(pthread_create(&threads[t], NULL, RaceThiefLoop, &thieves[t]) == 0);
+    }
+
+    // The owner pushes everything, taking some back as it goes
+    u8 * ownerSeen = new u8[RACE_ITEMS];
+    for (u32 i = 0; i < RACE_ITEMS; ++i)
+    {
+      ownerSeen[i] = 0;
+      state->m_items[i] = i;
+    }
+    for (u32 i = 0; i < RACE_ITEMS; ++i)
+    {
+      state->m_deque.Push(&state->m_items[i]);
+      if (i % 3 == 2)
+      {
+        u32 * item = state->m_deque.Take();
+        if (item)
+        {
+          ++ownerSeen[*item];
+        }
+      }
+    }
+    u32 * item;
+    while ((item = state->m_deque.Take()) != 0)
+    {
+      ++ownerSeen[*item];
+    }
+    state->m_ownerDone.Store(1, MEMORY_ORDER_RELEASE);
+
+    for (u32 t = 0; t < RACE_THIEVES; ++t)
+    {
+      assert(pthread_join(threads[t], NULL) == 0);
+    }
+
+    // Every item came out exactly once
+    for (u32 i = 0; i < RACE_ITEMS; ++i)
+    {
+      u32 seen = ownerSeen[i];
+      for (u32 t = 0; t < RACE_THIEVES; ++t)
+      {
+        seen += thieves[t].m_seen[i];
+      }
+      assert(seen == 1);
+    }
+    assert(state->m_deque.GetSize() == 0);
+
+    delete [] ownerSeen;
+    delete [] thieves;
+    delete state;
+  }
+
+} /* namespace MFM */